@@ -0,0 +1,204 @@
+//************************************************************************************************************************
+//
+//	LearnOpenGL - assetLoader.cpp
+//
+//	Name:			Tucker Dane Walker
+//	Date:			August 2017
+//	Description:	Implementation for an asynchronous asset loader.
+//
+//***********************************************************************************************************************/
+
+#include "assetLoader.h"
+#include "cpuProfiler.h"
+
+#include <chrono>
+#include <iostream>
+
+//-------------------------------------------------------------------
+//	starts the worker threads
+//
+//	@param:		numWorkers	number of load threads; 0 uses one per
+//							core, leaving a core for the GL thread
+//-------------------------------------------------------------------
+AssetLoader::AssetLoader(int numWorkers)
+{
+	stopping = false;
+	pending = 0;
+
+	if (numWorkers <= 0)
+	{
+		numWorkers = (int)std::thread::hardware_concurrency() - 1;
+		if (numWorkers < 1)
+		{
+			numWorkers = 1;
+		}
+	}
+	for (int i = 0; i < numWorkers; i++)
+	{
+		workers.push_back(std::thread(&AssetLoader::workerLoop, this));
+	}
+}
+
+//-------------------------------------------------------------------
+//	stops the worker threads; loads already running are finished,
+//	queued ones are dropped
+//-------------------------------------------------------------------
+AssetLoader::~AssetLoader()
+{
+	{
+		std::lock_guard<std::mutex> lock(loadMutex);
+		stopping = true;
+		loadQueue.clear();
+	}
+	loadReady.notify_all();
+
+	for (size_t i = 0; i < workers.size(); i++)
+	{
+		workers[i].join();
+	}
+}
+
+//-------------------------------------------------------------------
+//	queues an asset
+//
+//	@param:		name		name used in error messages
+//	@param:		load		CPU work run on a worker thread; may be
+//							empty if the asset only needs an upload
+//	@param:		upload		GL work run on the GL thread inside
+//							pumpUploads; may be empty
+//	@return:	a handle for state()
+//-------------------------------------------------------------------
+int AssetLoader::add(const std::string& name, Step load, Step upload)
+{
+	Asset* asset = new Asset;
+	asset->name = name;
+	asset->load = load;
+	asset->upload = upload;
+	asset->state = ASSET_PENDING;
+
+	int handle = (int)assets.size();
+	assets.push_back(std::unique_ptr<Asset>(asset));
+	pending++;
+
+	{
+		std::lock_guard<std::mutex> lock(loadMutex);
+		loadQueue.push_back(asset);
+	}
+	loadReady.notify_one();
+
+	return handle;
+}
+
+//-------------------------------------------------------------------
+//	runs load steps until the loader is destroyed
+//-------------------------------------------------------------------
+void AssetLoader::workerLoop()
+{
+	PROFILE_THREAD("loader worker");
+	for (;;)
+	{
+		Asset* asset = NULL;
+		{
+			std::unique_lock<std::mutex> lock(loadMutex);
+			while (!stopping && loadQueue.empty())
+			{
+				loadReady.wait(lock);
+			}
+			if (stopping)
+			{
+				return;
+			}
+			asset = loadQueue.front();
+			loadQueue.pop_front();
+		}
+
+		bool loaded;
+		{
+			PROFILE_ZONE("load asset");
+			loaded = !asset->load || asset->load();
+		}
+		if (!loaded)
+		{
+			std::cout << "ERROR::ASSET::LOAD_FAILED " << asset->name << std::endl;
+			asset->state = ASSET_FAILED;
+			pending--;
+			continue;
+		}
+
+		std::lock_guard<std::mutex> lock(uploadMutex);
+		uploadQueue.push_back(asset);
+	}
+}
+
+//-------------------------------------------------------------------
+//	runs the upload steps of loaded assets on the calling (GL) thread
+//
+//	@param:		budgetMs	time to spend this call; at least one
+//							upload runs if any is waiting
+//	@return:	the number of uploads that ran
+//-------------------------------------------------------------------
+int AssetLoader::pumpUploads(double budgetMs)
+{
+	PROFILE_ZONE("AssetLoader::pumpUploads");
+	typedef std::chrono::steady_clock Clock;
+	Clock::time_point start = Clock::now();
+	int uploaded = 0;
+
+	for (;;)
+	{
+		Asset* asset = NULL;
+		{
+			std::lock_guard<std::mutex> lock(uploadMutex);
+			if (uploadQueue.empty())
+			{
+				break;
+			}
+			asset = uploadQueue.front();
+			uploadQueue.pop_front();
+		}
+
+		bool ok = !asset->upload || asset->upload();
+		if (!ok)
+		{
+			std::cout << "ERROR::ASSET::UPLOAD_FAILED " << asset->name << std::endl;
+		}
+		asset->state = ok ? ASSET_READY : ASSET_FAILED;
+		pending--;
+		uploaded++;
+
+		// the steps are not needed again; free what they captured
+		asset->load = Step();
+		asset->upload = Step();
+
+		if (std::chrono::duration<double, std::milli>(Clock::now() - start).count() >= budgetMs)
+		{
+			break;
+		}
+	}
+	return uploaded;
+}
+
+//-------------------------------------------------------------------
+//	@param:		asset		a handle returned by add()
+//	@return:	the state of the asset
+//-------------------------------------------------------------------
+AssetState AssetLoader::state(int asset) const
+{
+	return (AssetState)assets[asset]->state.load();
+}
+
+//-------------------------------------------------------------------
+//	@return:	true once every asset added is READY or FAILED
+//-------------------------------------------------------------------
+bool AssetLoader::settled() const
+{
+	return pending == 0;
+}
+
+//-------------------------------------------------------------------
+//	@return:	the number of worker threads
+//-------------------------------------------------------------------
+int AssetLoader::workerCount() const
+{
+	return (int)workers.size();
+}
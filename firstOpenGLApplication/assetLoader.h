@@ -0,0 +1,86 @@
+//************************************************************************************************************************
+//
+//	LearnOpenGL - assetLoader.h
+//
+//	Name:			Tucker Dane Walker
+//	Date:			August 2017
+//	Description:	Specifications for an asynchronous asset loader. Worker threads run each asset's load step
+//					(file I/O, decoding, CPU preprocessing); the GL thread runs the upload steps inside a per-frame
+//					time budget so rendering starts right away and content streams in as it becomes ready.
+//
+//***********************************************************************************************************************/
+
+#ifndef ASSET_LOADER_H
+#define ASSET_LOADER_H
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// the life cycle of an asset
+//---------------------------------
+enum AssetState
+{
+	ASSET_PENDING,		// queued, loading or waiting for its upload
+	ASSET_READY,		// uploaded and usable by the renderer
+	ASSET_FAILED		// its load or upload step returned false
+};
+
+class AssetLoader
+{
+public:
+	// a step of loading an asset; returns false if the asset failed
+	//---------------------------------
+	typedef std::function<bool()> Step;
+
+	// constructors start and stop the worker threads
+	//---------------------------------
+	AssetLoader(int numWorkers);
+	~AssetLoader();
+
+	// queue an asset; load runs on a worker, upload later on the GL thread
+	//---------------------------------
+	int add(const std::string& name, Step load, Step upload);
+
+	// GL thread: runs queued uploads until budgetMs has been spent
+	//---------------------------------
+	int pumpUploads(double budgetMs);
+
+	// state queries
+	//---------------------------------
+	AssetState state(int asset) const;
+	bool settled() const;
+	int workerCount() const;
+
+private:
+	struct Asset
+	{
+		std::string				name;
+		Step					load;
+		Step					upload;
+		std::atomic<int>		state;
+	};
+
+	void workerLoop();
+
+	std::vector<std::unique_ptr<Asset> >	assets;			// every asset ever added, indexed by handle
+	std::vector<std::thread>				workers;		// threads running load steps
+
+	std::mutex								loadMutex;		// guards loadQueue and stopping
+	std::condition_variable					loadReady;		// signalled when loadQueue grows or on shutdown
+	std::deque<Asset*>						loadQueue;		// assets waiting for a worker
+	bool									stopping;
+
+	std::mutex								uploadMutex;	// guards uploadQueue
+	std::deque<Asset*>						uploadQueue;	// loaded assets waiting for the GL thread
+
+	std::atomic<int>						pending;		// assets not yet READY or FAILED
+};
+
+#endif
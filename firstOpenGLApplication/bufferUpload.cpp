@@ -0,0 +1,140 @@
+//************************************************************************************************************************
+//
+//	LearnOpenGL - bufferUpload.cpp
+//
+//	Name:			Tucker Dane Walker
+//	Date:			August 2017
+//	Description:	Implementation for a buffer upload layer.
+//
+//***********************************************************************************************************************/
+
+#include "bufferUpload.h"
+#include "glState.h"
+
+#include <assert.h>
+#include <string.h>
+#include <iostream>
+
+// every packed upload starts on this boundary inside the staging buffer
+//---------------------------------
+static const size_t STAGING_ALIGNMENT = 16;
+
+//-------------------------------------------------------------------
+//	constructor
+//-------------------------------------------------------------------
+BufferUploader::BufferUploader()
+{
+	stagingBuffer = 0;
+	memset(&frame, 0, sizeof(frame));
+}
+
+//-------------------------------------------------------------------
+//	fills a buffer object with data
+//
+//	@param:		buffer		the destination buffer object
+//	@param:		data		the bytes to upload
+//	@param:		size		exact number of bytes in data
+//	@param:		usage		usage hint, e.g. GL_STATIC_DRAW
+//-------------------------------------------------------------------
+void BufferUploader::upload(unsigned int buffer, const void* data, size_t size, GLenum usage)
+{
+	assert(buffer != 0);
+	assert(data != NULL);
+	assert(size > 0);
+
+	// large uploads gain nothing from staging; send them directly
+	if (size >= UPLOAD_COALESCE_LIMIT)
+	{
+		currentGLState()->bindBuffer(GL_COPY_WRITE_BUFFER, buffer);
+		glBufferData(GL_COPY_WRITE_BUFFER, (GLsizeiptr)size, data, usage);
+
+		frame.bytes += size;
+		frame.spans++;
+		frame.transfers++;
+		return;
+	}
+
+	// pack small uploads together
+	Span span;
+	span.buffer = buffer;
+	span.offset = (staging.size() + STAGING_ALIGNMENT - 1) & ~(STAGING_ALIGNMENT - 1);
+	span.size = size;
+	span.usage = usage;
+
+	staging.resize(span.offset + size);
+	memcpy(&staging[span.offset], data, size);
+	spans.push_back(span);
+}
+
+//-------------------------------------------------------------------
+//	sends every packed upload in one transfer to the staging buffer,
+//	then copies each span into its own exactly sized buffer on the GPU
+//-------------------------------------------------------------------
+void BufferUploader::flush()
+{
+	if (spans.empty())
+	{
+		return;
+	}
+
+	if (stagingBuffer == 0)
+	{
+		glGenBuffers(1, &stagingBuffer);
+	}
+
+	// one host to GPU transfer for the whole batch
+	currentGLState()->bindBuffer(GL_COPY_READ_BUFFER, stagingBuffer);
+	glBufferData(GL_COPY_READ_BUFFER, (GLsizeiptr)staging.size(), &staging[0], GL_STREAM_COPY);
+	frame.transfers++;
+
+	for (size_t i = 0; i < spans.size(); i++)
+	{
+		const Span& span = spans[i];
+
+		currentGLState()->bindBuffer(GL_COPY_WRITE_BUFFER, span.buffer);
+		glBufferData(GL_COPY_WRITE_BUFFER, (GLsizeiptr)span.size, NULL, span.usage);
+		glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, (GLintptr)span.offset, 0, (GLsizeiptr)span.size);
+
+#ifdef _DEBUG
+		// the destination must end up exactly as large as its data
+		GLint allocated = 0;
+		glGetBufferParameteriv(GL_COPY_WRITE_BUFFER, GL_BUFFER_SIZE, &allocated);
+		if ((size_t)allocated != span.size)
+		{
+			std::cout << "ERROR::UPLOAD::SIZE_MISMATCH buffer " << span.buffer << ": " << allocated << " != " << span.size << std::endl;
+		}
+#endif
+
+		frame.bytes += span.size;
+		frame.spans++;
+	}
+
+	// orphan the staging storage; the copies above still read the old one
+	glBufferData(GL_COPY_READ_BUFFER, 0, NULL, GL_STREAM_COPY);
+
+	staging.clear();
+	spans.clear();
+}
+
+//-------------------------------------------------------------------
+//	@return:	what was uploaded since the previous call, after
+//				which the counters start again from zero
+//-------------------------------------------------------------------
+UploadStats BufferUploader::endFrame()
+{
+	UploadStats stats = frame;
+	memset(&frame, 0, sizeof(frame));
+	return stats;
+}
+
+//-------------------------------------------------------------------
+//	deletes the staging buffer
+//-------------------------------------------------------------------
+void BufferUploader::release()
+{
+	if (stagingBuffer != 0)
+	{
+		currentGLState()->deleteBuffers(1, &stagingBuffer);
+		stagingBuffer = 0;
+	}
+}
@@ -0,0 +1,74 @@
+//************************************************************************************************************************
+//
+//	LearnOpenGL - bufferUpload.h
+//
+//	Name:			Tucker Dane Walker
+//	Date:			August 2017
+//	Description:	Specifications for a buffer upload layer. Every upload carries the exact byte size of its
+//					data; small uploads are packed into one staging buffer and copied into place on the GPU, and
+//					the bytes sent each frame are counted so upload bandwidth can be measured.
+//
+//***********************************************************************************************************************/
+
+#ifndef BUFFER_UPLOAD_H
+#define BUFFER_UPLOAD_H
+
+#include <glad/glad.h>
+#include <stddef.h>
+#include <vector>
+
+// uploads at least this large skip the staging buffer and go straight to their buffer
+//---------------------------------
+const size_t UPLOAD_COALESCE_LIMIT = 64 * 1024;
+
+// what was uploaded since the last call to endFrame
+//---------------------------------
+struct UploadStats
+{
+	size_t	bytes;			// bytes of real data sent to the GPU
+	int		spans;			// number of buffers filled
+	int		transfers;		// number of host to GPU transfers it took
+};
+
+class BufferUploader
+{
+public:
+	// constructors; the staging buffer is created on first use
+	//---------------------------------
+	BufferUploader();
+
+	// fill buffer with exactly size bytes of data; the data is copied before returning
+	//---------------------------------
+	void upload(unsigned int buffer, const void* data, size_t size, GLenum usage);
+
+	template <typename T>
+	void uploadArray(unsigned int buffer, const T* data, size_t count, GLenum usage)
+	{
+		upload(buffer, data, count * sizeof(T), usage);
+	}
+
+	// send everything queued; call once per frame before drawing
+	//---------------------------------
+	void flush();
+	UploadStats endFrame();
+
+	// delete the staging buffer; call while the GL context is still current
+	//---------------------------------
+	void release();
+
+private:
+	struct Span
+	{
+		unsigned int	buffer;		// destination buffer object
+		size_t			offset;		// position of the data in staging
+		size_t			size;		// exact size of the data in bytes
+		GLenum			usage;		// usage hint for the destination
+	};
+
+	std::vector<unsigned char>	staging;		// packed small uploads waiting for flush
+	std::vector<Span>			spans;			// where each packed upload goes
+	unsigned int				stagingBuffer;	// GL buffer the packed uploads are sent through
+	UploadStats					frame;			// totals since the last endFrame
+};
+
+#endif
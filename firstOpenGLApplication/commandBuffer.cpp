@@ -0,0 +1,195 @@
+//************************************************************************************************************************
+//
+//	LearnOpenGL - commandBuffer.cpp
+//
+//	Name:			Tucker Dane Walker
+//	Date:			August 2017
+//	Description:	Implementation for command buffer recording and OpenGL replay.
+//
+//***********************************************************************************************************************/
+
+#include "commandBuffer.h"
+#include "glState.h"
+#include "shader.h"
+
+#include <glad/glad.h>
+#include <string.h>
+#include <vector>
+
+//-------------------------------------------------------------------
+//	recording
+//-------------------------------------------------------------------
+void CommandBuffer::clear()
+{
+	bytes.clear();
+}
+
+void CommandBuffer::op(CommandOp code)
+{
+	bytes.push_back((unsigned char)code);
+}
+
+void CommandBuffer::arg(uint32_t value)
+{
+	size_t at = bytes.size();
+	bytes.resize(at + sizeof(value));
+	memcpy(&bytes[at], &value, sizeof(value));
+}
+
+void CommandBuffer::bindProgram(uint32_t program)
+{
+	op(CMD_BIND_PROGRAM);
+	arg(program);
+}
+
+void CommandBuffer::bindVertexArray(uint32_t VAO)
+{
+	op(CMD_BIND_VERTEX_ARRAY);
+	arg(VAO);
+}
+
+void CommandBuffer::polygonMode(uint32_t mode)
+{
+	op(CMD_POLYGON_MODE);
+	arg(mode);
+}
+
+void CommandBuffer::bindShapeTable(uint32_t texture, uint32_t firstShape)
+{
+	op(CMD_BIND_SHAPE_TABLE);
+	arg(texture);
+	arg(firstShape);
+}
+
+void CommandBuffer::drawArrays(int32_t first, int32_t count)
+{
+	op(CMD_DRAW_ARRAYS);
+	arg((uint32_t)first);
+	arg((uint32_t)count);
+}
+
+void CommandBuffer::drawElements(int32_t count, uint32_t indexType, uint32_t offset)
+{
+	op(CMD_DRAW_ELEMENTS);
+	arg((uint32_t)count);
+	arg(indexType);
+	arg(offset);
+}
+
+void CommandBuffer::multiDrawElements(int32_t drawCount, uint32_t indexType, const int32_t* counts, const uint32_t* offsets)
+{
+	op(CMD_MULTI_DRAW_ELEMENTS);
+	arg((uint32_t)drawCount);
+	arg(indexType);
+	for (int32_t i = 0; i < drawCount; i++)
+	{
+		arg((uint32_t)counts[i]);
+	}
+	for (int32_t i = 0; i < drawCount; i++)
+	{
+		arg(offsets[i]);
+	}
+}
+
+const unsigned char* CommandBuffer::data() const
+{
+	return bytes.empty() ? NULL : &bytes[0];
+}
+
+size_t CommandBuffer::size() const
+{
+	return bytes.size();
+}
+
+//-------------------------------------------------------------------
+//	reads the next 4 byte argument of a command
+//
+//	@param:		at			read position, advanced past the argument
+//	@return:	the argument
+//-------------------------------------------------------------------
+static inline uint32_t readArg(const unsigned char** at)
+{
+	uint32_t value;
+	memcpy(&value, *at, sizeof(value));
+	*at += sizeof(value);
+	return value;
+}
+
+//-------------------------------------------------------------------
+//	issues a recorded stream to OpenGL; binds go through the state
+//	cache, so those matching what is already bound (by an earlier
+//	buffer or an earlier frame) are dropped
+//
+//	@param:		commands	the recorded buffer
+//	@param:		state		the state cache of the GL context
+//-------------------------------------------------------------------
+void replayCommands(const CommandBuffer& commands, GLStateCache* state)
+{
+	const unsigned char* at = commands.data();
+	const unsigned char* end = at + commands.size();
+
+	while (at < end)
+	{
+		CommandOp code = (CommandOp)*at++;
+		switch (code)
+		{
+		case CMD_BIND_PROGRAM:
+		{
+			state->useProgram(readArg(&at));
+			break;
+		}
+		case CMD_BIND_VERTEX_ARRAY:
+		{
+			state->bindVertexArray(readArg(&at));
+			break;
+		}
+		case CMD_POLYGON_MODE:
+		{
+			state->polygonMode(readArg(&at));
+			break;
+		}
+		case CMD_BIND_SHAPE_TABLE:
+		{
+			uint32_t texture = readArg(&at);
+			uint32_t firstShape = readArg(&at);
+			bindShapeTable(texture, firstShape);
+			break;
+		}
+		case CMD_DRAW_ARRAYS:
+		{
+			int32_t first = (int32_t)readArg(&at);
+			int32_t count = (int32_t)readArg(&at);
+			glDrawArrays(GL_TRIANGLES, first, count);
+			break;
+		}
+		case CMD_DRAW_ELEMENTS:
+		{
+			int32_t count = (int32_t)readArg(&at);
+			uint32_t indexType = readArg(&at);
+			uint32_t offset = readArg(&at);
+			glDrawElements(GL_TRIANGLES, count, indexType, (void*)(size_t)offset);
+			break;
+		}
+		case CMD_MULTI_DRAW_ELEMENTS:
+		{
+			// the arrays GL takes are rebuilt from the stream; several windows replay at once
+			static thread_local std::vector<GLsizei> counts;
+			static thread_local std::vector<const void*> offsets;
+			int32_t drawCount = (int32_t)readArg(&at);
+			uint32_t indexType = readArg(&at);
+			counts.resize(drawCount);
+			offsets.resize(drawCount);
+			for (int32_t i = 0; i < drawCount; i++)
+			{
+				counts[i] = (GLsizei)readArg(&at);
+			}
+			for (int32_t i = 0; i < drawCount; i++)
+			{
+				offsets[i] = (const void*)(size_t)readArg(&at);
+			}
+			glMultiDrawElements(GL_TRIANGLES, &counts[0], indexType, &offsets[0], drawCount);
+			break;
+		}
+		}
+	}
+}
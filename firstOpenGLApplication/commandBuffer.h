@@ -0,0 +1,67 @@
+//************************************************************************************************************************
+//
+//	LearnOpenGL - commandBuffer.h
+//
+//	Name:			Tucker Dane Walker
+//	Date:			August 2017
+//	Description:	Specifications for a command buffer: a compact binary stream of bind and draw commands.
+//					Recording makes no API calls, so any thread can record; replayCommands is the only part
+//					that talks to OpenGL and runs on the GL thread.
+//
+//					each command is a 1 byte opcode followed by its 4 byte arguments
+//
+//***********************************************************************************************************************/
+
+#ifndef COMMAND_BUFFER_H
+#define COMMAND_BUFFER_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <vector>
+
+// command opcodes
+//---------------------------------
+enum CommandOp
+{
+	CMD_BIND_PROGRAM,		// program
+	CMD_BIND_VERTEX_ARRAY,	// VAO
+	CMD_POLYGON_MODE,		// mode
+	CMD_BIND_SHAPE_TABLE,	// buffer texture of a shape table chunk, number of its first shape
+	CMD_DRAW_ARRAYS,		// first, count
+	CMD_DRAW_ELEMENTS,		// count, index type, byte offset
+	CMD_MULTI_DRAW_ELEMENTS	// draw count, index type, then every draw's count, then every draw's byte offset
+};
+
+class CommandBuffer
+{
+public:
+	// recording
+	//---------------------------------
+	void clear();
+	void bindProgram(uint32_t program);
+	void bindVertexArray(uint32_t VAO);
+	void polygonMode(uint32_t mode);
+	void bindShapeTable(uint32_t texture, uint32_t firstShape);
+	void drawArrays(int32_t first, int32_t count);
+	void drawElements(int32_t count, uint32_t indexType, uint32_t offset);
+	void multiDrawElements(int32_t drawCount, uint32_t indexType, const int32_t* counts, const uint32_t* offsets);
+
+	// the recorded stream
+	//---------------------------------
+	const unsigned char* data() const;
+	size_t size() const;
+
+private:
+	void op(CommandOp code);
+	void arg(uint32_t value);
+
+	std::vector<unsigned char> bytes;
+};
+
+class GLStateCache;
+
+// REPLAY
+//---------------------------------
+void replayCommands(const CommandBuffer& commands, GLStateCache* state);						// issues a buffer's commands to OpenGL
+
+#endif
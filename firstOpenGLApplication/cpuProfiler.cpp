@@ -0,0 +1,268 @@
+//************************************************************************************************************************
+//
+//	LearnOpenGL - cpuProfiler.cpp
+//
+//	Name:			Tucker Dane Walker
+//	Date:			August 2017
+//	Description:	Implementation for a scoped zone CPU profiler with per thread ring buffers.
+//
+//***********************************************************************************************************************/
+
+#include "cpuProfiler.h"
+
+#include <string.h>
+#include <algorithm>
+#include <atomic>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <mutex>
+
+// one finished zone
+//---------------------------------
+struct ZoneEvent
+{
+	const char*		name;
+	uint64_t		begin;		// ticks
+	uint64_t		end;		// ticks
+};
+
+// the zones of one thread; only that thread writes it
+//---------------------------------
+struct ZoneRing
+{
+	ZoneEvent					events[CPU_PROFILER_RING_SIZE];
+	std::atomic<uint64_t>		head;			// zones ever written; the newest is at head - 1
+	std::atomic<const char*>	threadName;		// set by setCpuProfilerThreadName, may be NULL
+	int							id;				// order the thread first recorded in
+};
+
+static std::mutex							ringsMutex;			// guards rings and origin
+static std::vector<std::unique_ptr<ZoneRing> >	rings;				// every thread's ring, freed at exit
+static thread_local ZoneRing*				threadRing = NULL;	// the calling thread's ring
+
+// a tick count and the steady_clock time it was read at, for converting ticks to time
+static uint64_t								originTicks = 0;
+static int64_t								originNs = 0;
+
+//-------------------------------------------------------------------
+//	@return:	steady_clock time in ns
+//-------------------------------------------------------------------
+static int64_t steadyNs()
+{
+	return (int64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+//-------------------------------------------------------------------
+//	creates the calling thread's ring on its first zone
+//
+//	@return:	the ring
+//-------------------------------------------------------------------
+static ZoneRing* registerRing()
+{
+	ZoneRing* ring = new ZoneRing;
+	ring->head = 0;
+	ring->threadName = NULL;
+
+	std::lock_guard<std::mutex> lock(ringsMutex);
+	if (rings.empty())
+	{
+		originTicks = cpuProfilerTicks();
+		originNs = steadyNs();
+	}
+	ring->id = (int)rings.size();
+	rings.push_back(std::unique_ptr<ZoneRing>(ring));
+
+	threadRing = ring;
+	return ring;
+}
+
+//-------------------------------------------------------------------
+//	@param:		name		the zone's name; must be a string literal
+//	@param:		begin		ticks when the zone started
+//	@param:		end			ticks when the zone finished
+//-------------------------------------------------------------------
+void recordCpuZone(const char* name, uint64_t begin, uint64_t end)
+{
+	ZoneRing* ring = threadRing;
+	if (ring == NULL)
+	{
+		ring = registerRing();
+	}
+
+	uint64_t head = ring->head.load(std::memory_order_relaxed);
+	ZoneEvent& event = ring->events[head & (CPU_PROFILER_RING_SIZE - 1)];
+	event.name = name;
+	event.begin = begin;
+	event.end = end;
+	ring->head.store(head + 1, std::memory_order_release);
+}
+
+//-------------------------------------------------------------------
+//	@param:		name		name of the calling thread in traces;
+//							must be a string literal
+//-------------------------------------------------------------------
+void setCpuProfilerThreadName(const char* name)
+{
+	ZoneRing* ring = threadRing;
+	if (ring == NULL)
+	{
+		ring = registerRing();
+	}
+	ring->threadName = name;
+}
+
+//-------------------------------------------------------------------
+//	copies the zones still held in a ring; zones the owning thread
+//	overwrote during the copy are left out
+//
+//	@param:		ring		a thread's ring
+//	@param:		out			receives the zones, oldest first
+//-------------------------------------------------------------------
+static void snapshotRing(const ZoneRing& ring, std::vector<ZoneEvent>* out)
+{
+	out->clear();
+	uint64_t end = ring.head.load(std::memory_order_acquire);
+	uint64_t begin = (end > CPU_PROFILER_RING_SIZE) ? end - CPU_PROFILER_RING_SIZE : 0;
+
+	for (uint64_t i = begin; i < end; i++)
+	{
+		out->push_back(ring.events[i & (CPU_PROFILER_RING_SIZE - 1)]);
+	}
+
+	uint64_t after = ring.head.load(std::memory_order_acquire);
+	uint64_t overwritten = (after > CPU_PROFILER_RING_SIZE) ? after - CPU_PROFILER_RING_SIZE : 0;
+	if (overwritten > begin)
+	{
+		out->erase(out->begin(), out->begin() + (size_t)std::min(overwritten - begin, (uint64_t)out->size()));
+	}
+}
+
+//-------------------------------------------------------------------
+//	@return:	ns per tick, measured against steady_clock since the
+//				first zone was recorded
+//-------------------------------------------------------------------
+static double nsPerTick()
+{
+#ifdef CPU_PROFILER_RDTSC
+	uint64_t ticks = cpuProfilerTicks();
+	int64_t ns = steadyNs();
+	if (ticks <= originTicks || ns <= originNs)
+	{
+		return 0.0;
+	}
+	return (double)(ns - originNs) / (double)(ticks - originTicks);
+#else
+	return 1.0e9 * std::chrono::steady_clock::period::num / std::chrono::steady_clock::period::den;
+#endif
+}
+
+//-------------------------------------------------------------------
+//	@param:		out			receives the call count, total, average
+//							and longest time of each zone name,
+//							highest total first
+//-------------------------------------------------------------------
+void summarizeCpuZones(std::vector<CpuZoneStats>* out)
+{
+	out->clear();
+	std::lock_guard<std::mutex> lock(ringsMutex);
+	double scale = nsPerTick();
+	std::vector<ZoneEvent> events;
+
+	for (size_t r = 0; r < rings.size(); r++)
+	{
+		snapshotRing(*rings[r], &events);
+		for (size_t i = 0; i < events.size(); i++)
+		{
+			double us = (double)(events[i].end - events[i].begin) * scale / 1000.0;
+
+			size_t s = 0;
+			while (s < out->size() && strcmp((*out)[s].name, events[i].name) != 0)
+			{
+				s++;
+			}
+			if (s == out->size())
+			{
+				CpuZoneStats stats;
+				stats.name = events[i].name;
+				stats.calls = 0;
+				stats.totalMs = 0.0;
+				stats.avgUs = 0.0;
+				stats.maxUs = 0.0;
+				out->push_back(stats);
+			}
+
+			CpuZoneStats& stats = (*out)[s];
+			stats.calls++;
+			stats.totalMs += us / 1000.0;
+			stats.maxUs = std::max(stats.maxUs, us);
+		}
+	}
+
+	for (size_t s = 0; s < out->size(); s++)
+	{
+		(*out)[s].avgUs = (*out)[s].totalMs * 1000.0 / (*out)[s].calls;
+	}
+	std::sort(out->begin(), out->end(), [](const CpuZoneStats& a, const CpuZoneStats& b) { return a.totalMs > b.totalMs; });
+}
+
+//-------------------------------------------------------------------
+//	writes every held zone as a Chrome trace event, one trace thread
+//	per profiled thread; each event starts with a comma so it can
+//	follow other events. Times are steady_clock microseconds.
+//
+//	@param:		file		an open trace after its first event
+//-------------------------------------------------------------------
+void writeCpuZoneEvents(std::ostream& file)
+{
+	std::lock_guard<std::mutex> lock(ringsMutex);
+	double scale = nsPerTick();
+	std::vector<ZoneEvent> events;
+
+	for (size_t r = 0; r < rings.size(); r++)
+	{
+		const ZoneRing& ring = *rings[r];
+		int tid = 100 + ring.id;
+		const char* threadName = ring.threadName;
+
+		file << ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << tid << ",\"args\":{\"name\":\""
+			<< (threadName != NULL ? threadName : "thread") << " " << ring.id << "\"}}";
+
+		snapshotRing(ring, &events);
+		for (size_t i = 0; i < events.size(); i++)
+		{
+			double beginUs = (originNs + (double)(int64_t)(events[i].begin - originTicks) * scale) / 1000.0;
+			double durationUs = (double)(events[i].end - events[i].begin) * scale / 1000.0;
+			file << ",\n{\"name\":\"" << events[i].name << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << tid
+				<< ",\"ts\":" << beginUs << ",\"dur\":" << durationUs << "}";
+		}
+	}
+}
+
+//-------------------------------------------------------------------
+//	@param:		path		the .json file to create
+//	@return:	true if the file was written
+//-------------------------------------------------------------------
+bool writeCpuTrace(const char* path)
+{
+	std::ofstream file(path, std::ios::out | std::ios::trunc);
+	if (!file)
+	{
+		std::cout << "ERROR::CPUPROFILER::COULD_NOT_CREATE " << path << std::endl;
+		return false;
+	}
+
+	file.setf(std::ios::fixed);
+	file.precision(3);
+	file << "{\"traceEvents\":[\n";
+	file << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"args\":{\"name\":\"firstOpenGLApplication\"}}";
+	writeCpuZoneEvents(file);
+	file << "\n]}\n";
+
+	if (!file)
+	{
+		std::cout << "ERROR::CPUPROFILER::WRITE_FAILED " << path << std::endl;
+		return false;
+	}
+	return true;
+}
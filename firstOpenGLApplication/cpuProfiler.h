@@ -0,0 +1,104 @@
+//************************************************************************************************************************
+//
+//	LearnOpenGL - cpuProfiler.h
+//
+//	Name:			Tucker Dane Walker
+//	Date:			August 2017
+//	Description:	Specifications for a scoped zone CPU profiler. PROFILE_ZONE("name") times the rest of the
+//					enclosing block. Each thread writes its zones into its own ring buffer with no locks; the
+//					rings are only read when a summary or trace is asked for. Timestamps come from the CPU's time
+//					stamp counter where there is one (steady_clock otherwise) so a zone costs a few nanoseconds.
+//
+//					build with CPU_PROFILER_ENABLED=0 to compile every zone out
+//
+//***********************************************************************************************************************/
+
+#ifndef CPU_PROFILER_H
+#define CPU_PROFILER_H
+
+#include <stdint.h>
+#include <chrono>
+#include <ostream>
+#include <vector>
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#define CPU_PROFILER_RDTSC 1
+#elif defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define CPU_PROFILER_RDTSC 1
+#endif
+
+#ifndef CPU_PROFILER_ENABLED
+#define CPU_PROFILER_ENABLED 1
+#endif
+
+// zones each thread keeps; older ones are overwritten (a power of two)
+//---------------------------------
+const int CPU_PROFILER_RING_SIZE = 1 << 14;
+
+// totals of one zone name over every zone still held in the rings
+//---------------------------------
+struct CpuZoneStats
+{
+	const char*	name;
+	int			calls;
+	double		totalMs;
+	double		avgUs;
+	double		maxUs;
+};
+
+//-------------------------------------------------------------------
+//	@return:	the current time in profiler ticks
+//-------------------------------------------------------------------
+inline uint64_t cpuProfilerTicks()
+{
+#ifdef CPU_PROFILER_RDTSC
+	return __rdtsc();
+#else
+	return (uint64_t)std::chrono::steady_clock::now().time_since_epoch().count();
+#endif
+}
+
+// RECORDING
+//---------------------------------
+void recordCpuZone(const char* name, uint64_t begin, uint64_t end);								// appends a finished zone to this thread's ring
+void setCpuProfilerThreadName(const char* name);												// names the calling thread in traces
+
+// RESULTS
+//---------------------------------
+void summarizeCpuZones(std::vector<CpuZoneStats>* out);											// per name totals, busiest first
+void writeCpuZoneEvents(std::ostream& file);													// appends Chrome trace events for every thread
+bool writeCpuTrace(const char* path);															// writes a Chrome trace of the CPU zones alone
+
+// times a block from construction to the end of its scope
+//---------------------------------
+class CpuZone
+{
+public:
+	explicit CpuZone(const char* zoneName)
+	{
+		name = zoneName;
+		begin = cpuProfilerTicks();
+	}
+	~CpuZone()
+	{
+		recordCpuZone(name, begin, cpuProfilerTicks());
+	}
+
+private:
+	const char*	name;
+	uint64_t	begin;
+};
+
+#if CPU_PROFILER_ENABLED
+#define PROFILE_ZONE_JOIN2(a, b) a##b
+#define PROFILE_ZONE_JOIN(a, b) PROFILE_ZONE_JOIN2(a, b)
+#define PROFILE_ZONE(name) CpuZone PROFILE_ZONE_JOIN(cpuZone, __LINE__)(name)
+#define PROFILE_THREAD(name) setCpuProfilerThreadName(name)
+#else
+#define PROFILE_ZONE(name)
+#define PROFILE_THREAD(name)
+#endif
+
+#endif
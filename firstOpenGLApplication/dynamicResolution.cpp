@@ -0,0 +1,204 @@
+//************************************************************************************************************************
+//
+//	LearnOpenGL - dynamicResolution.cpp
+//
+//	Name:			Tucker Dane Walker
+//	Date:			August 2017
+//	Description:	Implementation for dynamic resolution.
+//
+//***********************************************************************************************************************/
+
+#include "dynamicResolution.h"
+#include "glState.h"
+#include "gpuProfiler.h"
+#include "cpuProfiler.h"
+
+#include <math.h>
+#include <algorithm>
+#include <iostream>
+
+// scale changes smaller than this are not made; they would only shift the picture by a pixel
+//---------------------------------
+static const double MIN_SCALE_CHANGE = 0.01;
+
+//-------------------------------------------------------------------
+//	constructors
+//-------------------------------------------------------------------
+DynamicResolution::DynamicResolution()
+{
+	budgetMs = 0.0;
+	scale = 1.0;
+	smoothedMs = -1.0;
+	settleFrames = 0;
+	framebuffer = 0;
+	colorBuffer = 0;
+	bufferWidth = 0;
+	bufferHeight = 0;
+	output = 0;
+	frames = 0;
+	changes = 0;
+	minScale = 1.0;
+	scaleTotal = 0.0;
+}
+
+//-------------------------------------------------------------------
+//	makes the offscreen framebuffer; its color buffer is allocated by
+//	the first frame, once the window's size is known
+//
+//	@param:		budgetMs	GPU time per frame to stay under, 0 to draw
+//							straight to the window as before
+//-------------------------------------------------------------------
+void DynamicResolution::init(double budgetMs)
+{
+	this->budgetMs = std::max(budgetMs, 0.0);
+	if (!enabled())
+	{
+		return;
+	}
+	glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &output);		// the window's, or the headless context's
+	glGenFramebuffers(1, &framebuffer);
+	glGenRenderbuffers(1, &colorBuffer);
+}
+
+//-------------------------------------------------------------------
+//	deletes the offscreen framebuffer
+//-------------------------------------------------------------------
+void DynamicResolution::release()
+{
+	if (framebuffer != 0)
+	{
+		glDeleteFramebuffers(1, &framebuffer);
+		glDeleteRenderbuffers(1, &colorBuffer);
+		framebuffer = 0;
+		colorBuffer = 0;
+		bufferWidth = 0;
+		bufferHeight = 0;
+	}
+	budgetMs = 0.0;
+}
+
+//-------------------------------------------------------------------
+//	@return:	true if frames are drawn offscreen and scaled
+//-------------------------------------------------------------------
+bool DynamicResolution::enabled() const
+{
+	return budgetMs > 0.0;
+}
+
+//-------------------------------------------------------------------
+//	moves the scale towards the budget; frames still drawn at an
+//	older scale are skipped, as they say nothing about this one
+//
+//	@param:		gpuMs		GPU time of one frame, upscale included
+//-------------------------------------------------------------------
+void DynamicResolution::addFrameTime(double gpuMs)
+{
+	if (!enabled())
+	{
+		return;
+	}
+	if (settleFrames > 0)
+	{
+		settleFrames--;
+		return;
+	}
+	smoothedMs = (smoothedMs < 0.0) ? gpuMs : smoothedMs + DYNAMIC_RESOLUTION_SMOOTHING * (gpuMs - smoothedMs);
+
+	// pixels drawn go with the square of the scale
+	double fitted = scale * sqrt(budgetMs * DYNAMIC_RESOLUTION_AIM / std::max(smoothedMs, 0.001));
+	double next = scale;
+	if (smoothedMs > budgetMs)
+	{
+		next = fitted;
+	}
+	else if (smoothedMs < budgetMs * DYNAMIC_RESOLUTION_GROW_BELOW)
+	{
+		next = std::min(fitted, scale + DYNAMIC_RESOLUTION_MAX_GROWTH);
+	}
+	next = std::max(DYNAMIC_RESOLUTION_MIN_SCALE, std::min(next, 1.0));
+
+	if (fabs(next - scale) >= MIN_SCALE_CHANGE || (next == 1.0 && scale != 1.0))
+	{
+		scale = next;
+		changes++;
+		smoothedMs = -1.0;
+		settleFrames = GPU_PROFILER_LATENCY;		// frames the profiler has not read back yet
+	}
+}
+
+//-------------------------------------------------------------------
+//	binds the offscreen framebuffer, growing its color buffer if the
+//	window has grown, and sets the viewport to the scaled size
+//
+//	@param:		state		cache of the current context; its viewport
+//							is the window's when called
+//-------------------------------------------------------------------
+void DynamicResolution::beginFrame(GLStateCache* state)
+{
+	if (!enabled())
+	{
+		return;
+	}
+	state->getViewport(window);
+
+	if (window[2] > bufferWidth || window[3] > bufferHeight)
+	{
+		bufferWidth = std::max(window[2], bufferWidth);
+		bufferHeight = std::max(window[3], bufferHeight);
+		glBindRenderbuffer(GL_RENDERBUFFER, colorBuffer);
+		glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, bufferWidth, bufferHeight);
+		glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+		glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, colorBuffer);
+		if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+		{
+			std::cout << "ERROR::DYNAMIC_RESOLUTION::INCOMPLETE_FRAMEBUFFER " << bufferWidth << "x" << bufferHeight << std::endl;
+			glBindFramebuffer(GL_FRAMEBUFFER, output);
+			release();
+			return;
+		}
+	}
+
+	scaled[0] = std::max(1, (int)(window[2] * scale + 0.5));
+	scaled[1] = std::max(1, (int)(window[3] * scale + 0.5));
+	glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+	state->viewport(0, 0, scaled[0], scaled[1]);
+
+	frames++;
+	scaleTotal += scale;
+	minScale = std::min(minScale, scale);
+}
+
+//-------------------------------------------------------------------
+//	stretches the frame over the window with bilinear filtering and
+//	binds the window again, with its own viewport
+//
+//	@param:		state		cache of the current context
+//-------------------------------------------------------------------
+void DynamicResolution::endFrame(GLStateCache* state)
+{
+	if (!enabled())
+	{
+		return;
+	}
+	PROFILE_ZONE("upscale");
+	glBindFramebuffer(GL_READ_FRAMEBUFFER, framebuffer);
+	glBindFramebuffer(GL_DRAW_FRAMEBUFFER, output);
+	glBlitFramebuffer(0, 0, scaled[0], scaled[1], window[0], window[1], window[0] + window[2], window[1] + window[3],
+		GL_COLOR_BUFFER_BIT, GL_LINEAR);
+	glBindFramebuffer(GL_FRAMEBUFFER, output);		// captures and the headless read back see the window
+	state->viewport(window[0], window[1], window[2], window[3]);
+}
+
+//-------------------------------------------------------------------
+//	@return:	the scale the frames were drawn at
+//-------------------------------------------------------------------
+DynamicResolutionStats DynamicResolution::stats() const
+{
+	DynamicResolutionStats result;
+	result.frames = frames;
+	result.changes = changes;
+	result.scale = scale;
+	result.minScale = minScale;
+	result.avgScale = (frames > 0) ? scaleTotal / frames : 1.0;
+	return result;
+}
@@ -0,0 +1,95 @@
+//************************************************************************************************************************
+//
+//	LearnOpenGL - dynamicResolution.h
+//
+//	Name:			Tucker Dane Walker
+//	Date:			August 2017
+//	Description:	Specifications for dynamic resolution. The scene is drawn into an offscreen color buffer the
+//					size of the window, but only into a corner of it scaled by a controller, then stretched over
+//					the window with a filtered blit. The controller follows the GPU frame time the profiler reads
+//					back against a budget: fill cost goes with the square of the scale, so it steps the scale by
+//					the square root of budget over time, shrinking as soon as the smoothed time runs over and
+//					growing only once it is well under, and lets the frames drawn at the old scale read back
+//					before it judges the new one. Changing the scale never reallocates the buffer.
+//
+//***********************************************************************************************************************/
+
+#ifndef DYNAMIC_RESOLUTION_H
+#define DYNAMIC_RESOLUTION_H
+
+#include <glad/glad.h>
+
+class GLStateCache;
+
+// smallest fraction of the window's width and height the scene is drawn at
+//---------------------------------
+const double DYNAMIC_RESOLUTION_MIN_SCALE = 0.5;
+
+// the scale grows while the GPU time is under this fraction of the budget, and aims for the middle
+//---------------------------------
+const double DYNAMIC_RESOLUTION_GROW_BELOW = 0.75;
+const double DYNAMIC_RESOLUTION_AIM = 0.9;
+
+// most the scale grows by in one step; it shrinks by as much as it takes
+//---------------------------------
+const double DYNAMIC_RESOLUTION_MAX_GROWTH = 0.05;
+
+// how much of each new GPU time goes into the smoothed time
+//---------------------------------
+const double DYNAMIC_RESOLUTION_SMOOTHING = 0.25;
+
+// what the controller has done
+//---------------------------------
+struct DynamicResolutionStats
+{
+	int		frames;			// frames drawn offscreen
+	int		changes;		// times the scale changed
+	double	scale;			// scale of the last frame
+	double	minScale;		// smallest scale any frame was drawn at
+	double	avgScale;		// average scale over the frames
+};
+
+class DynamicResolution
+{
+public:
+	DynamicResolution();
+
+	// GL thread: start drawing offscreen against a GPU frame time budget, and free the buffer
+	//---------------------------------
+	void init(double budgetMs);
+	void release();
+	bool enabled() const;
+
+	// GL thread: feed a GPU frame time read back by the profiler, once per frame read back
+	//---------------------------------
+	void addFrameTime(double gpuMs);
+
+	// GL thread: beginFrame binds the offscreen buffer with the scaled viewport; endFrame stretches it
+	// over the framebuffer that was bound at init and gives back the window's viewport
+	//---------------------------------
+	void beginFrame(GLStateCache* state);
+	void endFrame(GLStateCache* state);
+
+	DynamicResolutionStats stats() const;
+
+private:
+	double		budgetMs;			// GPU frame time aimed for, 0 when disabled
+	double		scale;				// fraction of the window's width and height drawn
+	double		smoothedMs;			// recent GPU frame time, < 0 until the next sample restarts it
+	int			settleFrames;		// samples still to come from frames drawn at an older scale
+
+	GLuint		framebuffer;		// the offscreen target
+	GLuint		colorBuffer;
+	GLint		bufferWidth;		// size colorBuffer was allocated at
+	GLint		bufferHeight;
+	GLint		output;				// framebuffer the frame is stretched over
+	GLint		window[4];			// viewport of output during the frame
+	GLint		scaled[2];			// width and height drawn this frame
+
+	int			frames;
+	int			changes;
+	double		minScale;
+	double		scaleTotal;
+};
+
+#endif
@@ -0,0 +1,370 @@
+//************************************************************************************************************************
+//
+//	LearnOpenGL - frameCapture.cpp
+//
+//	Name:			Tucker Dane Walker
+//	Date:			August 2017
+//	Description:	Implementation for capturing rendered frames.
+//
+//***********************************************************************************************************************/
+
+#include "frameCapture.h"
+#include "glState.h"
+#include "image.h"
+#include "cpuProfiler.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <iostream>
+
+// longest a single wait for a read back blocks before it is retried, in ns
+//---------------------------------
+static const GLuint64 FENCE_WAIT_NS = 1000000000;
+
+//-------------------------------------------------------------------
+//	constructors
+//-------------------------------------------------------------------
+FrameCapture::FrameCapture()
+{
+	memset(slots, 0, sizeof(slots));
+	oldest = 0;
+	inFlight = 0;
+	nextIndex = 0;
+	sequence = false;
+	capturing = false;
+	stopping = false;
+	streamWidth = 0;
+	streamHeight = 0;
+	captured = 0;
+	stalls = 0;
+	written = 0;
+	dropped = 0;
+}
+
+//-------------------------------------------------------------------
+//	stops the encoder if close was never called; the pixel buffers
+//	are left to the context
+//-------------------------------------------------------------------
+FrameCapture::~FrameCapture()
+{
+	if (encoder.joinable())
+	{
+		{
+			std::lock_guard<std::mutex> lock(queueMutex);
+			stopping = true;
+		}
+		queueReady.notify_all();
+		encoder.join();
+	}
+}
+
+//-------------------------------------------------------------------
+//	makes the pixel buffers and starts the encoder; GL context must
+//	be current
+//
+//	@param:		path		a PNG sequence pattern holding a frame
+//							number ("frames/%05d.png"), or the file
+//							of a raw RGBA8 stream
+//	@return:	true if capturing has started
+//-------------------------------------------------------------------
+bool FrameCapture::open(const char* path)
+{
+	this->path = path;
+	sequence = (strchr(path, '%') != NULL);
+	if (!sequence)
+	{
+		stream.open(path, std::ios::out | std::ios::binary | std::ios::trunc);
+		if (!stream)
+		{
+			std::cout << "ERROR::CAPTURE::COULD_NOT_CREATE " << path << std::endl;
+			return false;
+		}
+	}
+
+	for (int i = 0; i < FRAME_CAPTURE_LATENCY; i++)
+	{
+		glGenBuffers(1, &slots[i].PBO);
+		slots[i].fence = 0;
+		slots[i].size = 0;
+	}
+	oldest = 0;
+	inFlight = 0;
+	stopping = false;
+	encoder = std::thread(&FrameCapture::encoderLoop, this);
+	capturing = true;
+	return true;
+}
+
+//-------------------------------------------------------------------
+//	waits for every read still in flight, lets the encoder write out
+//	its queue, then deletes the pixel buffers
+//-------------------------------------------------------------------
+void FrameCapture::close()
+{
+	if (!capturing)
+	{
+		return;
+	}
+
+	while (inFlight > 0)
+	{
+		collect(true);
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(queueMutex);
+		stopping = true;
+	}
+	queueReady.notify_all();
+	encoder.join();
+
+	for (int i = 0; i < FRAME_CAPTURE_LATENCY; i++)
+	{
+		currentGLState()->deleteBuffers(1, &slots[i].PBO);
+		slots[i].PBO = 0;
+	}
+	if (stream.is_open())
+	{
+		stream.close();
+	}
+	capturing = false;
+}
+
+//-------------------------------------------------------------------
+//	@return:	true between a successful open and close
+//-------------------------------------------------------------------
+bool FrameCapture::isOpen() const
+{
+	return capturing;
+}
+
+//-------------------------------------------------------------------
+//	starts reading the viewport of the read framebuffer into the next
+//	pixel buffer, then hands every earlier read that has finished to
+//	the encoder; only waits when the ring is full
+//-------------------------------------------------------------------
+void FrameCapture::capture()
+{
+	if (!capturing)
+	{
+		return;
+	}
+	PROFILE_ZONE("FrameCapture::capture");
+
+	// the oldest read must be mapped before its buffer is reused
+	if (inFlight == FRAME_CAPTURE_LATENCY)
+	{
+		collect(true);
+	}
+
+	GLint viewport[4];
+	glGetIntegerv(GL_VIEWPORT, viewport);
+
+	Slot& slot = slots[(oldest + inFlight) % FRAME_CAPTURE_LATENCY];
+	slot.index = nextIndex++;
+	slot.width = viewport[2];
+	slot.height = viewport[3];
+	GLsizeiptr size = (GLsizeiptr)slot.width * slot.height * 4;
+
+	// the copy into the buffer is queued like a draw; nothing waits for it here
+	GLStateCache* state = currentGLState();
+	state->bindBuffer(GL_PIXEL_PACK_BUFFER, slot.PBO);
+	if (size > slot.size)
+	{
+		glBufferData(GL_PIXEL_PACK_BUFFER, size, NULL, GL_STREAM_READ);
+		slot.size = size;
+	}
+	glReadPixels(viewport[0], viewport[1], slot.width, slot.height, GL_RGBA, GL_UNSIGNED_BYTE, (void*)0);
+	state->bindBuffer(GL_PIXEL_PACK_BUFFER, 0);		// other reads of pixels go to client memory again
+	slot.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+
+	inFlight++;
+	captured++;
+	collect(false);
+}
+
+//-------------------------------------------------------------------
+//	maps the reads in flight that have finished, oldest first, and
+//	queues their pixels for the encoder
+//
+//	@param:		wait		block until the oldest read has finished
+//							rather than stopping at it
+//-------------------------------------------------------------------
+void FrameCapture::collect(bool wait)
+{
+	GLStateCache* state = currentGLState();
+	while (inFlight > 0)
+	{
+		Slot& slot = slots[oldest];
+		GLenum result = glClientWaitSync(slot.fence, 0, 0);
+		if (result == GL_TIMEOUT_EXPIRED)
+		{
+			if (!wait)
+			{
+				return;
+			}
+			PROFILE_ZONE("capture stall");
+			stalls++;
+			do
+			{
+				result = glClientWaitSync(slot.fence, GL_SYNC_FLUSH_COMMANDS_BIT, FENCE_WAIT_NS);
+			} while (result == GL_TIMEOUT_EXPIRED);
+		}
+		wait = false;		// only the oldest read is ever waited for
+		if (result == GL_WAIT_FAILED)
+		{
+			std::cout << "ERROR::CAPTURE::WAIT_FAILED frame " << slot.index << std::endl;
+		}
+		glDeleteSync(slot.fence);
+		slot.fence = 0;
+
+		// the frame is dropped rather than letting the queue grow without bound
+		Frame frame;
+		bool queued = false;
+		{
+			std::lock_guard<std::mutex> lock(queueMutex);
+			if ((int)queue.size() < FRAME_CAPTURE_MAX_QUEUED)
+			{
+				queued = true;
+				if (!spare.empty())
+				{
+					frame.pixels.swap(spare.back());
+					spare.pop_back();
+				}
+			}
+		}
+
+		if (queued && result != GL_WAIT_FAILED)
+		{
+			PROFILE_ZONE("capture map");
+			frame.index = slot.index;
+			frame.width = slot.width;
+			frame.height = slot.height;
+			frame.pixels.resize((size_t)slot.width * slot.height * 4);
+
+			state->bindBuffer(GL_PIXEL_PACK_BUFFER, slot.PBO);
+			const void* pixels = glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, (GLsizeiptr)frame.pixels.size(), GL_MAP_READ_BIT);
+			if (pixels != NULL)
+			{
+				memcpy(&frame.pixels[0], pixels, frame.pixels.size());
+				glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+			}
+			state->bindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+			if (pixels != NULL)
+			{
+				{
+					std::lock_guard<std::mutex> lock(queueMutex);
+					queue.push_back(std::move(frame));
+				}
+				queueReady.notify_one();
+			}
+			else
+			{
+				std::cout << "ERROR::CAPTURE::MAP_FAILED frame " << slot.index << std::endl;
+				dropped++;
+			}
+		}
+		else
+		{
+			dropped++;
+		}
+
+		oldest = (oldest + 1) % FRAME_CAPTURE_LATENCY;
+		inFlight--;
+	}
+}
+
+//-------------------------------------------------------------------
+//	writes queued frames until close has been called and the queue
+//	is empty
+//-------------------------------------------------------------------
+void FrameCapture::encoderLoop()
+{
+	PROFILE_THREAD("capture encoder");
+	for (;;)
+	{
+		Frame frame;
+		{
+			std::unique_lock<std::mutex> lock(queueMutex);
+			while (!stopping && queue.empty())
+			{
+				queueReady.wait(lock);
+			}
+			if (queue.empty())
+			{
+				return;
+			}
+			frame = std::move(queue.front());
+			queue.pop_front();
+		}
+
+		{
+			PROFILE_ZONE("encode frame");
+			if (encode(&frame))
+			{
+				written++;
+			}
+			else
+			{
+				dropped++;
+			}
+		}
+
+		std::lock_guard<std::mutex> lock(queueMutex);
+		spare.push_back(std::move(frame.pixels));
+	}
+}
+
+//-------------------------------------------------------------------
+//	writes one frame as the next file of the sequence, or appends it
+//	to the stream
+//
+//	@param:		frame		the frame to write
+//	@return:	true if it was written
+//-------------------------------------------------------------------
+bool FrameCapture::encode(Frame* frame)
+{
+	if (sequence)
+	{
+		char name[1024];
+		snprintf(name, sizeof(name), path.c_str(), frame->index);
+		return writePNG(name, frame->width, frame->height, &frame->pixels[0]);
+	}
+
+	// a raw stream has no header, so every frame must be the size of the first
+	if (streamWidth == 0)
+	{
+		streamWidth = frame->width;
+		streamHeight = frame->height;
+	}
+	else if (frame->width != streamWidth || frame->height != streamHeight)
+	{
+		return false;
+	}
+
+	size_t rowBytes = (size_t)frame->width * 4;
+	for (int y = frame->height - 1; y >= 0; y--)
+	{
+		stream.write((const char*)&frame->pixels[y * rowBytes], (std::streamsize)rowBytes);
+	}
+	if (!stream)
+	{
+		std::cout << "ERROR::CAPTURE::WRITE_FAILED " << path << std::endl;
+		return false;
+	}
+	return true;
+}
+
+//-------------------------------------------------------------------
+//	@return:	frames captured, written and dropped so far
+//-------------------------------------------------------------------
+FrameCaptureStats FrameCapture::stats() const
+{
+	FrameCaptureStats result;
+	result.captured = captured;
+	result.written = written;
+	result.dropped = dropped;
+	result.stalls = stalls;
+	return result;
+}
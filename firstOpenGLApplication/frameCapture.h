@@ -0,0 +1,115 @@
+//************************************************************************************************************************
+//
+//	LearnOpenGL - frameCapture.h
+//
+//	Name:			Tucker Dane Walker
+//	Date:			August 2017
+//	Description:	Specifications for capturing rendered frames without stalling the render loop. Each frame is
+//					read back into the next pixel buffer object of a ring and fenced; the read is only mapped
+//					once its fence has signalled, normally FRAME_CAPTURE_LATENCY frames later, so the GPU copy
+//					overlaps with rendering instead of waiting for it. Mapped pixels are handed to a background
+//					encoder thread that writes a numbered PNG sequence or appends to a raw video stream.
+//
+//					a path holding a printf style frame number ("frames/%05d.png") is a PNG sequence; any other
+//					path is a raw stream of RGBA8 frames, top row first, all the size of the first frame
+//
+//***********************************************************************************************************************/
+
+#ifndef FRAME_CAPTURE_H
+#define FRAME_CAPTURE_H
+
+#include <glad/glad.h>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// pixel buffers in the ring; a frame is mapped this many frames after it was read back
+//---------------------------------
+const int FRAME_CAPTURE_LATENCY = 3;
+
+// frames waiting for the encoder; frames read back while it is this far behind are dropped
+//---------------------------------
+const int FRAME_CAPTURE_MAX_QUEUED = 8;
+
+// what a capture has done so far
+//---------------------------------
+struct FrameCaptureStats
+{
+	int		captured;		// frames read back
+	int		written;		// frames the encoder has written
+	int		dropped;		// frames skipped because the encoder fell behind or the size changed
+	int		stalls;			// reads the render loop had to wait for because the ring was full
+};
+
+class FrameCapture
+{
+public:
+	FrameCapture();
+	~FrameCapture();
+
+	// GL thread: start capturing to path, and stop, writing out every frame still in flight
+	//---------------------------------
+	bool open(const char* path);
+	void close();
+	bool isOpen() const;
+
+	// GL thread: read back the framebuffer bound for reading, before it is swapped
+	//---------------------------------
+	void capture();
+
+	FrameCaptureStats stats() const;
+
+private:
+	struct Slot
+	{
+		GLuint		PBO;			// pixel buffer the frame is read into
+		GLsync		fence;			// signalled once the read has finished
+		int			index;			// frame number
+		int			width;
+		int			height;
+		GLsizeiptr	size;			// bytes allocated for PBO
+	};
+
+	struct Frame
+	{
+		int							index;
+		int							width;
+		int							height;
+		std::vector<unsigned char>	pixels;		// RGBA8, bottom row first
+	};
+
+	void collect(bool wait);
+	void encoderLoop();
+	bool encode(Frame* frame);
+
+	Slot							slots[FRAME_CAPTURE_LATENCY];	// ring of reads in flight
+	int								oldest;			// slot of the oldest read in flight
+	int								inFlight;		// reads not yet mapped
+	int								nextIndex;		// number of the next frame read back
+	std::string						path;			// sequence pattern or stream file
+	bool							sequence;		// path is a PNG sequence pattern
+	bool							capturing;		// open has succeeded and close has not run
+
+	std::thread						encoder;		// writes frames out
+	std::mutex						queueMutex;		// guards queue, spare and stopping
+	std::condition_variable			queueReady;		// signalled when queue grows or on close
+	std::deque<Frame>				queue;			// mapped frames waiting for the encoder
+	std::vector<std::vector<unsigned char> >	spare;	// pixel buffers the encoder is done with, reused
+	bool							stopping;
+
+	std::ofstream					stream;			// raw stream, encoder thread only
+	int								streamWidth;	// size of every frame in the stream
+	int								streamHeight;
+
+	int								captured;
+	int								stalls;
+	std::atomic<int>				written;
+	std::atomic<int>				dropped;
+};
+
+#endif
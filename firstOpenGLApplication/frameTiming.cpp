@@ -0,0 +1,117 @@
+//************************************************************************************************************************
+//
+//	LearnOpenGL - frameTiming.cpp
+//
+//	Name:			Tucker Dane Walker
+//	Date:			August 2017
+//	Description:	Implementation for the fixed step simulation clock and the frame limiter.
+//
+//***********************************************************************************************************************/
+
+#include "frameTiming.h"
+
+#include <algorithm>
+#include <thread>
+
+//-------------------------------------------------------------------
+//	@param:		stepSeconds	length of one simulation step
+//-------------------------------------------------------------------
+SimulationClock::SimulationClock(double stepSeconds)
+{
+	this->stepSeconds = stepSeconds;
+	accumulator = 0.0;
+	simulated = 0.0;
+}
+
+//-------------------------------------------------------------------
+//	@param:		frameSeconds	real time the last frame took
+//	@return:	the number of steps to simulate this frame
+//-------------------------------------------------------------------
+int SimulationClock::advance(double frameSeconds)
+{
+	accumulator += std::min(std::max(frameSeconds, 0.0), SIMULATION_MAX_FRAME);
+
+	int steps = 0;
+	while (accumulator >= stepSeconds)
+	{
+		accumulator -= stepSeconds;
+		simulated += stepSeconds;
+		steps++;
+	}
+	return steps;
+}
+
+//-------------------------------------------------------------------
+//	@return:	length of one step in seconds
+//-------------------------------------------------------------------
+double SimulationClock::step() const
+{
+	return stepSeconds;
+}
+
+//-------------------------------------------------------------------
+//	@return:	how far the frame is between the last step and the
+//				next one (0 - 1); blend the last two states by it
+//-------------------------------------------------------------------
+double SimulationClock::alpha() const
+{
+	return accumulator / stepSeconds;
+}
+
+//-------------------------------------------------------------------
+//	@return:	total simulated time in seconds
+//-------------------------------------------------------------------
+double SimulationClock::time() const
+{
+	return simulated;
+}
+
+//-------------------------------------------------------------------
+//	@param:		maxFps		frame rate cap; 0 or less disables it
+//-------------------------------------------------------------------
+FrameLimiter::FrameLimiter(double maxFps)
+{
+	enabled = maxFps > 0.0;
+	period = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(enabled ? 1.0 / maxFps : 0.0));
+	deadline = Clock::now();
+	sleepError = std::chrono::milliseconds(2);
+}
+
+//-------------------------------------------------------------------
+//	sleeps in 1 ms slices while more than the expected sleep error
+//	remains, then spins to the deadline; the sleep error estimate
+//	grows with every late sleep and slowly shrinks back
+//-------------------------------------------------------------------
+void FrameLimiter::wait()
+{
+	if (!enabled)
+	{
+		return;
+	}
+
+	deadline += period;
+	Clock::time_point now = Clock::now();
+
+	// behind; start the next frame now rather than rushing to catch up
+	if (now >= deadline)
+	{
+		deadline = now;
+		return;
+	}
+
+	const Clock::duration slice = std::chrono::milliseconds(1);
+	while (deadline - now > sleepError + slice)
+	{
+		std::this_thread::sleep_for(slice);
+		Clock::time_point woke = Clock::now();
+
+		Clock::duration late = (woke - now) - slice;
+		sleepError = std::max(late, sleepError - sleepError / 64);
+		now = woke;
+	}
+
+	while (Clock::now() < deadline)
+	{
+		std::this_thread::yield();
+	}
+}
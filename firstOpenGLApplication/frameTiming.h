@@ -0,0 +1,59 @@
+//************************************************************************************************************************
+//
+//	LearnOpenGL - frameTiming.h
+//
+//	Name:			Tucker Dane Walker
+//	Date:			August 2017
+//	Description:	Specifications for frame timing: a fixed step simulation clock that decouples animation from
+//					the frame rate (rendering interpolates between the last two steps), and a frame limiter that
+//					caps the frame rate by sleeping for most of the wait and spinning for the rest.
+//
+//***********************************************************************************************************************/
+
+#ifndef FRAME_TIMING_H
+#define FRAME_TIMING_H
+
+#include <chrono>
+
+// longest frame the simulation catches up on; anything longer is slowed down rather than run in a burst
+//---------------------------------
+const double SIMULATION_MAX_FRAME = 0.25;
+
+class SimulationClock
+{
+public:
+	SimulationClock(double stepSeconds);
+
+	// adds a frame's worth of time; returns how many fixed steps to run
+	//---------------------------------
+	int advance(double frameSeconds);
+
+	double step() const;
+	double alpha() const;
+	double time() const;
+
+private:
+	double	stepSeconds;	// length of one simulation step
+	double	accumulator;	// time not yet simulated, less than one step after advance
+	double	simulated;		// total time simulated
+};
+
+class FrameLimiter
+{
+public:
+	FrameLimiter(double maxFps);
+
+	// blocks until the next frame may start; returns at once when uncapped
+	//---------------------------------
+	void wait();
+
+private:
+	typedef std::chrono::steady_clock Clock;
+
+	bool				enabled;
+	Clock::duration		period;			// time between frame starts
+	Clock::time_point	deadline;		// when the next frame may start
+	Clock::duration		sleepError;		// how late a short sleep has been; the rest of the wait is spun
+};
+
+#endif
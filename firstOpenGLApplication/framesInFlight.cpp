@@ -0,0 +1,214 @@
+//************************************************************************************************************************
+//
+//	LearnOpenGL - framesInFlight.cpp
+//
+//	Name:			Tucker Dane Walker
+//	Date:			August 2017
+//	Description:	Implementation for pacing the CPU against the GPU.
+//
+//***********************************************************************************************************************/
+
+#include "framesInFlight.h"
+#include "cpuProfiler.h"
+
+#include <string.h>
+#include <algorithm>
+#include <iostream>
+
+// longest a single wait for a frame blocks before it is retried, in ns
+//---------------------------------
+static const GLuint64 FENCE_WAIT_NS = 1000000000;
+
+//-------------------------------------------------------------------
+//	waits for a frame's fence. A failed wait says nothing about the
+//	frame, so rather than reuse a slot the GPU may still be reading,
+//	every frame is finished with glFinish and the fence counts as
+//	signalled
+//
+//	@param:		fence		the frame's fence
+//	@param:		flags		glClientWaitSync flags
+//	@param:		timeoutNs	longest to block, 0 to only look
+//	@param:		slot		the frame's slot, for the error
+//	@return:	GL_TIMEOUT_EXPIRED if the frame is still running,
+//				otherwise it has finished
+//-------------------------------------------------------------------
+static GLenum waitForFence(GLsync fence, GLbitfield flags, GLuint64 timeoutNs, int slot)
+{
+	GLenum result = glClientWaitSync(fence, flags, timeoutNs);
+	if (result == GL_WAIT_FAILED)
+	{
+		std::cout << "ERROR::FRAMES_IN_FLIGHT::WAIT_FAILED slot " << slot << ", finishing the GPU" << std::endl;
+		glFinish();
+		result = GL_CONDITION_SATISFIED;
+	}
+	return result;
+}
+
+//-------------------------------------------------------------------
+//	constructors
+//-------------------------------------------------------------------
+FramesInFlight::FramesInFlight()
+{
+	frameDepth = 1;
+	current = 0;
+	memset(&totals, 0, sizeof(totals));
+}
+
+//-------------------------------------------------------------------
+//	@param:		depth		frames the CPU may run ahead of the GPU,
+//							1 to MAX_FRAMES_IN_FLIGHT
+//-------------------------------------------------------------------
+void FramesInFlight::init(int depth)
+{
+	release();
+	frameDepth = std::max(1, std::min(depth, MAX_FRAMES_IN_FLIGHT));
+	current = 0;
+	memset(&totals, 0, sizeof(totals));
+}
+
+//-------------------------------------------------------------------
+//	deletes the fences still pending without waiting for them
+//-------------------------------------------------------------------
+void FramesInFlight::release()
+{
+	for (int i = 0; i < MAX_FRAMES_IN_FLIGHT; i++)
+	{
+		if (slots[i].fence != 0)
+		{
+			glDeleteSync(slots[i].fence);
+			slots[i].fence = 0;
+		}
+	}
+}
+
+//-------------------------------------------------------------------
+//	@return:	frames the CPU may run ahead of the GPU
+//-------------------------------------------------------------------
+int FramesInFlight::depth() const
+{
+	return frameDepth;
+}
+
+//-------------------------------------------------------------------
+//	retires every frame that has finished, oldest first, then waits
+//	for the frame that last used the next slot if it has not
+//
+//	@return:	slot of the frame starting now, 0 to depth - 1; its
+//				per-frame resources are no longer read by the GPU
+//-------------------------------------------------------------------
+int FramesInFlight::beginFrame()
+{
+	// frames finish in order, so the first one still running ends the look;
+	// each is retired as soon as it is seen, which is when its latency ends
+	for (int i = 0; i < frameDepth; i++)
+	{
+		int index = (current + i) % frameDepth;
+		Slot& slot = slots[index];
+		if (slot.fence == 0)
+		{
+			continue;
+		}
+		if (waitForFence(slot.fence, 0, 0, index) == GL_TIMEOUT_EXPIRED)
+		{
+			break;
+		}
+		retire(&slot, Clock::now());
+	}
+
+	// the CPU is a whole depth ahead; hold it back until the GPU catches up
+	Slot& slot = slots[current];
+	if (slot.fence != 0)
+	{
+		PROFILE_ZONE("wait for GPU");
+		Clock::time_point waitStart = Clock::now();
+		GLenum result;
+		do
+		{
+			result = waitForFence(slot.fence, GL_SYNC_FLUSH_COMMANDS_BIT, FENCE_WAIT_NS, current);
+		} while (result == GL_TIMEOUT_EXPIRED);
+
+		Clock::time_point finished = Clock::now();
+		totals.waits++;
+		totals.waitedMs += std::chrono::duration<double, std::milli>(finished - waitStart).count();
+		retire(&slot, finished);
+	}
+	return current;
+}
+
+//-------------------------------------------------------------------
+//	fences everything the frame submitted, swap included, and moves on
+//	to the next slot
+//
+//	@param:		sampleTime	when the frame sampled its input
+//	@param:		keyInput	the frame handled a key from the window
+//	@param:		keyTime		when the oldest of those keys arrived
+//-------------------------------------------------------------------
+void FramesInFlight::endFrame(Clock::time_point sampleTime, bool keyInput, Clock::time_point keyTime)
+{
+	Slot& slot = slots[current];
+	slot.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+	slot.sampleTime = sampleTime;
+	slot.keyTime = keyTime;
+	slot.keyInput = keyInput;
+	current = (current + 1) % frameDepth;
+}
+
+//-------------------------------------------------------------------
+//	waits for every frame in flight and retires them, oldest first;
+//	these waits are not pacing, so they are not counted as waits
+//-------------------------------------------------------------------
+void FramesInFlight::finish()
+{
+	for (int i = 0; i < frameDepth; i++)
+	{
+		int index = (current + i) % frameDepth;
+		Slot& slot = slots[index];
+		if (slot.fence == 0)
+		{
+			continue;
+		}
+		GLenum result;
+		do
+		{
+			result = waitForFence(slot.fence, GL_SYNC_FLUSH_COMMANDS_BIT, FENCE_WAIT_NS, index);
+		} while (result == GL_TIMEOUT_EXPIRED);
+		retire(&slot, Clock::now());
+	}
+}
+
+//-------------------------------------------------------------------
+//	adds a finished frame's latency to the totals and frees its slot
+//
+//	@param:		slot		the frame's slot
+//	@param:		finished	when its fence was seen to have signalled
+//-------------------------------------------------------------------
+void FramesInFlight::retire(Slot* slot, Clock::time_point finished)
+{
+	glDeleteSync(slot->fence);
+	slot->fence = 0;
+
+	double latencyMs = std::chrono::duration<double, std::milli>(finished - slot->sampleTime).count();
+	totals.frames++;
+	totals.lastLatencyMs = latencyMs;
+	totals.latencyAvgMs += latencyMs;
+	totals.latencyMaxMs = std::max(totals.latencyMaxMs, latencyMs);
+
+	if (slot->keyInput)
+	{
+		double keyLatencyMs = std::chrono::duration<double, std::milli>(finished - slot->keyTime).count();
+		totals.keyFrames++;
+		totals.keyLatencyAvgMs += keyLatencyMs;
+		totals.keyLatencyMaxMs = std::max(totals.keyLatencyMaxMs, keyLatencyMs);
+	}
+}
+
+//-------------------------------------------------------------------
+//	@return:	waits and latency of every frame finished so far
+//-------------------------------------------------------------------
+FramePacingStats FramesInFlight::stats() const
+{
+	FramePacingStats result = totals;
+	result.latencyAvgMs = (totals.frames > 0) ? totals.latencyAvgMs / totals.frames : 0.0;
+	result.keyLatencyAvgMs = (totals.keyFrames > 0) ? totals.keyLatencyAvgMs / totals.keyFrames : 0.0;
+	return result;
+}
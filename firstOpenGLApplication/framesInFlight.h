@@ -0,0 +1,90 @@
+//************************************************************************************************************************
+//
+//	LearnOpenGL - framesInFlight.h
+//
+//	Name:			Tucker Dane Walker
+//	Date:			August 2017
+//	Description:	Specifications for pacing the CPU against the GPU. Every frame is fenced after its swap, and a
+//					frame may only start once the frame depth frames before it has finished on the GPU, so the
+//					CPU never runs more than depth frames ahead however deep the driver's own queue is. A depth
+//					of 1 gives the lowest latency and the least overlap, 3 the most throughput. The slot a frame
+//					is given names its per-frame resources, which are free to overwrite without a sync because
+//					the last frame that used them has finished.
+//
+//					input-to-photon latency is the time from a frame's input to its fence signalling, as seen
+//					by the CPU: from when a key arrived for frames that handled one, from when the frame sampled
+//					its input otherwise. Scan out after the fence is not included.
+//
+//***********************************************************************************************************************/
+
+#ifndef FRAMES_IN_FLIGHT_H
+#define FRAMES_IN_FLIGHT_H
+
+#include <glad/glad.h>
+#include <chrono>
+
+// deepest the CPU may run ahead of the GPU, in frames
+//---------------------------------
+const int MAX_FRAMES_IN_FLIGHT = 3;
+
+// what the pacing has cost and how late frames were seen
+//---------------------------------
+struct FramePacingStats
+{
+	int		frames;			// frames whose fence has signalled
+	int		waits;			// frames that had to wait for the GPU before starting
+	double	waitedMs;		// total time spent in those waits
+	double	lastLatencyMs;	// latency of the last frame to finish
+	double	latencyAvgMs;	// input sampled to fence signalled, over every finished frame
+	double	latencyMaxMs;
+	int		keyFrames;		// finished frames that handled a key from the window
+	double	keyLatencyAvgMs;	// key arrived to fence signalled, over those frames
+	double	keyLatencyMaxMs;
+};
+
+class FramesInFlight
+{
+public:
+	typedef std::chrono::steady_clock Clock;
+
+	FramesInFlight();
+
+	// set the depth (clamped to 1..MAX_FRAMES_IN_FLIGHT), and delete the fences still pending; GL thread
+	//---------------------------------
+	void init(int depth);
+	void release();
+	int depth() const;
+
+	// GL thread: beginFrame waits until the frame's slot is free and returns it; endFrame fences the
+	// frame once it has been swapped. keyTime is when its oldest key arrived, if keyInput
+	//---------------------------------
+	int beginFrame();
+	void endFrame(Clock::time_point sampleTime, bool keyInput, Clock::time_point keyTime);
+
+	// GL thread: waits for every frame in flight, before the loop sleeps
+	//---------------------------------
+	void finish();
+
+	FramePacingStats stats() const;
+
+private:
+	struct Slot
+	{
+		GLsync				fence;			// signalled once the slot's last frame has finished, 0 when free
+		Clock::time_point	sampleTime;		// when that frame sampled its input
+		Clock::time_point	keyTime;		// when its oldest key arrived
+		bool				keyInput;		// it handled a key from the window
+
+		Slot() : fence(0), keyInput(false) {}
+	};
+
+	void retire(Slot* slot, Clock::time_point finished);
+
+	Slot		slots[MAX_FRAMES_IN_FLIGHT];
+	int			frameDepth;		// slots in use
+	int			current;		// slot of the frame being built
+
+	FramePacingStats	totals;		// latency sums rather than averages until stats
+};
+
+#endif
@@ -0,0 +1,255 @@
+//************************************************************************************************************************
+//
+//	LearnOpenGL - glState.cpp
+//
+//	Name:			Tucker Dane Walker
+//	Date:			August 2017
+//	Description:	Implementation for the GL state cache.
+//
+//***********************************************************************************************************************/
+
+#include "glState.h"
+
+#include <string.h>
+
+// marks a binding the cache does not know; no object has this name
+//---------------------------------
+static const GLuint UNKNOWN_BINDING = 0xFFFFFFFF;
+
+//-------------------------------------------------------------------
+//	@param:		target		a buffer binding target
+//	@return:	the slot the cache tracks it in, or -1 if untracked
+//-------------------------------------------------------------------
+static int bufferSlot(GLenum target)
+{
+	switch (target)
+	{
+	case GL_ARRAY_BUFFER:			return GL_STATE_ARRAY_BUFFER;
+	case GL_ELEMENT_ARRAY_BUFFER:	return GL_STATE_ELEMENT_BUFFER;
+	case GL_COPY_READ_BUFFER:		return GL_STATE_COPY_READ_BUFFER;
+	case GL_COPY_WRITE_BUFFER:		return GL_STATE_COPY_WRITE_BUFFER;
+	case GL_PIXEL_PACK_BUFFER:		return GL_STATE_PIXEL_PACK_BUFFER;
+	default:						return -1;
+	}
+}
+
+//-------------------------------------------------------------------
+//	constructors
+//-------------------------------------------------------------------
+GLStateCache::GLStateCache()
+{
+	invalidate();
+	memset(&frame, 0, sizeof(frame));
+}
+
+//-------------------------------------------------------------------
+//	@param:		program		the program to use
+//-------------------------------------------------------------------
+void GLStateCache::useProgram(GLuint program)
+{
+	if (program == this->program)
+	{
+		frame.filtered++;
+		return;
+	}
+	glUseProgram(program);
+	this->program = program;
+	frame.issued++;
+}
+
+//-------------------------------------------------------------------
+//	@param:		VAO			the vertex array to bind; the element
+//							buffer binding changes along with it
+//-------------------------------------------------------------------
+void GLStateCache::bindVertexArray(GLuint VAO)
+{
+	if (VAO == this->VAO)
+	{
+		frame.filtered++;
+		return;
+	}
+	glBindVertexArray(VAO);
+	this->VAO = VAO;
+	buffers[GL_STATE_ELEMENT_BUFFER] = UNKNOWN_BINDING;
+	frame.issued++;
+}
+
+//-------------------------------------------------------------------
+//	@param:		target		the binding target
+//	@param:		buffer		the buffer to bind to it
+//-------------------------------------------------------------------
+void GLStateCache::bindBuffer(GLenum target, GLuint buffer)
+{
+	int slot = bufferSlot(target);
+	if (slot >= 0 && buffer == buffers[slot])
+	{
+		frame.filtered++;
+		return;
+	}
+	glBindBuffer(target, buffer);
+	if (slot >= 0)
+	{
+		buffers[slot] = buffer;
+	}
+	frame.issued++;
+}
+
+//-------------------------------------------------------------------
+//	@param:		mode		polygon mode of front and back faces
+//-------------------------------------------------------------------
+void GLStateCache::polygonMode(GLenum mode)
+{
+	if (mode == fillMode)
+	{
+		frame.filtered++;
+		return;
+	}
+	glPolygonMode(GL_FRONT_AND_BACK, mode);
+	fillMode = mode;
+	frame.issued++;
+}
+
+//-------------------------------------------------------------------
+//	@param:		x, y			lower left corner of the viewport
+//	@param:		width, height	size of the viewport in pixels
+//-------------------------------------------------------------------
+void GLStateCache::viewport(GLint x, GLint y, GLsizei width, GLsizei height)
+{
+	if (viewportKnown && x == viewportRect[0] && y == viewportRect[1] && width == viewportRect[2] && height == viewportRect[3])
+	{
+		frame.filtered++;
+		return;
+	}
+	glViewport(x, y, width, height);
+	viewportRect[0] = x;
+	viewportRect[1] = y;
+	viewportRect[2] = width;
+	viewportRect[3] = height;
+	viewportKnown = true;
+	frame.issued++;
+}
+
+//-------------------------------------------------------------------
+//	@param:		rect		receives x, y, width and height of the
+//							viewport
+//-------------------------------------------------------------------
+void GLStateCache::getViewport(GLint* rect)
+{
+	if (!viewportKnown)
+	{
+		glGetIntegerv(GL_VIEWPORT, viewportRect);
+		viewportKnown = true;
+	}
+	memcpy(rect, viewportRect, sizeof(viewportRect));
+}
+
+//-------------------------------------------------------------------
+//	@param:		red, green, blue, alpha		the color glClear fills with
+//-------------------------------------------------------------------
+void GLStateCache::clearColor(GLfloat red, GLfloat green, GLfloat blue, GLfloat alpha)
+{
+	if (clearKnown && red == clearRGBA[0] && green == clearRGBA[1] && blue == clearRGBA[2] && alpha == clearRGBA[3])
+	{
+		frame.filtered++;
+		return;
+	}
+	glClearColor(red, green, blue, alpha);
+	clearRGBA[0] = red;
+	clearRGBA[1] = green;
+	clearRGBA[2] = blue;
+	clearRGBA[3] = alpha;
+	clearKnown = true;
+	frame.issued++;
+}
+
+//-------------------------------------------------------------------
+//	deletes buffers; GL unbinds a deleted buffer, so the cache does too
+//
+//	@param:		count		number of buffers
+//	@param:		buffers		their names
+//-------------------------------------------------------------------
+void GLStateCache::deleteBuffers(GLsizei count, const GLuint* buffers)
+{
+	for (GLsizei i = 0; i < count; i++)
+	{
+		for (int slot = 0; slot < GL_STATE_BUFFER_SLOTS; slot++)
+		{
+			if (this->buffers[slot] == buffers[i])
+			{
+				this->buffers[slot] = 0;
+			}
+		}
+	}
+	glDeleteBuffers(count, buffers);
+}
+
+//-------------------------------------------------------------------
+//	deletes vertex arrays; deleting the bound one binds 0
+//
+//	@param:		count		number of vertex arrays
+//	@param:		VAOs		their names
+//-------------------------------------------------------------------
+void GLStateCache::deleteVertexArrays(GLsizei count, const GLuint* VAOs)
+{
+	for (GLsizei i = 0; i < count; i++)
+	{
+		if (VAO == VAOs[i])
+		{
+			VAO = 0;
+			buffers[GL_STATE_ELEMENT_BUFFER] = UNKNOWN_BINDING;
+		}
+	}
+	glDeleteVertexArrays(count, VAOs);
+}
+
+//-------------------------------------------------------------------
+//	forgets all state; the next call of each kind is always issued
+//-------------------------------------------------------------------
+void GLStateCache::invalidate()
+{
+	program = UNKNOWN_BINDING;
+	VAO = UNKNOWN_BINDING;
+	for (int slot = 0; slot < GL_STATE_BUFFER_SLOTS; slot++)
+	{
+		buffers[slot] = UNKNOWN_BINDING;
+	}
+	fillMode = UNKNOWN_BINDING;
+	viewportKnown = false;
+	clearKnown = false;
+}
+
+//-------------------------------------------------------------------
+//	@return:	the calls issued and filtered since the previous call,
+//				after which the counters start again from zero
+//-------------------------------------------------------------------
+GLStateStats GLStateCache::endFrame()
+{
+	GLStateStats stats = frame;
+	memset(&frame, 0, sizeof(frame));
+	return stats;
+}
+
+//-------------------------------------------------------------------
+//	the current cache, per thread: a context is current on one thread
+//	at a time, and each thread starts with a cache of its own
+//-------------------------------------------------------------------
+static thread_local GLStateCache defaultState;
+static thread_local GLStateCache* currentState = NULL;
+
+//-------------------------------------------------------------------
+//	@return:	the cache of the context current on this thread
+//-------------------------------------------------------------------
+GLStateCache* currentGLState()
+{
+	return (currentState != NULL) ? currentState : &defaultState;
+}
+
+//-------------------------------------------------------------------
+//	@param:		cache		the cache of the context just made current
+//							on this thread, or NULL for the thread's
+//							default cache
+//-------------------------------------------------------------------
+void setCurrentGLState(GLStateCache* cache)
+{
+	currentState = cache;
+}
@@ -0,0 +1,89 @@
+//************************************************************************************************************************
+//
+//	LearnOpenGL - glState.h
+//
+//	Name:			Tucker Dane Walker
+//	Date:			August 2017
+//	Description:	Specifications for a GL state cache: a thin layer in front of the bind and fixed function
+//					calls the renderer makes every frame. It remembers what the context has bound and drops any
+//					call that would not change it, counting both the calls it issued and the ones it filtered.
+//
+//					all bind calls for the tracked state must go through the cache, or the cache must be
+//					invalidated afterwards
+//
+//***********************************************************************************************************************/
+
+#ifndef GL_STATE_H
+#define GL_STATE_H
+
+#include <glad/glad.h>
+
+// buffer targets the cache tracks; binds to any other target are always issued
+//---------------------------------
+enum GLStateBufferSlot
+{
+	GL_STATE_ARRAY_BUFFER,			// GL_ARRAY_BUFFER
+	GL_STATE_ELEMENT_BUFFER,		// GL_ELEMENT_ARRAY_BUFFER, part of the bound VAO
+	GL_STATE_COPY_READ_BUFFER,		// GL_COPY_READ_BUFFER
+	GL_STATE_COPY_WRITE_BUFFER,		// GL_COPY_WRITE_BUFFER
+	GL_STATE_PIXEL_PACK_BUFFER,		// GL_PIXEL_PACK_BUFFER, where glReadPixels writes
+	GL_STATE_BUFFER_SLOTS
+};
+
+// calls made through the cache since the last call to endFrame
+//---------------------------------
+struct GLStateStats
+{
+	int		issued;			// calls passed on to OpenGL
+	int		filtered;		// calls dropped because they would not change anything
+};
+
+class GLStateCache
+{
+public:
+	// constructors; nothing is known about the context until it is first set
+	//---------------------------------
+	GLStateCache();
+
+	// state changes; each is dropped when the state already matches
+	//---------------------------------
+	void useProgram(GLuint program);
+	void bindVertexArray(GLuint VAO);
+	void bindBuffer(GLenum target, GLuint buffer);
+	void polygonMode(GLenum mode);
+	void viewport(GLint x, GLint y, GLsizei width, GLsizei height);
+	void clearColor(GLfloat red, GLfloat green, GLfloat blue, GLfloat alpha);
+
+	// the viewport last set, read from the context when the cache does not know it
+	//---------------------------------
+	void getViewport(GLint* rect);
+
+	// deletes objects, forgetting any binding to them so a reused name is bound again
+	//---------------------------------
+	void deleteBuffers(GLsizei count, const GLuint* buffers);
+	void deleteVertexArrays(GLsizei count, const GLuint* VAOs);
+
+	// forget everything; call after state was changed without the cache
+	//---------------------------------
+	void invalidate();
+
+	GLStateStats endFrame();
+
+private:
+	GLuint			program;						// bound program
+	GLuint			VAO;							// bound vertex array
+	GLuint			buffers[GL_STATE_BUFFER_SLOTS];	// bound buffer of each tracked target
+	GLenum			fillMode;						// polygon mode of front and back faces
+	GLint			viewportRect[4];				// x, y, width, height
+	GLfloat			clearRGBA[4];					// clear color
+	bool			viewportKnown;
+	bool			clearKnown;
+	GLStateStats	frame;							// totals since the last endFrame
+};
+
+// the cache of the context current on the calling thread; each thread has its own unless another is made current
+//---------------------------------
+GLStateCache* currentGLState();																	// the cache calls go through
+void setCurrentGLState(GLStateCache* cache);													// switch caches along with the context
+
+#endif
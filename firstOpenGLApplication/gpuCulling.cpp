@@ -0,0 +1,462 @@
+//************************************************************************************************************************
+//
+//	LearnOpenGL - gpuCulling.cpp
+//
+//	Name:			Tucker Dane Walker
+//	Date:			August 2017
+//	Description:	Implementation for culling and draw submission on the GPU.
+//
+//***********************************************************************************************************************/
+
+#include "gpuCulling.h"
+#include "glState.h"
+#include "shader.h"
+#include "cpuProfiler.h"
+
+#include <string.h>
+#include <algorithm>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// GL 4.3 names glad was not generated with
+//---------------------------------
+#ifndef GL_COMPUTE_SHADER
+#define GL_COMPUTE_SHADER							0x91B9
+#endif
+#ifndef GL_SHADER_STORAGE_BUFFER
+#define GL_SHADER_STORAGE_BUFFER					0x90D2
+#endif
+#ifndef GL_SHADER_STORAGE_BUFFER_OFFSET_ALIGNMENT
+#define GL_SHADER_STORAGE_BUFFER_OFFSET_ALIGNMENT	0x90DF
+#endif
+#ifndef GL_DRAW_INDIRECT_BUFFER
+#define GL_DRAW_INDIRECT_BUFFER						0x8F3F
+#endif
+#ifndef GL_PARAMETER_BUFFER_ARB
+#define GL_PARAMETER_BUFFER_ARB						0x80EE
+#endif
+#ifndef GL_COMMAND_BARRIER_BIT
+#define GL_COMMAND_BARRIER_BIT						0x00000040
+#endif
+#ifndef GL_BUFFER_UPDATE_BARRIER_BIT
+#define GL_BUFFER_UPDATE_BARRIER_BIT				0x00000200
+#endif
+#ifndef GL_SHADER_STORAGE_BARRIER_BIT
+#define GL_SHADER_STORAGE_BARRIER_BIT				0x00002000
+#endif
+
+typedef void (APIENTRYP CullDispatchCompute)(GLuint groupsX, GLuint groupsY, GLuint groupsZ);
+typedef void (APIENTRYP CullMemoryBarrier)(GLbitfield barriers);
+typedef void (APIENTRYP CullClearBufferData)(GLenum target, GLenum internalFormat, GLenum format, GLenum type, const void* data);
+typedef void (APIENTRYP CullClearBufferSubData)(GLenum target, GLenum internalFormat, GLintptr offset, GLsizeiptr size, GLenum format, GLenum type, const void* data);
+typedef void (APIENTRYP CullMultiDrawElementsIndirect)(GLenum mode, GLenum type, const void* indirect, GLsizei drawCount, GLsizei stride);
+typedef void (APIENTRYP CullMultiDrawElementsIndirectCount)(GLenum mode, GLenum type, const void* indirect, GLintptr drawCount, GLsizei maxDrawCount, GLsizei stride);
+
+static CullDispatchCompute					dispatchCompute = NULL;
+static CullMemoryBarrier					memoryBarrier = NULL;
+static CullClearBufferData					clearBufferData = NULL;
+static CullClearBufferSubData				clearBufferSubData = NULL;
+static CullMultiDrawElementsIndirect		multiDrawElementsIndirect = NULL;
+static CullMultiDrawElementsIndirectCount	multiDrawElementsIndirectCount = NULL;		// GL 4.6 or ARB_indirect_parameters
+
+// what the shader counts for each chunk of the shape table into each copy of the counters
+//---------------------------------
+struct CullCounts
+{
+	GLuint	drawCount;
+	GLuint	triangles;
+	GLuint	levelChanges;
+	GLuint	pad;
+};
+
+// bytes of an indirect indexed draw: count, instance count, first index, base vertex, base instance
+//---------------------------------
+static const int DRAW_COMMAND_SIZE = 5 * sizeof(GLuint);
+
+// most work groups a dispatch may have along x (GL_MAX_COMPUTE_WORK_GROUP_COUNT is at least this);
+// more shapes than that many groups hold go on in y
+//---------------------------------
+static const GLuint MAX_GROUPS_X = 65535;
+
+//-------------------------------------------------------------------
+//	loads the GL 4.3 entry points the culler uses; a loader may hand
+//	out entry points the context does not support, so init checks
+//	the version as well
+//
+//	@param:		load		the loader glad was loaded with
+//	@return:	true if every entry point the culler needs was found
+//-------------------------------------------------------------------
+bool loadGpuCullingFunctions(GLADloadproc load)
+{
+	dispatchCompute = (CullDispatchCompute)load("glDispatchCompute");
+	memoryBarrier = (CullMemoryBarrier)load("glMemoryBarrier");
+	clearBufferData = (CullClearBufferData)load("glClearBufferData");
+	clearBufferSubData = (CullClearBufferSubData)load("glClearBufferSubData");
+	multiDrawElementsIndirect = (CullMultiDrawElementsIndirect)load("glMultiDrawElementsIndirect");
+	multiDrawElementsIndirectCount = (CullMultiDrawElementsIndirectCount)load("glMultiDrawElementsIndirectCount");
+	if (multiDrawElementsIndirectCount == NULL)
+	{
+		multiDrawElementsIndirectCount = (CullMultiDrawElementsIndirectCount)load("glMultiDrawElementsIndirectCountARB");
+	}
+	return dispatchCompute != NULL && memoryBarrier != NULL && clearBufferData != NULL && clearBufferSubData != NULL
+		&& multiDrawElementsIndirect != NULL;
+}
+
+//-------------------------------------------------------------------
+//	@param:		name		an extension name
+//	@return:	true if the current context has it
+//-------------------------------------------------------------------
+static bool hasGLExtension(const char* name)
+{
+	GLint count = 0;
+	glGetIntegerv(GL_NUM_EXTENSIONS, &count);
+	for (GLint i = 0; i < count; i++)
+	{
+		const char* extension = (const char*)glGetStringi(GL_EXTENSIONS, i);
+		if (extension != NULL && strcmp(extension, name) == 0)
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+//-------------------------------------------------------------------
+//	@param:		code		source of a compute shader
+//	@return:	the linked program, 0 if it failed to build
+//-------------------------------------------------------------------
+static GLuint compileCompute(const char* code)
+{
+	int success;
+	char infoLog[512];
+
+	GLuint shader = glCreateShader(GL_COMPUTE_SHADER);
+	glShaderSource(shader, 1, &code, NULL);
+	glCompileShader(shader);
+	glGetShaderiv(shader, GL_COMPILE_STATUS, &success);
+	if (!success)
+	{
+		glGetShaderInfoLog(shader, 512, NULL, infoLog);
+		std::cout << "ERROR::SHADER::COMPUTE::COMPILATION_FAILED\n" << infoLog << std::endl;
+		glDeleteShader(shader);
+		return 0;
+	}
+
+	GLuint program = glCreateProgram();
+	glAttachShader(program, shader);
+	glLinkProgram(program);
+	glDeleteShader(shader);
+	glGetProgramiv(program, GL_LINK_STATUS, &success);
+	if (!success)
+	{
+		glGetProgramInfoLog(program, 512, NULL, infoLog);
+		std::cout << "ERROR::SHADER::PROGRAM::LINKING_FAILED\n" << infoLog << std::endl;
+		glDeleteProgram(program);
+		return 0;
+	}
+	return program;
+}
+
+//-------------------------------------------------------------------
+//	constructors
+//-------------------------------------------------------------------
+GpuCuller::GpuCuller()
+{
+	program = 0;
+	memset(uniforms, 0, sizeof(uniforms));
+	boundsBuffer = 0;
+	rangesBuffer = 0;
+	levelsBuffer = 0;
+	commandBuffer = 0;
+	counterBuffer = 0;
+	counterAlignment = 1;
+	counterStride = sizeof(CullCounts);
+	counterOffset = 0;
+	countFromBuffer = false;
+	slots = 0;
+	frameNumber = 0;
+	shapes = 0;
+	levels = 0;
+	chunkSize = 1;
+	chunks = 0;
+	memset(&lastStats, 0, sizeof(lastStats));
+}
+
+//-------------------------------------------------------------------
+//	builds the compute program and its buffers when the context is
+//	GL 4.3 or later; otherwise says so and stays disabled
+//
+//	@param:		frameSlots	frames in flight, each counting into its
+//							own copy of the counters
+//	@return:	true if the GPU path can be used
+//-------------------------------------------------------------------
+bool GpuCuller::init(int frameSlots)
+{
+	PROFILE_ZONE("GpuCuller::init");
+	GLint major = 0;
+	GLint minor = 0;
+	glGetIntegerv(GL_MAJOR_VERSION, &major);
+	glGetIntegerv(GL_MINOR_VERSION, &minor);
+	if (major * 10 + minor < 43 || dispatchCompute == NULL || clearBufferData == NULL || clearBufferSubData == NULL
+		|| multiDrawElementsIndirect == NULL)
+	{
+		std::cout << "GPU_CULLING::UNAVAILABLE GL " << major << "." << minor << ", culling on the CPU" << std::endl;
+		return false;
+	}
+
+	std::string code;
+	if (!Shader::readFile("shaders/cullShapes.cs.txt", &code))
+	{
+		std::cout << "ERROR::SHADER::FILE_NOT_SUCCESSFULLY_READ" << std::endl;
+		return false;
+	}
+	program = compileCompute(code.c_str());
+	if (program == 0)
+	{
+		return false;
+	}
+	const char* names[7] = { "shapeCount", "chunkShapes", "viewRect", "pixelsPerUnit", "minPixels", "levelCount", "hysteresis" };
+	for (int i = 0; i < 7; i++)
+	{
+		uniforms[i] = glGetUniformLocation(program, names[i]);
+	}
+
+	// the draw count can stay on the GPU when the multi-draw reads it from a buffer; without that,
+	// every shape's command is drawn and the ones past the visible draws are cleared to nothing
+	countFromBuffer = multiDrawElementsIndirectCount != NULL
+		&& (major * 10 + minor >= 46 || hasGLExtension("GL_ARB_indirect_parameters"));
+
+	GLint alignment = 1;
+	glGetIntegerv(GL_SHADER_STORAGE_BUFFER_OFFSET_ALIGNMENT, &alignment);
+	counterAlignment = std::max(alignment, 1);
+	slots = std::max(1, std::min(frameSlots, MAX_FRAMES_IN_FLIGHT));
+	for (int i = 0; i < MAX_FRAMES_IN_FLIGHT; i++)
+	{
+		countedFrame[i] = -1;
+	}
+
+	// the counters are sized once the shapes, and so the chunks, are known
+	glGenBuffers(1, &boundsBuffer);
+	glGenBuffers(1, &rangesBuffer);
+	glGenBuffers(1, &levelsBuffer);
+	glGenBuffers(1, &commandBuffer);
+	glGenBuffers(1, &counterBuffer);
+
+	std::cout << "GPU_CULLING::ENABLED GL " << major << "." << minor << ", draw count "
+		<< (countFromBuffer ? "read by the GPU" : "of every shape") << std::endl;
+	return true;
+}
+
+//-------------------------------------------------------------------
+//	deletes the program and buffers
+//-------------------------------------------------------------------
+void GpuCuller::release()
+{
+	if (program != 0)
+	{
+		GLuint buffers[5] = { boundsBuffer, rangesBuffer, levelsBuffer, commandBuffer, counterBuffer };
+		currentGLState()->deleteBuffers(5, buffers);
+		currentGLState()->useProgram(0);
+		glDeleteProgram(program);
+		program = 0;
+	}
+	shapes = 0;
+	levels = 0;
+	chunks = 0;
+}
+
+//-------------------------------------------------------------------
+//	@return:	true once init has built the compute program
+//-------------------------------------------------------------------
+bool GpuCuller::enabled() const
+{
+	return program != 0;
+}
+
+//-------------------------------------------------------------------
+//	uploads the shapes; each level already chosen is copied over to
+//	the new buffer, and new shapes start without one
+//
+//	@param:		bounds		the xy bounds of each shape
+//	@param:		ranges		levelCount index ranges per shape, shape
+//							by shape
+//	@param:		shapeCount	number of shapes
+//	@param:		levelCount	levels of subdivision of each shape, 1 for
+//							each to be drawn as it is
+//	@param:		chunkShapes	shapes in each chunk of the shape table
+//-------------------------------------------------------------------
+void GpuCuller::setShapes(const Bounds2D* bounds, const SubMesh* ranges, int shapeCount, int levelCount, int chunkShapes)
+{
+	PROFILE_ZONE("GpuCuller::setShapes");
+	if (program == 0 || shapeCount <= 0)
+	{
+		return;
+	}
+	GLStateCache* state = currentGLState();
+
+	state->bindBuffer(GL_SHADER_STORAGE_BUFFER, boundsBuffer);
+	glBufferData(GL_SHADER_STORAGE_BUFFER, (GLsizeiptr)shapeCount * sizeof(Bounds2D), bounds, GL_STATIC_DRAW);
+	state->bindBuffer(GL_SHADER_STORAGE_BUFFER, rangesBuffer);
+	glBufferData(GL_SHADER_STORAGE_BUFFER, (GLsizeiptr)shapeCount * levelCount * sizeof(SubMesh), ranges, GL_STATIC_DRAW);
+	state->bindBuffer(GL_DRAW_INDIRECT_BUFFER, commandBuffer);
+	glBufferData(GL_DRAW_INDIRECT_BUFFER, (GLsizeiptr)shapeCount * DRAW_COMMAND_SIZE, NULL, GL_DYNAMIC_DRAW);
+
+	// the levels chosen so far carry over while the levels themselves stay the same
+	std::vector<GLint> none(shapeCount, -1);
+	GLuint kept = levelsBuffer;
+	int keep = (levelCount == levels) ? std::min(shapes, shapeCount) : 0;
+	glGenBuffers(1, &levelsBuffer);
+	state->bindBuffer(GL_SHADER_STORAGE_BUFFER, levelsBuffer);
+	glBufferData(GL_SHADER_STORAGE_BUFFER, (GLsizeiptr)shapeCount * sizeof(GLint), &none[0], GL_DYNAMIC_DRAW);
+	if (keep > 0)
+	{
+		state->bindBuffer(GL_COPY_READ_BUFFER, kept);
+		state->bindBuffer(GL_COPY_WRITE_BUFFER, levelsBuffer);
+		glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, (GLsizeiptr)keep * sizeof(GLint));
+	}
+	state->deleteBuffers(1, &kept);
+
+	// a copy of every chunk's counts for each frame slot; counts of the old chunks are dropped with them
+	chunkSize = std::max(chunkShapes, 1);
+	int chunkCount = (shapeCount + chunkSize - 1) / chunkSize;
+	if (chunkCount != chunks)
+	{
+		counterStride = ((GLintptr)(chunkCount * sizeof(CullCounts)) + counterAlignment - 1) / counterAlignment * counterAlignment;
+		std::vector<unsigned char> zeros((size_t)(counterStride * slots), 0);
+		state->bindBuffer(GL_SHADER_STORAGE_BUFFER, counterBuffer);
+		glBufferData(GL_SHADER_STORAGE_BUFFER, counterStride * slots, &zeros[0], GL_DYNAMIC_READ);
+		readCounts.resize(chunkCount * 4);
+		for (int i = 0; i < MAX_FRAMES_IN_FLIGHT; i++)
+		{
+			countedFrame[i] = -1;
+		}
+		chunks = chunkCount;
+	}
+
+	shapes = shapeCount;
+	levels = levelCount;
+}
+
+//-------------------------------------------------------------------
+//	@return:	the number of shapes handed over
+//-------------------------------------------------------------------
+int GpuCuller::shapeCount() const
+{
+	return shapes;
+}
+
+//-------------------------------------------------------------------
+//	@return:	the number of shape table chunks the shapes fill, each
+//				drawn on its own
+//-------------------------------------------------------------------
+int GpuCuller::chunkCount() const
+{
+	return chunks;
+}
+
+//-------------------------------------------------------------------
+//	reads back what the frame slot counted last time round, which
+//	has finished on the GPU by the time the slot is given out again,
+//	then dispatches this frame's cull into it
+//
+//	@param:		frameSlot	the frame's slot from FramesInFlight
+//	@param:		view		what the shapes are culled against
+//	@param:		state		the context's state cache
+//-------------------------------------------------------------------
+void GpuCuller::cull(int frameSlot, const GpuCullView& view, GLStateCache* state)
+{
+	PROFILE_ZONE("GpuCuller::cull");
+	if (program == 0 || shapes == 0)
+	{
+		return;
+	}
+	frameNumber++;
+	int slot = frameSlot % slots;
+	counterOffset = slot * counterStride;
+
+	GLsizeiptr countsSize = (GLsizeiptr)(chunks * sizeof(CullCounts));
+	state->bindBuffer(GL_SHADER_STORAGE_BUFFER, counterBuffer);
+	if (countedFrame[slot] >= 0)
+	{
+		glGetBufferSubData(GL_SHADER_STORAGE_BUFFER, counterOffset, countsSize, &readCounts[0]);
+		memset(&lastStats, 0, sizeof(lastStats));
+		for (int c = 0; c < chunks; c++)
+		{
+			lastStats.visible += (int)readCounts[c * 4];
+			lastStats.triangles += (int)readCounts[c * 4 + 1];
+			lastStats.levelChanges += (int)readCounts[c * 4 + 2];
+		}
+		lastStats.framesBehind = frameNumber - countedFrame[slot];
+	}
+
+	// cleared by the GPU in order with the dispatch; writing them from the CPU could make the
+	// driver wait for, or copy, a buffer an earlier frame's draws may still be reading
+	clearBufferSubData(GL_SHADER_STORAGE_BUFFER, GL_R32UI, counterOffset, countsSize, GL_RED_INTEGER, GL_UNSIGNED_INT, NULL);
+	countedFrame[slot] = frameNumber;
+
+	if (!countFromBuffer)
+	{
+		state->bindBuffer(GL_DRAW_INDIRECT_BUFFER, commandBuffer);
+		clearBufferData(GL_DRAW_INDIRECT_BUFFER, GL_R32UI, GL_RED_INTEGER, GL_UNSIGNED_INT, NULL);
+	}
+
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, boundsBuffer);
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, rangesBuffer);
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 2, levelsBuffer);
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 3, commandBuffer);
+	glBindBufferRange(GL_SHADER_STORAGE_BUFFER, 4, counterBuffer, counterOffset, countsSize);
+
+	state->useProgram(program);
+	glUniform1ui(uniforms[0], (GLuint)shapes);
+	glUniform1ui(uniforms[1], (GLuint)chunkSize);
+	glUniform4fv(uniforms[2], 1, view.rect);
+	glUniform2fv(uniforms[3], 1, view.pixelsPerUnit);
+	glUniform1f(uniforms[4], view.minPixels);
+	glUniform1i(uniforms[5], levels);
+	glUniform1f(uniforms[6], view.hysteresis);
+
+	GLuint groups = (GLuint)((shapes + GPU_CULL_GROUP_SIZE - 1) / GPU_CULL_GROUP_SIZE);
+	GLuint groupsX = std::min(groups, MAX_GROUPS_X);
+	dispatchCompute(groupsX, (groups + groupsX - 1) / groupsX, 1);
+
+	// the draws read the commands and the count, the next read back reads the counts, and the
+	// next frame's dispatch reads the levels this one wrote
+	memoryBarrier(GL_COMMAND_BARRIER_BIT | GL_BUFFER_UPDATE_BARRIER_BIT | GL_SHADER_STORAGE_BARRIER_BIT);
+}
+
+//-------------------------------------------------------------------
+//	draws what the last cull appended for a chunk in one multi-draw
+//
+//	@param:		chunk		the chunk of the shape table that is bound
+//	@param:		indexType	type of the bound VAO's indices
+//	@param:		state		the context's state cache
+//-------------------------------------------------------------------
+void GpuCuller::draw(int chunk, GLenum indexType, GLStateCache* state)
+{
+	if (program == 0 || shapes == 0 || chunk < 0 || chunk >= chunks)
+	{
+		return;
+	}
+	int first = chunk * chunkSize;
+	GLsizei count = (GLsizei)std::min(shapes - first, chunkSize);
+	const void* commands = (const void*)((size_t)first * DRAW_COMMAND_SIZE);
+	state->bindBuffer(GL_DRAW_INDIRECT_BUFFER, commandBuffer);
+	if (countFromBuffer)
+	{
+		state->bindBuffer(GL_PARAMETER_BUFFER_ARB, counterBuffer);
+		multiDrawElementsIndirectCount(GL_TRIANGLES, indexType, commands, counterOffset + chunk * sizeof(CullCounts), count, 0);
+	}
+	else
+	{
+		multiDrawElementsIndirect(GL_TRIANGLES, indexType, commands, count, 0);
+	}
+}
+
+//-------------------------------------------------------------------
+//	@return:	the counts of the last frame read back
+//-------------------------------------------------------------------
+const GpuCullingStats& GpuCuller::stats() const
+{
+	return lastStats;
+}
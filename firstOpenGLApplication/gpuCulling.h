@@ -0,0 +1,111 @@
+//************************************************************************************************************************
+//
+//	LearnOpenGL - gpuCulling.h
+//
+//	Name:			Tucker Dane Walker
+//	Date:			August 2017
+//	Description:	Specifications for culling and draw submission on the GPU. A compute shader runs once per
+//					shape: it tests the shape's bounds against the view, picks its level of subdivision the way
+//					render does, and appends a draw for it to an indirect buffer. One multi-draw then draws
+//					whatever was appended, so the CPU records the same few calls whether the scene has a hundred
+//					shapes or millions. The counts the shader keeps are read back once the frame's fence has
+//					passed, a few frames late, so reading them never waits on the GPU, and are reset on the GPU.
+//
+//					draws are kept per chunk of the shape table, each chunk's from the command of its first
+//					shape on, so the multi-draws can bind one chunk of the table at a time
+//
+//					needs GL 4.3 (compute shaders, storage buffers, indirect multi-draws); glad only loads 3.3,
+//					so the entry points are loaded here, and a context without them keeps drawing on the CPU path
+//
+//***********************************************************************************************************************/
+
+#ifndef GPU_CULLING_H
+#define GPU_CULLING_H
+
+#include <glad/glad.h>
+#include <vector>
+#include "mesh.h"
+#include "framesInFlight.h"
+
+class GLStateCache;
+
+// shapes a compute work group culls
+//---------------------------------
+const int GPU_CULL_GROUP_SIZE = 64;
+
+// what a frame is culled against
+//---------------------------------
+struct GpuCullView
+{
+	float	rect[4];			// the view's min x, min y, max x and max y
+	float	pixelsPerUnit[2];	// along x and y, for the levels of subdivision
+	float	minPixels;			// a level is drawn while its triangles are this many pixels across
+	float	hysteresis;			// how far past a level a shape's size goes before it leaves it
+};
+
+// what the shader counted in the last frame read back
+//---------------------------------
+struct GpuCullingStats
+{
+	int		visible;			// draws appended: shapes in view
+	int		triangles;			// triangles those draws cover
+	int		levelChanges;		// shapes drawn at another level than before
+	int		framesBehind;		// frames since the one counted
+};
+
+class GpuCuller
+{
+public:
+	GpuCuller();
+
+	// GL thread: builds the compute program when the context can run it, with a copy of the counters for
+	// each of frameSlots frames in flight; enabled() stays false otherwise. release frees it all
+	//---------------------------------
+	bool init(int frameSlots);
+	void release();
+	bool enabled() const;
+
+	// GL thread: hands over every shape: its bounds and, for each of its levels in turn, its index range,
+	// and how many shapes a chunk of the shape table holds. Called again as shapes arrive; the levels
+	// already chosen are kept
+	//---------------------------------
+	void setShapes(const Bounds2D* bounds, const SubMesh* ranges, int shapeCount, int levelCount, int chunkShapes);
+	int shapeCount() const;
+	int chunkCount() const;
+
+	// GL thread: cull dispatches the shader into the frame slot's counters; draw then draws what it
+	// appended for one chunk with whatever program, VAO, polygon mode and shape table are bound
+	//---------------------------------
+	void cull(int frameSlot, const GpuCullView& view, GLStateCache* state);
+	void draw(int chunk, GLenum indexType, GLStateCache* state);
+
+	const GpuCullingStats& stats() const;
+
+private:
+	GLuint				program;			// the compute shader, 0 when disabled
+	GLint				uniforms[7];		// locations of the shader's uniforms, in the order it declares them
+	GLuint				boundsBuffer;		// vec4 per shape
+	GLuint				rangesBuffer;		// first index and index count of every level of each shape
+	GLuint				levelsBuffer;		// level each shape was last drawn at, -1 for none
+	GLuint				commandBuffer;		// an indirect draw per shape, the visible ones first
+	GLuint				counterBuffer;		// the shader's counts of each chunk, one copy per frame slot
+	GLintptr			counterAlignment;	// storage buffer offset alignment
+	GLintptr			counterStride;		// bytes between copies, a multiple of the alignment
+	GLintptr			counterOffset;		// copy the last cull counted into
+	bool				countFromBuffer;	// the multi-draw takes its draw count from the counts
+	int					slots;
+	int					countedFrame[MAX_FRAMES_IN_FLIGHT];	// frame each copy was last counted in, -1 when read back
+	int					frameNumber;
+	int					shapes;				// shapes handed over
+	int					levels;				// levels per shape
+	int					chunkSize;			// shapes per chunk of the shape table
+	int					chunks;				// chunks the shapes fill
+	std::vector<GLuint>	readCounts;			// the counts of a frame read back, 4 per chunk
+	GpuCullingStats		lastStats;
+};
+
+// LOADING
+//---------------------------------
+bool loadGpuCullingFunctions(GLADloadproc load);												// loads the GL 4.3 entry points, after glad
+
+#endif
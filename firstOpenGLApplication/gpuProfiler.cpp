@@ -0,0 +1,402 @@
+//************************************************************************************************************************
+//
+//	LearnOpenGL - gpuProfiler.cpp
+//
+//	Name:			Tucker Dane Walker
+//	Date:			August 2017
+//	Description:	Implementation for a GPU frame profiler built on timestamp queries.
+//
+//***********************************************************************************************************************/
+
+#include "gpuProfiler.h"
+#include "cpuProfiler.h"
+
+#include <string.h>
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+
+//-------------------------------------------------------------------
+//	constructor; no GL calls are made until init
+//-------------------------------------------------------------------
+GpuProfiler::GpuProfiler()
+{
+	current = 0;
+	ready = false;
+	gpuOffset = 0;
+	dropped = 0;
+	droppedScope = 0;
+	resolved = 0;
+	lastFrame = 0.0;
+	for (int i = 0; i < GPU_PROFILER_LATENCY; i++)
+	{
+		frames[i].issued = false;
+	}
+}
+
+//-------------------------------------------------------------------
+//	creates every frame's queries up front and lines the GPU clock
+//	up with the CPU clock so both can share one trace timeline
+//-------------------------------------------------------------------
+void GpuProfiler::init()
+{
+	for (int i = 0; i < GPU_PROFILER_LATENCY; i++)
+	{
+		growQueries(&frames[i]);
+		frames[i].scopes.reserve(GPU_PROFILER_INITIAL_SCOPES);
+		frames[i].issued = false;
+	}
+
+	GLint64 gpuTime = 0;
+	glGetInteger64v(GL_TIMESTAMP, &gpuTime);
+	gpuOffset = (int64_t)gpuTime - cpuNow();
+	ready = true;
+}
+
+//-------------------------------------------------------------------
+//	deletes the queries; results still in flight are lost
+//-------------------------------------------------------------------
+void GpuProfiler::release()
+{
+	if (!ready)
+	{
+		return;
+	}
+	for (int i = 0; i < GPU_PROFILER_LATENCY; i++)
+	{
+		glDeleteQueries((GLsizei)frames[i].queries.size(), &frames[i].queries[0]);
+		frames[i].queries.clear();
+		frames[i].issued = false;
+	}
+	ready = false;
+}
+
+//-------------------------------------------------------------------
+//	@return:	steady_clock time in ns, the timeline CPU zones use
+//-------------------------------------------------------------------
+int64_t GpuProfiler::cpuNow() const
+{
+	return (int64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+//-------------------------------------------------------------------
+//	reads back the oldest frame in the ring, then starts recording a
+//	new frame into its queries and opens the "frame" scope
+//-------------------------------------------------------------------
+void GpuProfiler::beginFrame()
+{
+	if (!ready)
+	{
+		return;
+	}
+
+	Frame& frame = frames[current];
+	if (frame.issued)
+	{
+		resolve(&frame);
+	}
+	frame.scopes.clear();
+	open.clear();
+
+	beginScope("frame");
+}
+
+//-------------------------------------------------------------------
+//	closes the "frame" scope (and any left open) and moves on to the
+//	next frame of the ring
+//-------------------------------------------------------------------
+void GpuProfiler::endFrame()
+{
+	if (!ready)
+	{
+		return;
+	}
+
+	while (!open.empty())
+	{
+		endScope();
+	}
+	frames[current].issued = true;
+	current = (current + 1) % GPU_PROFILER_LATENCY;
+}
+
+//-------------------------------------------------------------------
+//	@param:		name		name of the scope in the statistics and
+//							trace; must be a string literal
+//-------------------------------------------------------------------
+void GpuProfiler::beginScope(const char* name)
+{
+	Frame& frame = frames[current];
+	if (ready && 2 * frame.scopes.size() == frame.queries.size() && frame.scopes.size() < GPU_PROFILER_MAX_SCOPES)
+	{
+		growQueries(&frame);
+	}
+	if (!ready || 2 * frame.scopes.size() == frame.queries.size())
+	{
+		if (ready)
+		{
+			droppedScope++;
+		}
+		open.push_back(-1);			// keep begin/end pairs matched
+		return;
+	}
+
+	Scope scope;
+	scope.name = name;
+	scope.cpuBegin = cpuNow();
+	scope.cpuEnd = scope.cpuBegin;
+
+	int index = (int)frame.scopes.size();
+	glQueryCounter(frame.queries[2 * index], GL_TIMESTAMP);
+	frame.scopes.push_back(scope);
+	open.push_back(index);
+}
+
+//-------------------------------------------------------------------
+//	ends the most recently begun scope
+//-------------------------------------------------------------------
+void GpuProfiler::endScope()
+{
+	if (open.empty())
+	{
+		return;
+	}
+	int index = open.back();
+	open.pop_back();
+	if (index < 0)
+	{
+		return;
+	}
+
+	Frame& frame = frames[current];
+	glQueryCounter(frame.queries[2 * index + 1], GL_TIMESTAMP);
+	frame.scopes[index].cpuEnd = cpuNow();
+}
+
+//-------------------------------------------------------------------
+//	makes a frame's first queries, or doubles them; a frame that once
+//	opened more scopes keeps the queries for them
+//
+//	@param:		frame		a frame of the ring
+//-------------------------------------------------------------------
+void GpuProfiler::growQueries(Frame* frame)
+{
+	size_t count = frame->queries.size();
+	size_t grown = std::min(std::max(2 * count, (size_t)(2 * GPU_PROFILER_INITIAL_SCOPES)), (size_t)(2 * GPU_PROFILER_MAX_SCOPES));
+	frame->queries.resize(grown);
+	glGenQueries((GLsizei)(grown - count), &frame->queries[count]);
+}
+
+//-------------------------------------------------------------------
+//	reads a finished frame's timestamps into the history and trace;
+//	if the GPU has not got to the end of it yet the frame is dropped
+//	rather than waited for
+//
+//	@param:		frame		a frame issued GPU_PROFILER_LATENCY frames ago
+//-------------------------------------------------------------------
+void GpuProfiler::resolve(Frame* frame)
+{
+	PROFILE_ZONE("GpuProfiler::resolve");
+	frame->issued = false;
+	if (frame->scopes.empty())
+	{
+		return;
+	}
+
+	// the frame scope's end is the last query written; queries complete in order
+	GLint available = 0;
+	glGetQueryObjectiv(frame->queries[1], GL_QUERY_RESULT_AVAILABLE, &available);
+	if (!available)
+	{
+		dropped++;
+		return;
+	}
+
+	// per frame totals of each name, so repeated scopes add up
+	std::vector<std::pair<const char*, double> > totals;
+
+	for (size_t i = 0; i < frame->scopes.size(); i++)
+	{
+		const Scope& scope = frame->scopes[i];
+		GLuint64 gpuBegin = 0;
+		GLuint64 gpuEnd = 0;
+		glGetQueryObjectui64v(frame->queries[2 * i], GL_QUERY_RESULT, &gpuBegin);
+		glGetQueryObjectui64v(frame->queries[2 * i + 1], GL_QUERY_RESULT, &gpuEnd);
+
+		double ms = (double)(int64_t)(gpuEnd - gpuBegin) / 1.0e6;
+		size_t t = 0;
+		while (t < totals.size() && strcmp(totals[t].first, scope.name) != 0)
+		{
+			t++;
+		}
+		if (t == totals.size())
+		{
+			totals.push_back(std::make_pair(scope.name, 0.0));
+		}
+		totals[t].second += ms;
+
+		// trace events on the CPU timeline
+		TraceEvent cpuEvent;
+		cpuEvent.name = scope.name;
+		cpuEvent.gpu = false;
+		cpuEvent.begin = scope.cpuBegin;
+		cpuEvent.duration = scope.cpuEnd - scope.cpuBegin;
+
+		TraceEvent gpuEvent = cpuEvent;
+		gpuEvent.gpu = true;
+		gpuEvent.begin = (int64_t)gpuBegin - gpuOffset;
+		gpuEvent.duration = (int64_t)(gpuEnd - gpuBegin);
+
+		trace.push_back(cpuEvent);
+		trace.push_back(gpuEvent);
+	}
+	while (trace.size() > GPU_PROFILER_TRACE_EVENTS)
+	{
+		trace.pop_front();
+	}
+
+	for (size_t t = 0; t < totals.size(); t++)
+	{
+		addSample(totals[t].first, totals[t].second);
+	}
+	lastFrame = totals[0].second;		// the frame scope is always opened first
+	resolved++;
+}
+
+//-------------------------------------------------------------------
+//	@param:		name		scope name
+//	@param:		ms			GPU time of the scope in one frame
+//-------------------------------------------------------------------
+void GpuProfiler::addSample(const char* name, double ms)
+{
+	size_t h = 0;
+	while (h < history.size() && strcmp(history[h].name, name) != 0)
+	{
+		h++;
+	}
+	if (h == history.size())
+	{
+		History entry;
+		entry.name = name;
+		entry.samples.reserve(GPU_PROFILER_HISTORY);
+		entry.next = 0;
+		history.push_back(entry);
+	}
+
+	History& entry = history[h];
+	if ((int)entry.samples.size() < GPU_PROFILER_HISTORY)
+	{
+		entry.samples.push_back(ms);
+	}
+	else
+	{
+		entry.samples[entry.next] = ms;
+	}
+	entry.next = (entry.next + 1) % GPU_PROFILER_HISTORY;
+}
+
+//-------------------------------------------------------------------
+//	@param:		out			receives min/avg/p99 of every scope name
+//							over the last GPU_PROFILER_HISTORY frames
+//-------------------------------------------------------------------
+void GpuProfiler::summarize(std::vector<GpuScopeStats>* out) const
+{
+	out->clear();
+	std::vector<double> sorted;
+
+	for (size_t h = 0; h < history.size(); h++)
+	{
+		sorted = history[h].samples;
+		std::sort(sorted.begin(), sorted.end());
+
+		GpuScopeStats stats;
+		stats.name = history[h].name;
+		stats.samples = (int)sorted.size();
+		stats.minMs = sorted.front();
+		stats.avgMs = 0.0;
+		for (size_t i = 0; i < sorted.size(); i++)
+		{
+			stats.avgMs += sorted[i];
+		}
+		stats.avgMs /= (double)sorted.size();
+		stats.p99Ms = sorted[(sorted.size() * 99) / 100];
+		out->push_back(stats);
+	}
+}
+
+//-------------------------------------------------------------------
+//	writes the resolved scopes as Chrome trace events: thread 1 shows
+//	when the CPU issued each scope, thread 2 when the GPU ran it; the
+//	CPU profiler's zones follow on one thread each
+//
+//	@param:		path		the .json file to create
+//	@return:	true if the file was written
+//-------------------------------------------------------------------
+bool GpuProfiler::writeTrace(const char* path) const
+{
+	std::ofstream file(path, std::ios::out | std::ios::trunc);
+	if (!file)
+	{
+		std::cout << "ERROR::GPUPROFILER::COULD_NOT_CREATE " << path << std::endl;
+		return false;
+	}
+
+	file.setf(std::ios::fixed);
+	file.precision(3);
+	file << "{\"traceEvents\":[\n";
+	file << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"args\":{\"name\":\"firstOpenGLApplication\"}},\n";
+	file << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":1,\"args\":{\"name\":\"CPU submit\"}},\n";
+	file << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":2,\"args\":{\"name\":\"GPU\"}}";
+
+	for (size_t i = 0; i < trace.size(); i++)
+	{
+		const TraceEvent& event = trace[i];
+		file << ",\n{\"name\":\"" << event.name << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << (event.gpu ? 2 : 1)
+			<< ",\"ts\":" << event.begin / 1000.0 << ",\"dur\":" << event.duration / 1000.0 << "}";
+	}
+	writeCpuZoneEvents(file);
+	file << "\n]}\n";
+
+	if (!file)
+	{
+		std::cout << "ERROR::GPUPROFILER::WRITE_FAILED " << path << std::endl;
+		return false;
+	}
+	return true;
+}
+
+//-------------------------------------------------------------------
+//	@return:	frames dropped because their results were not ready
+//				GPU_PROFILER_LATENCY frames later
+//-------------------------------------------------------------------
+int GpuProfiler::droppedFrames() const
+{
+	return dropped;
+}
+
+//-------------------------------------------------------------------
+//	@return:	scopes not timed because their frame had already
+//				opened GPU_PROFILER_MAX_SCOPES
+//-------------------------------------------------------------------
+int GpuProfiler::droppedScopes() const
+{
+	return droppedScope;
+}
+
+//-------------------------------------------------------------------
+//	@return:	frames whose results have been read back so far; a
+//				change means lastFrameMs holds a new frame
+//-------------------------------------------------------------------
+int GpuProfiler::resolvedFrames() const
+{
+	return resolved;
+}
+
+//-------------------------------------------------------------------
+//	@return:	GPU time of the frame read back last, in ms; 0 until
+//				one has been
+//-------------------------------------------------------------------
+double GpuProfiler::lastFrameMs() const
+{
+	return lastFrame;
+}
@@ -0,0 +1,131 @@
+//************************************************************************************************************************
+//
+//	LearnOpenGL - gpuProfiler.h
+//
+//	Name:			Tucker Dane Walker
+//	Date:			August 2017
+//	Description:	Specifications for a GPU frame profiler. Each named scope writes a GL_TIMESTAMP query when it
+//					begins and ends, so scopes can nest. Queries are kept in a ring of frames and only read back
+//					GPU_PROFILER_LATENCY frames later, so the CPU never waits on the GPU for a result. Resolved
+//					times feed rolling min/avg/p99 statistics and a Chrome trace (chrome://tracing) that shows
+//					each scope on the GPU next to the CPU time spent issuing it and the CPU profiler's zones.
+//
+//***********************************************************************************************************************/
+
+#ifndef GPU_PROFILER_H
+#define GPU_PROFILER_H
+
+#include <glad/glad.h>
+#include <stdint.h>
+#include <chrono>
+#include <deque>
+#include <vector>
+
+// frames between issuing a frame's queries and reading them back
+//---------------------------------
+const int GPU_PROFILER_LATENCY = 4;
+
+// scopes per frame; a frame's queries are made for the first GPU_PROFILER_INITIAL_SCOPES, and
+// double when a frame opens more, up to GPU_PROFILER_MAX_SCOPES. Any past that are not timed
+//---------------------------------
+const int GPU_PROFILER_INITIAL_SCOPES = 64;
+const int GPU_PROFILER_MAX_SCOPES = 4096;
+
+// frames of history the statistics are computed over
+//---------------------------------
+const int GPU_PROFILER_HISTORY = 240;
+
+// events kept for the trace file; the oldest are dropped first
+//---------------------------------
+const size_t GPU_PROFILER_TRACE_EVENTS = 200000;
+
+// rolling GPU time of one scope name, summed over each frame it appears in
+//---------------------------------
+struct GpuScopeStats
+{
+	const char*	name;
+	int			samples;		// frames the statistics cover
+	double		minMs;
+	double		avgMs;
+	double		p99Ms;
+};
+
+class GpuProfiler
+{
+public:
+	GpuProfiler();
+
+	// create and delete the query objects; GL context must be current
+	//---------------------------------
+	void init();
+	void release();
+
+	// bracket each frame; beginFrame also reads back the frame issued GPU_PROFILER_LATENCY frames ago
+	//---------------------------------
+	void beginFrame();
+	void endFrame();
+
+	// bracket a named piece of GPU work; name must outlive the profiler (a string literal)
+	//---------------------------------
+	void beginScope(const char* name);
+	void endScope();
+
+	// results
+	//---------------------------------
+	void summarize(std::vector<GpuScopeStats>* out) const;
+	bool writeTrace(const char* path) const;
+	int droppedFrames() const;
+	int droppedScopes() const;
+	int resolvedFrames() const;
+	double lastFrameMs() const;
+
+private:
+	struct Scope
+	{
+		const char*		name;
+		int64_t			cpuBegin;		// steady_clock ns when the scope was opened
+		int64_t			cpuEnd;			// steady_clock ns when the scope was closed
+	};
+
+	struct Frame
+	{
+		std::vector<GLuint>		queries;	// begin and end timestamp query of each scope
+		std::vector<Scope>		scopes;		// scopes in the order they were opened
+		bool					issued;		// queries were written and not yet read back
+	};
+
+	struct TraceEvent
+	{
+		const char*		name;
+		bool			gpu;			// GPU execution rather than CPU submission
+		int64_t			begin;			// steady_clock ns
+		int64_t			duration;		// ns
+	};
+
+	struct History
+	{
+		const char*				name;
+		std::vector<double>		samples;	// ring of per frame times in ms
+		int						next;		// slot the next sample goes into
+	};
+
+	void growQueries(Frame* frame);
+	void resolve(Frame* frame);
+	void addSample(const char* name, double ms);
+	int64_t cpuNow() const;
+
+	Frame									frames[GPU_PROFILER_LATENCY];	// ring of frames waiting for results
+	int										current;		// frame being recorded
+	std::vector<int>						open;			// scopes of the current frame not yet ended
+	bool									ready;			// init has run
+
+	int64_t									gpuOffset;		// GPU timestamp minus CPU time, in ns
+	std::vector<History>					history;		// statistics, one per scope name
+	std::deque<TraceEvent>					trace;			// resolved events for writeTrace
+	int										dropped;		// frames whose results were not ready in time
+	int										droppedScope;	// scopes past GPU_PROFILER_MAX_SCOPES in a frame
+	int										resolved;		// frames read back
+	double									lastFrame;		// GPU time of the frame read back last, in ms
+};
+
+#endif
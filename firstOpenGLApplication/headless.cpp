@@ -0,0 +1,237 @@
+//************************************************************************************************************************
+//
+//	LearnOpenGL - headless.cpp
+//
+//	Name:			Tucker Dane Walker
+//	Date:			August 2017
+//	Description:	Implementation for a headless OpenGL context through EGL.
+//
+//***********************************************************************************************************************/
+
+#include "headless.h"
+#include "cpuProfiler.h"
+#include "glState.h"
+#include "gpuCulling.h"
+
+#include <glad/glad.h>
+#include <string.h>
+#include <iostream>
+
+#ifndef _WIN32
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#endif
+
+#ifdef _WIN32
+
+bool makeHeadlessContext(int width, int height, HeadlessContext* out)
+{
+	memset(out, 0, sizeof(*out));
+	std::cout << "ERROR::HEADLESS::NOT_SUPPORTED_ON_THIS_PLATFORM" << std::endl;
+	return false;
+}
+
+void destroyHeadlessContext(HeadlessContext* headless)
+{
+	memset(headless, 0, sizeof(*headless));
+}
+
+#else
+
+//-------------------------------------------------------------------
+//	@param:		display		an initialized display
+//	@param:		name		an EGL extension name
+//	@return:	true if the display supports the extension
+//-------------------------------------------------------------------
+static bool hasExtension(EGLDisplay display, const char* name)
+{
+	const char* extensions = eglQueryString(display, EGL_EXTENSIONS);
+	if (extensions == NULL)
+	{
+		return false;
+	}
+
+	size_t length = strlen(name);
+	for (const char* at = strstr(extensions, name); at != NULL; at = strstr(at + length, name))
+	{
+		// match whole names only
+		if ((at == extensions || at[-1] == ' ') && (at[length] == ' ' || at[length] == '\0'))
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+//-------------------------------------------------------------------
+//	prefers Mesa's surfaceless platform, which needs no display
+//	server or GPU; falls back to the default display
+//
+//	@return:	an uninitialized display, or EGL_NO_DISPLAY
+//-------------------------------------------------------------------
+static EGLDisplay getHeadlessDisplay()
+{
+	PFNEGLGETPLATFORMDISPLAYEXTPROC getPlatformDisplay =
+		(PFNEGLGETPLATFORMDISPLAYEXTPROC)eglGetProcAddress("eglGetPlatformDisplayEXT");
+
+	if (getPlatformDisplay != NULL)
+	{
+		EGLDisplay display = getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, NULL);
+		if (display != EGL_NO_DISPLAY)
+		{
+			return display;
+		}
+	}
+	return eglGetDisplay(EGL_DEFAULT_DISPLAY);
+}
+
+//-------------------------------------------------------------------
+//	creates an OpenGL 3.3 core context with no window, loads the GL
+//	function pointers through GLAD and binds a width x height
+//	framebuffer so that everything drawn afterwards lands in it
+//
+//	@param:		width		width of the framebuffer in pixels
+//	@param:		height		height of the framebuffer in pixels
+//	@param:		out			receives the context; cleared on failure
+//	@return:	true if the context is current and ready to draw
+//-------------------------------------------------------------------
+bool makeHeadlessContext(int width, int height, HeadlessContext* out)
+{
+	PROFILE_ZONE("makeHeadlessContext");
+	memset(out, 0, sizeof(*out));
+
+	// display
+	//---------------------------------
+	EGLDisplay display = getHeadlessDisplay();
+	EGLint major = 0;
+	EGLint minor = 0;
+	if (display == EGL_NO_DISPLAY || !eglInitialize(display, &major, &minor))
+	{
+		std::cout << "ERROR::HEADLESS::NO_EGL_DISPLAY" << std::endl;
+		return false;
+	}
+	out->display = display;
+
+	// context
+	//---------------------------------
+	const EGLint configAttribs[] = {
+		EGL_SURFACE_TYPE,		EGL_PBUFFER_BIT,
+		EGL_RENDERABLE_TYPE,	EGL_OPENGL_BIT,
+		EGL_RED_SIZE,			8,
+		EGL_GREEN_SIZE,			8,
+		EGL_BLUE_SIZE,			8,
+		EGL_NONE
+	};
+	EGLConfig config;
+	EGLint numConfigs = 0;
+	if (!eglBindAPI(EGL_OPENGL_API) || !eglChooseConfig(display, configAttribs, &config, 1, &numConfigs) || numConfigs < 1)
+	{
+		std::cout << "ERROR::HEADLESS::NO_OPENGL_CONFIG" << std::endl;
+		destroyHeadlessContext(out);
+		return false;
+	}
+
+	// GL 4.3 so --gpu-cull can run, or the 3.3 the renderer needs
+	EGLContext context = EGL_NO_CONTEXT;
+	const EGLint versions[2][2] = { { 4, 3 }, { 3, 3 } };
+	for (int i = 0; i < 2 && context == EGL_NO_CONTEXT; i++)
+	{
+		const EGLint contextAttribs[] = {
+			EGL_CONTEXT_MAJOR_VERSION,			versions[i][0],
+			EGL_CONTEXT_MINOR_VERSION,			versions[i][1],
+			EGL_CONTEXT_OPENGL_PROFILE_MASK,	EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+			EGL_NONE
+		};
+		context = eglCreateContext(display, config, EGL_NO_CONTEXT, contextAttribs);
+	}
+	if (context == EGL_NO_CONTEXT)
+	{
+		std::cout << "ERROR::HEADLESS::COULD_NOT_CREATE_CONTEXT 0x" << std::hex << eglGetError() << std::dec << std::endl;
+		destroyHeadlessContext(out);
+		return false;
+	}
+	out->context = context;
+
+	// without surfaceless support the context still needs something to be current on
+	EGLSurface surface = EGL_NO_SURFACE;
+	if (!hasExtension(display, "EGL_KHR_surfaceless_context"))
+	{
+		const EGLint pbufferAttribs[] = { EGL_WIDTH, 1, EGL_HEIGHT, 1, EGL_NONE };
+		surface = eglCreatePbufferSurface(display, config, pbufferAttribs);
+		out->surface = surface;
+	}
+	if (!eglMakeCurrent(display, surface, surface, context))
+	{
+		std::cout << "ERROR::HEADLESS::COULD_NOT_MAKE_CURRENT" << std::endl;
+		destroyHeadlessContext(out);
+		return false;
+	}
+
+	if (!gladLoadGLLoader((GLADloadproc)eglGetProcAddress))
+	{
+		std::cout << "Failed to initialize GLAD" << std::endl;
+		destroyHeadlessContext(out);
+		return false;
+	}
+	loadGpuCullingFunctions((GLADloadproc)eglGetProcAddress);
+
+	// framebuffer
+	//---------------------------------
+	glGenRenderbuffers(1, &out->colorBuffer);
+	glBindRenderbuffer(GL_RENDERBUFFER, out->colorBuffer);
+	glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, width, height);
+
+	glGenFramebuffers(1, &out->FBO);
+	glBindFramebuffer(GL_FRAMEBUFFER, out->FBO);
+	glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, out->colorBuffer);
+	if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+	{
+		std::cout << "ERROR::HEADLESS::FRAMEBUFFER_INCOMPLETE" << std::endl;
+		destroyHeadlessContext(out);
+		return false;
+	}
+
+	// a context that was never current on a surface starts with an empty viewport
+	currentGLState()->viewport(0, 0, width, height);
+	out->width = width;
+	out->height = height;
+
+	std::cout << "HEADLESS::EGL " << major << "." << minor << " " << glGetString(GL_RENDERER) << ", "
+		<< width << "x" << height << (surface == EGL_NO_SURFACE ? " surfaceless" : " pbuffer") << std::endl;
+	return true;
+}
+
+//-------------------------------------------------------------------
+//	@param:		headless	the context to tear down; cleared
+//-------------------------------------------------------------------
+void destroyHeadlessContext(HeadlessContext* headless)
+{
+	EGLDisplay display = (EGLDisplay)headless->display;
+
+	if (headless->context != NULL && eglGetCurrentContext() == (EGLContext)headless->context)
+	{
+		// GL names only exist once GLAD has loaded
+		if (headless->colorBuffer != 0)
+		{
+			glBindFramebuffer(GL_FRAMEBUFFER, 0);
+			glDeleteFramebuffers(1, &headless->FBO);
+			glDeleteRenderbuffers(1, &headless->colorBuffer);
+		}
+		eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+	}
+	if (headless->surface != NULL)
+	{
+		eglDestroySurface(display, (EGLSurface)headless->surface);
+	}
+	if (headless->context != NULL)
+	{
+		eglDestroyContext(display, (EGLContext)headless->context);
+	}
+	if (display != NULL)
+	{
+		eglTerminate(display);
+	}
+	memset(headless, 0, sizeof(*headless));
+}
+
+#endif
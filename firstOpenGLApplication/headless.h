@@ -0,0 +1,35 @@
+//************************************************************************************************************************
+//
+//	LearnOpenGL - headless.h
+//
+//	Name:			Tucker Dane Walker
+//	Date:			August 2017
+//	Description:	Specifications for a headless OpenGL context. An EGL context is created without a window
+//					(surfaceless, or a 1x1 pbuffer where that is unsupported) and everything is drawn into a
+//					framebuffer object of the requested size, so the renderer runs on machines with no display or
+//					GPU (Mesa llvmpipe).
+//
+//***********************************************************************************************************************/
+
+#ifndef HEADLESS_H
+#define HEADLESS_H
+
+// an offscreen context and the framebuffer it renders into
+//---------------------------------
+struct HeadlessContext
+{
+	void*			display;		// EGLDisplay
+	void*			context;		// EGLContext
+	void*			surface;		// EGLSurface; EGL_NO_SURFACE when the context is surfaceless
+	unsigned int	FBO;			// framebuffer every frame is drawn into
+	unsigned int	colorBuffer;	// RGBA8 renderbuffer attached to FBO
+	int				width;			// size of the framebuffer in pixels
+	int				height;
+};
+
+// CONTEXT
+//---------------------------------
+bool makeHeadlessContext(int width, int height, HeadlessContext* out);							// creates the context, loads GL and binds the FBO
+void destroyHeadlessContext(HeadlessContext* headless);											// deletes the FBO and the context
+
+#endif
@@ -8,17 +8,23 @@
 //
 //***********************************************************************************************************************/
 
-#define _CRTDBG_MAP_ALLOC
 #include<iostream>
+
+// the MSVC debug heap reports leaks on exit; other compilers build without it
+#ifdef _MSC_VER
+#define _CRTDBG_MAP_ALLOC
 #include <crtdbg.h>
 #ifdef _DEBUG
 #define DEBUG_NEW new(_NORMAL_BLOCK, __FILE__, __LINE__)
 #define new DEBUG_NEW
 #endif
+#endif
 
 #include "helloTriforce.h"
 #include "shader.h"
+#include "meshFile.h"
 #include <assert.h>
+#include <math.h>
 
 
 //-------------------------------------------------------------------
@@ -29,58 +35,621 @@
 const unsigned int	SCR_WIDTH = 800;
 const unsigned int	SCR_HEIGHT = 600;
 
-int main()
+// draw the Triforce from one deduplicated, cache-ordered index buffer
+// instead of one unindexed VAO per triangle
+const bool			USE_INDEXED_MESH = true;
+
+// levels of Sierpinski subdivision applied to each triangle of the
+// indexed Triforce (0 draws the plain Triforce)
+const int			TRIFORCE_DEPTH = 0;
+
+// deepest subdivision --depth accepts; each level triples the triangles
+const int			MAX_TRIFORCE_DEPTH = 12;
+
+// with --lod, a shape whose level would change is kept at its level
+// until its ideal level is this far past the edge of it, so a shape
+// on the boundary between two levels does not flicker between them
+const double		LOD_HYSTERESIS = 0.25;
+
+// time the render loop may spend each frame uploading loaded assets
+const double		UPLOAD_BUDGET_MS = 2.0;
+
+// shapes per scene partition; each partition is recorded into its own
+// command buffer by a worker thread
+const int			RECORD_PARTITION_SIZE = 4096;
+
+// the saturation animation advances in fixed steps of this length
+// while B is held; each shape pulses from full saturation at
+// SATURATION_RATE radians per second unless given its own animation
+const double		SIMULATION_STEP = 1.0 / 120.0;
+const double		SATURATION_RATE = 1.5;
+
+// the arrow keys pan the view by PAN_RATE of its width per second and
+// = and - zoom it in and out by ZOOM_RATE times per second, in the
+// same fixed steps as the animation
+const double		PAN_RATE = 0.5;
+const double		ZOOM_RATE = 2.0;
+const double		MIN_ZOOM = 1.0 / 256.0;
+const double		MAX_ZOOM = 64.0;
+
+// 1 waits for vertical sync before each swap, 0 swaps immediately
+const int			SWAP_INTERVAL = 1;
+
+// frames the CPU may submit before the GPU has finished the first of
+// them; 1 for the lowest latency, up to 3 for the most throughput
+const int			FRAMES_IN_FLIGHT = 2;
+
+// time each frame advances by while replaying recorded input, so a
+// replay steps the simulation identically on every run
+const double		REPLAY_FRAME_TIME = 1.0 / 60.0;
+
+// longest an idle on-demand window sleeps before checking for work
+// again; events wake it sooner
+const double		ON_DEMAND_WAIT = 0.5;
+
+//-------------------------------------------------------------------
+//	usage:	firstOpenGLApplication [--headless <frames>] [--size <width>x<height>] [--trace <file.json>]
+//									[--vsync <0|1>] [--fps <max>] [--frames-in-flight <1-3>] [--dynamic-resolution <GPU ms>]
+//									[--record <file.inl> | --replay <file.inl>]
+//									[--stats <file.csv>] [--varied-pulse] [--field <triforces>] [--depth <levels>] [--lod <pixels>]
+//									[--gpu-cull]
+//									[--on-demand] [--windows <count>]
+//									[--software <frames>] [--output <file.ppm>]
+//									[--capture <frames/%05d.png | file.rgba>] [--regress <golden dir> [--update]] [mesh.tfm]
+//
+//	when a mesh file written by meshConverter is given it is mapped
+//	and uploaded as-is instead of generating the Triforce
+//
+//	--headless renders the given number of frames into an offscreen
+//	framebuffer instead of a window, then exits (0 frames runs until
+//	a replay ends); --size sets the size
+//	of the window or framebuffer; --trace writes the GPU profile as
+//	a Chrome trace when rendering stops
+//
+//	--vsync sets the swap interval and --fps caps the frame rate;
+//	--frames-in-flight sets how far the CPU may run ahead of the GPU
+//
+//	--dynamic-resolution draws the scene offscreen at whatever scale
+//	keeps the GPU frame time within the budget, then stretches it over
+//	the window
+//
+//	--record writes every key change to a log; --replay plays a log
+//	back in place of the keyboard on a fixed timestep; --stats writes
+//	one line of statistics per frame for comparing runs
+//
+//	--varied-pulse gives every shape its own phase, frequency and
+//	amplitude, so the shapes pulse independently while B is held
+//
+//	--field lays out the given number of Triforces in a square field
+//	around the first; pan and zoom over it to see only the shapes in
+//	view drawn
+//
+//	--depth sets the levels of Sierpinski subdivision of the Triforce;
+//	with --lod every level up to it is built, and each shape is drawn
+//	at the finest level whose triangles are still the given number of
+//	pixels across, so small shapes are not drawn in sub-pixel detail
+//
+//	--gpu-cull moves culling, the choice of level and the draws onto
+//	the GPU: a compute shader fills an indirect buffer that one
+//	multi-draw submits. Needs GL 4.3; older contexts cull on the CPU
+//
+//	--on-demand only draws a window when input, the animation, a
+//	resize or streaming assets changed it, and sleeps otherwise
+//
+//	--windows opens several windows, each rendered by its own thread
+//	and context; shader programs and buffers are shared between them
+//
+//	--software renders the given number of frames on the CPU without
+//	any GL context, from the same replay as the GL path; --output
+//	saves the last frame of a software or headless run as a PPM image
+//
+//	--capture saves every frame rendered once assets have loaded,
+//	read back asynchronously and written on a background thread
+//
+//	--regress runs the regression scenes offscreen against the golden
+//	images in a directory; with --update it stores new goldens
+//-------------------------------------------------------------------
+int main(int argc, char* argv[])
 {
 	// tool for debugging
+#ifdef _MSC_VER
 	_CrtSetDbgFlag(_CRTDBG_ALLOC_MEM_DF | _CRTDBG_LEAK_CHECK_DF);
+#endif
+	PROFILE_THREAD("main");
 
-	// trashcan used for dynamic memory cleanup
+	// command line
+	//---------------------------------
+	const char* meshPath = NULL;
+	bool runHeadless = false;
+	int headlessFrames = 0;
+	bool runSoftware = false;
+	int width = SCR_WIDTH;
+	int height = SCR_HEIGHT;
+	const char* regressDir = NULL;
+	bool updateGoldens = false;
+	int windowCount = 1;
+	int depth = TRIFORCE_DEPTH;
+	RenderOptions options;
+	initRenderOptions(&options);
+
+	for (int i = 1; i < argc; i++)
+	{
+		if (strcmp(argv[i], "--headless") == 0 && i + 1 < argc)
+		{
+			runHeadless = true;
+			headlessFrames = atoi(argv[++i]);
+		}
+		else if (strcmp(argv[i], "--size") == 0 && i + 1 < argc)
+		{
+			if (sscanf(argv[++i], "%dx%d", &width, &height) != 2 || width <= 0 || height <= 0)
+			{
+				std::cout << "ERROR::ARGS::BAD_SIZE " << argv[i] << std::endl;
+				return 1;
+			}
+		}
+		else if (strcmp(argv[i], "--trace") == 0 && i + 1 < argc)
+		{
+			options.tracePath = argv[++i];
+		}
+		else if (strcmp(argv[i], "--vsync") == 0 && i + 1 < argc)
+		{
+			options.swapInterval = atoi(argv[++i]);
+		}
+		else if (strcmp(argv[i], "--fps") == 0 && i + 1 < argc)
+		{
+			options.maxFps = atof(argv[++i]);
+		}
+		else if (strcmp(argv[i], "--frames-in-flight") == 0 && i + 1 < argc)
+		{
+			options.framesInFlight = atoi(argv[++i]);
+			if (options.framesInFlight < 1 || options.framesInFlight > MAX_FRAMES_IN_FLIGHT)
+			{
+				std::cout << "ERROR::ARGS::BAD_FRAMES_IN_FLIGHT " << argv[i] << std::endl;
+				return 1;
+			}
+		}
+		else if (strcmp(argv[i], "--dynamic-resolution") == 0 && i + 1 < argc)
+		{
+			options.resolutionBudgetMs = atof(argv[++i]);
+			if (options.resolutionBudgetMs <= 0.0)
+			{
+				std::cout << "ERROR::ARGS::BAD_RESOLUTION_BUDGET " << argv[i] << std::endl;
+				return 1;
+			}
+		}
+		else if (strcmp(argv[i], "--record") == 0 && i + 1 < argc)
+		{
+			options.recordPath = argv[++i];
+		}
+		else if (strcmp(argv[i], "--replay") == 0 && i + 1 < argc)
+		{
+			options.replayPath = argv[++i];
+		}
+		else if (strcmp(argv[i], "--stats") == 0 && i + 1 < argc)
+		{
+			options.statsPath = argv[++i];
+		}
+		else if (strcmp(argv[i], "--varied-pulse") == 0)
+		{
+			options.variedPulse = true;
+		}
+		else if (strcmp(argv[i], "--field") == 0 && i + 1 < argc)
+		{
+			options.fieldCount = atoi(argv[++i]);
+			if (options.fieldCount < 1)
+			{
+				std::cout << "ERROR::ARGS::BAD_FIELD_COUNT " << argv[i] << std::endl;
+				return 1;
+			}
+		}
+		else if (strcmp(argv[i], "--depth") == 0 && i + 1 < argc)
+		{
+			depth = atoi(argv[++i]);
+			if (depth < 0 || depth > MAX_TRIFORCE_DEPTH)
+			{
+				std::cout << "ERROR::ARGS::BAD_DEPTH " << argv[i] << std::endl;
+				return 1;
+			}
+		}
+		else if (strcmp(argv[i], "--lod") == 0 && i + 1 < argc)
+		{
+			options.lodPixels = atof(argv[++i]);
+			if (options.lodPixels <= 0.0)
+			{
+				std::cout << "ERROR::ARGS::BAD_LOD_PIXELS " << argv[i] << std::endl;
+				return 1;
+			}
+		}
+		else if (strcmp(argv[i], "--gpu-cull") == 0)
+		{
+			options.gpuCull = true;
+		}
+		else if (strcmp(argv[i], "--on-demand") == 0)
+		{
+			options.onDemand = true;
+		}
+		else if (strcmp(argv[i], "--windows") == 0 && i + 1 < argc)
+		{
+			windowCount = atoi(argv[++i]);
+			if (windowCount < 1)
+			{
+				std::cout << "ERROR::ARGS::BAD_WINDOW_COUNT " << argv[i] << std::endl;
+				return 1;
+			}
+		}
+		else if (strcmp(argv[i], "--software") == 0 && i + 1 < argc)
+		{
+			runSoftware = true;
+			headlessFrames = atoi(argv[++i]);
+		}
+		else if (strcmp(argv[i], "--output") == 0 && i + 1 < argc)
+		{
+			options.imagePath = argv[++i];
+		}
+		else if (strcmp(argv[i], "--capture") == 0 && i + 1 < argc)
+		{
+			options.capturePath = argv[++i];
+		}
+		else if (strcmp(argv[i], "--regress") == 0 && i + 1 < argc)
+		{
+			regressDir = argv[++i];
+		}
+		else if (strcmp(argv[i], "--update") == 0)
+		{
+			updateGoldens = true;
+		}
+		else if (strncmp(argv[i], "--", 2) == 0)
+		{
+			std::cout << "ERROR::ARGS::BAD_OPTION " << argv[i] << std::endl;
+			std::cout << "usage: firstOpenGLApplication [--option value ...] [mesh.tfm]" << std::endl;
+			return 1;
+		}
+		else if (meshPath == NULL && isMeshFilePath(argv[i]))
+		{
+			meshPath = argv[i];
+		}
+		else
+		{
+			std::cout << "ERROR::ARGS::UNEXPECTED_ARGUMENT " << argv[i] << std::endl;
+			std::cout << "usage: firstOpenGLApplication [--option value ...] [mesh.tfm]" << std::endl;
+			return 1;
+		}
+	}
+
+	if ((runHeadless || runSoftware) && headlessFrames <= 0 && options.replayPath == NULL)
+	{
+		std::cout << "ERROR::ARGS::HEADLESS_NEEDS_FRAMES_OR_REPLAY" << std::endl;
+		return 1;
+	}
+
+	// the software renderer needs no window or GL context at all
+	//---------------------------------
+	if (runSoftware)
+	{
+		options.frameLimit = headlessFrames;
+		return renderSoftware(meshPath, depth, width, height, options) ? 0 : 1;
+	}
+
+	// make windows, or an offscreen context when running headless
+	//---------------------------------
+	std::vector<GLFWwindow*> windows;
+	HeadlessContext headless;
+	if (runHeadless || regressDir != NULL)
+	{
+		if (!makeHeadlessContext(width, height, &headless))
+		{
+			return 1;
+		}
+	}
+	else
+	{
+		initWindow();														// initialize GLFW Window
+		for (int i = 0; i < windowCount; i++)
+		{
+			// every window shares the first one's objects
+			windows.push_back(makeWindow(width, height, "LearnOPenGL", i > 0 ? windows[0] : NULL));	// create a window object
+		}
+		glfwMakeContextCurrent(windows[0]);									// the scene is loaded in the first window's context
+		initGLAD();															// initialize GLAD to manage function pointers for OpenGL
+	}
+
+	// the regression harness runs its own scenes in the offscreen context
+	//---------------------------------
+	if (regressDir != NULL)
+	{
+		bool passed = runRegression(regressDir, updateGoldens);
+		destroyHeadlessContext(&headless);
+		return passed ? 0 : 1;
+	}
+
+	// draw the scene
+	//---------------------------------
+	options.frameLimit = headlessFrames;
+	runScene(windows, meshPath, depth, options);
+
+	// garbage collection
 	//---------------------------------
-	DynArr * trashcan = NULL;
-	trashcan = new DynArr;
-	assert(trashcan != 0);
-	initDynArr(trashcan, 10);
+	if (!windows.empty())
+	{
+		glfwTerminate();
+	}
+	else
+	{
+		destroyHeadlessContext(&headless);
+	}
+
+	return 0;
+}
+
+//-------------------------------------------------------------------
+//	@param:		options		receives the defaults: run until the window
+//							closes, vsync on, nothing recorded or saved
+//-------------------------------------------------------------------
+void initRenderOptions(RenderOptions* options)
+{
+	options->frameLimit = 0;
+	options->tracePath = NULL;
+	options->swapInterval = SWAP_INTERVAL;
+	options->maxFps = 0.0;
+	options->framesInFlight = FRAMES_IN_FLIGHT;
+	options->resolutionBudgetMs = 0.0;
+	options->recordPath = NULL;
+	options->replayPath = NULL;
+	options->replayEvents = NULL;
+	options->statsPath = NULL;
+	options->onDemand = false;
+	options->variedPulse = false;
+	options->gpuCull = false;
+	options->fieldCount = 0;
+	options->lodPixels = 0.0;
+	options->imagePath = NULL;
+	options->capturePath = NULL;
+	options->report = NULL;
+	options->windowEvents = NULL;
+}
+
+//-------------------------------------------------------------------
+//	@return:	the animation every shape has unless given its own:
+//				full saturation at first, at SATURATION_RATE
+//-------------------------------------------------------------------
+ShapeAnimation defaultAnimation()
+{
+	ShapeAnimation animation;
+	animation.phase = (float)asin(1.0);
+	animation.frequency = (float)SATURATION_RATE;
+	animation.amplitude = 1.0f;
+	return animation;
+}
+
+//-------------------------------------------------------------------
+//	gives each shape its own animation around the default one; the
+//	same shape always gets the same animation
+//
+//	@param:		count		number of shapes
+//	@param:		out			receives an animation per shape: any phase,
+//							half to twice the default frequency and
+//							half to full amplitude
+//-------------------------------------------------------------------
+void variedAnimations(int count, std::vector<ShapeAnimation>* out)
+{
+	ShapeAnimation base = defaultAnimation();
+	out->resize(count);
+	for (int i = 0; i < count; i++)
+	{
+		// mix the shape's number into well spread bits (murmur3 finalizer)
+		uint32_t h = (uint32_t)i + 0x9E3779B9u;
+		h ^= h >> 16;
+		h *= 0x85EBCA6Bu;
+		h ^= h >> 13;
+		h *= 0xC2B2AE35u;
+		h ^= h >> 16;
+
+		ShapeAnimation& animation = (*out)[i];
+		animation.phase = base.phase + (float)((h & 0xFFFF) / 65536.0 * 4.0 * asin(1.0));
+		animation.frequency = base.frequency * (0.5f + 1.5f * ((h >> 16) & 0xFF) / 255.0f);
+		animation.amplitude = base.amplitude * (0.5f + 0.5f * (h >> 24) / 255.0f);
+	}
+}
+
+//-------------------------------------------------------------------
+//	builds the generated scene, the one Triforce or a field of them,
+//	and says what was built
+//
+//	@param:		fieldCount	Triforces in the field, 0 for just the one
+//	@param:		depth		levels of subdivision of each triangle
+//	@param:		levels		receives the index range of every level of
+//							each shape when it is not NULL; the mesh
+//							then holds levels 0 to depth of each
+//	@return:	the mesh
+//-------------------------------------------------------------------
+Mesh makeSceneMesh(int fieldCount, int depth, ShapeLevels* levels)
+{
+	Mesh triforce;
+	int unindexedVerts = 0;
+	if (levels != NULL)
+	{
+		triforce = makeTriforceLevels(std::max(fieldCount, 1), depth, levels, &unindexedVerts);
+		std::cout << "MESH::LEVELS " << std::max(fieldCount, 1) << " Triforces, depth 0 to " << depth << ": ";
+	}
+	else if (fieldCount > 0)
+	{
+		triforce = makeTriforceField(fieldCount, depth, &unindexedVerts);
+		std::cout << "MESH::FIELD " << fieldCount << " Triforces, depth " << depth << ": ";
+	}
+	else
+	{
+		triforce = makeTriforceMesh(depth, &unindexedVerts);
+		std::cout << "MESH::TRIFORCE depth " << depth << ": ";
+	}
+	std::cout << vertexCount(triforce) << " vertices (" << unindexedVerts << " unindexed), ACMR "
+		<< averageCacheMissRatio(triforce, VERTEX_CACHE_SIZE) << std::endl;
+	return triforce;
+}
 
-	// make window
+//-------------------------------------------------------------------
+//	loads the shaders and a mesh, renders them until options say to
+//	stop, then frees what the scene allocated; the GL context (the
+//	first window's, or offscreen) must already be current
+//
+//	@param:		windows		windows that are rendered to, all sharing the
+//							first one's objects; empty when headless
+//	@param:		meshPath	a .tfm file to draw, NULL for the Triforce
+//	@param:		depth		levels of subdivision of the Triforce
+//	@param:		options		how render runs
+//-------------------------------------------------------------------
+void runScene(const std::vector<GLFWwindow*>& windows, const char* meshPath, int depth, const RenderOptions& options)
+{
+	// trashcan used for dynamic memory cleanup
 	//---------------------------------
-	initWindow();															// initialize GLFW Window
-	GLFWwindow *window = makeWindow(SCR_WIDTH, SCR_HEIGHT, "LearnOPenGL"); 	// create a window object
-	initGLAD();																// initialize GLAD to manage function pointers for OpenGL
+	DynArr * trashcan = newDynArr(10);							// malloc'd, as deleteDynArr frees it
 
-	// make shader programs
+	// start loading assets; workers read and build them while the
+	// render loop uploads each one as soon as it is ready
 	//---------------------------------
-	
-	std::string filePath;			// holds filepath for fragment shader
-	Shader shaders[5];				// holds all of the shader programs
-	unsigned int * sProgIDs[5];		// holds the shader program IDs
+	AssetLoader loader(0);
+	BufferUploader uploader;		// every buffer upload goes through here
 
-	for (int i = 0; i < 5; i++)
+	// make the shader program; every shape is drawn with it, looking
+	// its color and the rest up in the shape table
+	//---------------------------------
+	Shader shader;
 	{
-		// put the filepath into a string
-		filePath = "shaders/fragmentShader";
-		filePath += (i+48);
-		filePath += ".fs.txt";
-		const char* fPath = filePath.c_str();
-		Shader sProg("shaders/vertexShader1.vs.txt", fPath);
-		shaders[i] = sProg;
-		sProgIDs[i] = &shaders[i].ID;
-		filePath.clear();
-	}	
+		Shader* program = &shader;
+		std::shared_ptr<std::string> vCode = std::make_shared<std::string>();
+		std::shared_ptr<std::string> fCode = std::make_shared<std::string>();
+
+		loader.add("shaders/fragmentShader.fs.txt",
+			[=]() { return Shader::readFile("shaders/vertexShader1.vs.txt", vCode.get()) && Shader::readFile("shaders/fragmentShader.fs.txt", fCode.get()); },
+			[=]() { return program->compile(vCode->c_str(), fCode->c_str()); });
+	}
 
 	// make VAO
 	//---------------------------------
-	unsigned int** VAOs = makeVAOs(trashcan, 3);
+	std::vector<DrawRange> shapes;			// one draw per shape (triangle of the Triforce); empty until uploaded
+	std::vector<Bounds2D> bounds;			// the xy bounds of each shape, for culling; set with shapes
+	std::vector<VertexLayout> layouts;		// buffers and format of each VAO, for contexts that share the buffers
 
-	// render loop
+	// every vertex carries its shape's number, built by the loader
+	//---------------------------------
+	std::shared_ptr<std::vector<unsigned int> > shapeIds = std::make_shared<std::vector<unsigned int> >();
+
+	// the loader works out the bounds while it builds the mesh; they are
+	// handed over with the draw ranges
+	//---------------------------------
+	std::shared_ptr<std::vector<Bounds2D> > shapeBoxes = std::make_shared<std::vector<Bounds2D> >();
+	int fieldCount = options.fieldCount;
+
+	// with LOD, the generated Triforces carry every level of subdivision
+	// and render picks one for each shape every frame
+	//---------------------------------
+	ShapeLevels levels;
+	levels.count = 0;
+	std::shared_ptr<ShapeLevels> builtLevels = std::make_shared<ShapeLevels>();
+	builtLevels->count = 0;
+	bool buildLevels = (options.lodPixels > 0.0 && depth > 0);
+
+	if (meshPath != NULL)
+	{
+		std::shared_ptr<MappedMesh> mapped = std::make_shared<MappedMesh>();
+		mapped->header = NULL;
+		loader.add(meshPath,
+			[=]() {
+				if (!mapMeshFile(meshPath, mapped.get()) || !touchMeshFile(*mapped))
+				{
+					return false;
+				}
+				// the position is the float attribute at location 0
+				const MeshFileHeader& header = *mapped->header;
+				for (uint32_t i = 0; i < header.attributeCount; i++)
+				{
+					const MeshFileAttribute& attrib = header.attributes[i];
+					if (attrib.location == 0 && attrib.type == MESH_ATTRIB_FLOAT && attrib.components >= 2)
+					{
+						shapeBounds((const float*)((const char*)mapped->vertices + attrib.offset), (int)header.vertexStride,
+							mapped->indices, (int)header.indexSize, mapped->shapes, (int)header.shapeCount, shapeBoxes.get());
+					}
+				}
+				shapeStream(mapped->indices, (int)header.indexSize, mapped->shapes, (int)header.shapeCount, 1,
+					(int)header.vertexCount, shapeIds.get());
+				return true;
+			},
+			[=, &shapes, &bounds, &layouts, &uploader]() {
+				shapes.resize(mapped->header->shapeCount);
+				makeMappedVAO(*mapped, &shapes[0], shapeIds->empty() ? NULL : &(*shapeIds)[0], &uploader, &layouts);
+				bounds.swap(*shapeBoxes);
+				unmapMeshFile(mapped.get());						// the GL buffers hold their own copy now
+				return true;
+			});
+	}
+	else if (USE_INDEXED_MESH)
+	{
+		std::shared_ptr<Mesh> triforce = std::make_shared<Mesh>();
+		loader.add("triforce",
+			[=]() {
+				*triforce = makeSceneMesh(fieldCount, depth, buildLevels ? builtLevels.get() : NULL);
+				shapeBounds(&triforce->vertices[0], FLOATS_PER_VERTEX * (int)sizeof(float), &triforce->indices[0], (int)sizeof(unsigned int),
+					&triforce->shapes[0], (int)triforce->shapes.size(), shapeBoxes.get());
+				if (builtLevels->count > 0)
+				{
+					// every level of a shape is the same shape
+					shapeStream(&triforce->indices[0], (int)sizeof(unsigned int), &builtLevels->ranges[0], (int)builtLevels->ranges.size(),
+						builtLevels->count, vertexCount(*triforce), shapeIds.get());
+				}
+				else
+				{
+					shapeStream(&triforce->indices[0], (int)sizeof(unsigned int), &triforce->shapes[0], (int)triforce->shapes.size(), 1,
+						vertexCount(*triforce), shapeIds.get());
+				}
+				return true;
+			},
+			[=, &shapes, &bounds, &levels, &layouts, &uploader]() {
+				shapes.resize(triforce->shapes.size());
+				makeIndexedVAO(*triforce, &shapes[0], &(*shapeIds)[0], &uploader, &layouts);
+				bounds.swap(*shapeBoxes);
+				levels.count = builtLevels->count;
+				levels.ranges.swap(builtLevels->ranges);
+				return true;
+			});
+	}
+	else
+	{
+		loader.add("triforce", AssetLoader::Step(), [=, &shapes, &bounds, &layouts, &uploader]() {
+			unsigned int VAOs[3];
+			makeVAOs(VAOs, 3, &uploader, &layouts);
+			const float* triangles[3] = { TRIANGLE_TOP, TRIANGLE_LEFT, TRIANGLE_RIGHT };
+			SubMesh triangle = { 0, 3 };
+			shapes.resize(3);
+			bounds.resize(3);
+			for (int i = 0; i < 3; i++)
+			{
+				shapes[i].VAO = VAOs[i];
+				shapes[i].first = 0;
+				shapes[i].count = 3;
+				shapes[i].indexType = 0;
+
+				std::vector<Bounds2D> box;
+				shapeBounds(triangles[i], FLOATS_PER_VERTEX * (int)sizeof(float), NULL, 0, &triangle, 1, &box);
+				bounds[i] = box[0];
+			}
+			return true;
+		});
+	}
+
+	// render loop, or one per window
 	//---------------------------------
-	render(window, sProgIDs, *VAOs, 3);
+	if (windows.size() > 1)
+	{
+		renderWindows(windows, &shader.ID, shapes, bounds, levels, layouts, &loader, &uploader, options);
+	}
+	else
+	{
+		render(windows.empty() ? NULL : windows[0], &shader.ID, &shapes, bounds, levels, &loader, &uploader, options);
+	}
 
 	// garbage collection
 	//---------------------------------
 	emptyTrashCan(trashcan);
-	glfwTerminate();
-
-	return 0;
+	uploader.release();
 }
 
 //-------------------------------------------------------------------
@@ -88,20 +657,24 @@ int main()
 //-------------------------------------------------------------------
 void initGLAD()
 {
+	PROFILE_ZONE("initGLAD");
 	if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress))
 	{
 		std::cout << "Failed to initialize GLAD" << std::endl;
 		assert(0);
 	}
+	loadGpuCullingFunctions((GLADloadproc)glfwGetProcAddress);
 }
 
 //-------------------------------------------------------------------
-// Initialize GLFW Window
+// Initialize GLFW Window; GL 4.3 is asked for so --gpu-cull can run,
+// and makeWindow settles for 3.3 where it is not there
 //-------------------------------------------------------------------
 void initWindow()
 {
+	PROFILE_ZONE("initWindow");
 	glfwInit();
-	glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
 	glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
 	glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
 	//glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
@@ -113,13 +686,23 @@ void initWindow()
 //	@param:		width		width of the window in pixels
 //	@param:		height		height of the window in pixels
 //	@param:		name		name of the window as a string of chars
+//	@param:		share		window whose context shares its objects
+//							with the new one, NULL for none
 //	@return:	win			returns a window of size (width)*(height)
 //							pixels named (name)
 //-------------------------------------------------------------------
-GLFWwindow* makeWindow(int width, int height, char* name)
+GLFWwindow* makeWindow(int width, int height, const char* name, GLFWwindow* share)
 {
+	PROFILE_ZONE("makeWindow");
 	// create the window
-	GLFWwindow* win = glfwCreateWindow(width, height, name, NULL, NULL);
+	GLFWwindow* win = glfwCreateWindow(width, height, name, NULL, share);
+	if (win == NULL)
+	{
+		// the renderer only needs 3.3
+		glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+		glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+		win = glfwCreateWindow(width, height, name, NULL, share);
+	}
 
 	// ensure that the window was created
 	if (win == NULL)
@@ -130,6 +713,7 @@ GLFWwindow* makeWindow(int width, int height, char* name)
 	}
 	glfwMakeContextCurrent(win); // ensures that win is the current context for glfw
 	glfwSetFramebufferSizeCallback(win, framebuffer_size_callback);	// handles window resizing
+	glfwSetWindowRefreshCallback(win, window_refresh_callback);		// handles the window being uncovered
 
 	return win;
 }
@@ -143,384 +727,1990 @@ GLFWwindow* makeWindow(int width, int height, char* name)
 //-------------------------------------------------------------------
 void framebuffer_size_callback(GLFWwindow* window, int width, int height)
 {
-	glViewport(0, 0, width, height);
+	// while rendering, the render thread sets the viewport in its own context
+	WindowEvents* events = (WindowEvents*)glfwGetWindowUserPointer(window);
+	if (events == NULL)
+	{
+		currentGLState()->viewport(0, 0, width, height);
+		return;
+	}
+
+	std::lock_guard<std::mutex> lock(events->lock);
+	events->width = width;
+	events->height = height;
+	events->resized = true;
+	events->redraw = true;
 }
 
 //-------------------------------------------------------------------
-// vertex data :: buffer(s) :: vertex attributes
+//	Handles the window contents being damaged (uncovered, restored)
+//	by asking render for a new frame
 //
-//	@param:		trash		the global trashcan for garbage collection
-//	@param:		numVAOs		the number of VAOs being passed
-//	@return:	VAOs		returns the address to the VAOs array
-//							which contains reference IDs to VAOs
+//	@param:	window			window that is rendered to; its user
+//							pointer is render's WindowEvents, or NULL
 //-------------------------------------------------------------------
-unsigned int ** makeVAOs(DynArr* trash, int numVAOs)
+void window_refresh_callback(GLFWwindow* window)
 {
-	// vertex data
-	//---------------------------------
-
-	// first triangle (Top)
-	float triangle1[] = {
-		// positions			// colors
-		 0.0f,	0.5f, 0.0f,		1.0f, 0.0f, 0.0f,
-		-0.25f,	0.0f, 0.0f,		0.0f, 1.0f, 0.0f,
-		 0.25f,	0.0f, 0.0f,		0.0f, 0.0f, 1.0f
-	};
-
-	//	second triangle (Left)
-	float triangle2[] = {
-		// positions			// colors
-		-0.25f,	 0.00f,	0.00f,	1.0f,	0.0f, 0.0f,
-		-0.50f,	-0.50f,	0.00f,	0.0f,	1.0f, 0.0f,
-		 0.00f, -0.50f,	0.00f,	0.0f,	0.0f, 1.0f
-	};
-
-	//	third triangle (Right)
-	float triangle3[] = {
-		// positions			// colors
-		0.25f,	 0.00f,	0.00f,	1.0f,	0.0f, 0.0f,
-		0.00f,	-0.50f,	0.00f,	0.0f,	1.0f, 0.0f,
-		0.50f,  -0.50f,	0.00f,	0.0f,	0.0f, 1.0f
-	};
+	WindowEvents* events = (WindowEvents*)glfwGetWindowUserPointer(window);
+	if (events != NULL)
+	{
+		std::lock_guard<std::mutex> lock(events->lock);
+		events->redraw = true;
+	}
+}
 
+//-------------------------------------------------------------------
+// vertex data :: buffer(s) :: vertex attributes
+//
+//	@param:		VAOs		receives the reference IDs of the VAOs
+//	@param:		numVAOs		the number of VAOs being passed, at most 3
+//	@param:		uploader	the upload layer the vertices are sent through
+//	@param:		layouts		receives the layout of each VAO
+//-------------------------------------------------------------------
+void makeVAOs(unsigned int* VAOs, int numVAOs, BufferUploader* uploader, std::vector<VertexLayout>* layouts)
+{
+	PROFILE_ZONE("makeVAOs");
 	//	all triangles
-	float * triangles[] = {
-		triangle1,
-		triangle2,
-		triangle3
+	const float * triangles[] = {
+		TRIANGLE_TOP,
+		TRIANGLE_LEFT,
+		TRIANGLE_RIGHT
 	};
 
 	// buffers
 	//---------------------------------
-	unsigned int * VAOs = NULL;
-	VAOs = new unsigned int[3];
-
-	addDynArr(trash, VAOs);
-
 	unsigned int VBOs[3];
+	unsigned int shapeBuffers[3];
 
-	//	generate vertex arrays and buffers
+	//	generate buffers
 	//---------------------------------
-	glGenVertexArrays(numVAOs, VAOs);
 	glGenBuffers(numVAOs, VBOs);
+	glGenBuffers(numVAOs, shapeBuffers);
 
-	//	set attribute pointers of VAOs
+	//	make a VAO over each buffer
 	//---------------------------------
 	for (int i = 0; i < numVAOs; i++)
 	{
-		// bind vertex array object
-		glBindVertexArray(VAOs[i]);
+		// copy vertices into a buffer for OpenGL to use; each triangle
+		// is exactly 3 vertices of FLOATS_PER_VERTEX floats
+		uploader->uploadArray(VBOs[i], triangles[i], 3 * FLOATS_PER_VERTEX, GL_STATIC_DRAW);
 
-		// copy vertices into a buffer for OpenGL to use
-		glBindBuffer(GL_ARRAY_BUFFER, VBOs[i]);
-		glBufferData(GL_ARRAY_BUFFER, sizeof(triangles) * 6, triangles[i], GL_STATIC_DRAW);
+		// every vertex of triangle i is shape i
+		const unsigned int shapeIds[3] = { (unsigned int)i, (unsigned int)i, (unsigned int)i };
+		uploader->uploadArray(shapeBuffers[i], shapeIds, 3, GL_STATIC_DRAW);
 
 		// set the vertex attributes pointers
+		VertexLayout layout = positionColorLayout(VBOs[i], 0);
+		layout.shapeBuffer = shapeBuffers[i];
+		VAOs[i] = makeVertexArray(layout);
+		layout.VAO = VAOs[i];
+		layouts->push_back(layout);
+	}
+}
 
-		// position attribute
-		glEnableVertexAttribArray(0);
-		glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(float), (void*)0);
+//-------------------------------------------------------------------
+//	@param:		VBO			buffer of interleaved vertices
+//	@param:		EBO			buffer of indices, 0 for none
+//	@return:	the layout of the project's vertices, a position then
+//				a color, in those buffers
+//-------------------------------------------------------------------
+VertexLayout positionColorLayout(unsigned int VBO, unsigned int EBO)
+{
+	VertexLayout layout;
+	layout.VAO = 0;
+	layout.vertexBuffer = VBO;
+	layout.elementBuffer = EBO;
+	layout.shapeBuffer = 0;
+	layout.stride = FLOATS_PER_VERTEX * sizeof(float);
+	layout.attributeCount = 2;
 
-		// color attribute
-		glEnableVertexAttribArray(1);
-		glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(float), (void*)(3 * sizeof(float)));
+	// position attribute
+	layout.attributes[0].location = 0;
+	layout.attributes[0].components = 3;
+	layout.attributes[0].type = GL_FLOAT;
+	layout.attributes[0].offset = 0;
 
-	}
+	// color attribute
+	layout.attributes[1].location = 1;
+	layout.attributes[1].components = 3;
+	layout.attributes[1].type = GL_FLOAT;
+	layout.attributes[1].offset = 3 * sizeof(float);
 
-	// return address to the VAOs array
-	return &VAOs;
+	return layout;
 }
 
 //-------------------------------------------------------------------
-//	processes when keys are pressed/released and responds
+//	builds a VAO in the current context over a layout's buffers
 //
-//	@param: window		window that is rendered to
-//	@param: fPtr		pointer to an integer that switches which
-//						frag shader is used inside of the render loop
-//							0 == Blue
-//							1 == Yellow
-//							2 == Red
-//							3 == White
-//	@param:	tPtr		pointer to an integer that switches which 
-//						triangle is being transformed inside of the
-//						render loop
-//							W == Top triangle (triangle 1)
-//							A == Left Triangle (triangle 2)
-//							D == Right Triangle (triangle 3)
-//	@param:	bPtr		pointer to a int which determines if
-//						blink is on/off
-//							0 == off
-//							1 == on
+//	@param:		layout		the buffers and vertex format
+//	@return:	the new VAO, left unbound
 //-------------------------------------------------------------------
-void processInput(GLFWwindow *window, int * fPtr, int * tPtr, int * bPtr)
+unsigned int makeVertexArray(const VertexLayout& layout)
 {
-	// if the user presses ESCAPE, close the window and exit rendering
-	if (glfwGetKey(window, GLFW_KEY_ESCAPE) == GLFW_PRESS)
+	GLStateCache* state = currentGLState();
+	unsigned int VAO;
+	glGenVertexArrays(1, &VAO);
+
+	state->bindVertexArray(VAO);
+	state->bindBuffer(GL_ARRAY_BUFFER, layout.vertexBuffer);
+	if (layout.elementBuffer != 0)
 	{
-		glfwSetWindowShouldClose(window, true);
+		state->bindBuffer(GL_ELEMENT_ARRAY_BUFFER, layout.elementBuffer);
 	}
 
-	// change between shaders
-	//---------------------------------
-
-	// if the user presses '1', switch to the Blue Shader
-	if (glfwGetKey(window, GLFW_KEY_1) == GLFW_PRESS)
+	for (int i = 0; i < layout.attributeCount; i++)
 	{
-		*fPtr = 0;
+		const VertexAttribute& attrib = layout.attributes[i];
+		glEnableVertexAttribArray(attrib.location);
+		glVertexAttribPointer(attrib.location, attrib.components, attrib.type, GL_FALSE, layout.stride, (void*)(size_t)attrib.offset);
 	}
-	// else if the user presses '2', switch to the Yellow Shader
-	else if (glfwGetKey(window, GLFW_KEY_2) == GLFW_PRESS)
+
+	// shape numbers come tightly packed from a buffer of their own, read as integers
+	if (layout.shapeBuffer != 0)
+	{
+		state->bindBuffer(GL_ARRAY_BUFFER, layout.shapeBuffer);
+		glEnableVertexAttribArray(SHAPE_ATTRIBUTE);
+		glVertexAttribIPointer(SHAPE_ATTRIBUTE, 1, GL_UNSIGNED_INT, 0, (void*)0);
+	}
+
+	// the element buffer binding is stored in the VAO, so unbind the VAO first
+	state->bindVertexArray(0);
+	return VAO;
+}
+
+//-------------------------------------------------------------------
+//	builds VAOs in the current context for shapes whose VAOs were
+//	made by another context sharing their buffers
+//
+//	@param:		layouts		the layout of every VAO the shapes use
+//	@param:		shapes		draw ranges whose VAOs are replaced by
+//							the current context's
+//	@param:		made		receives the VAOs built, to delete later
+//-------------------------------------------------------------------
+void shareVertexArrays(const std::vector<VertexLayout>& layouts, std::vector<DrawRange>* shapes, std::vector<unsigned int>* made)
+{
+	PROFILE_ZONE("shareVertexArrays");
+	made->resize(layouts.size());
+	for (size_t i = 0; i < layouts.size(); i++)
+	{
+		(*made)[i] = makeVertexArray(layouts[i]);
+	}
+
+	// a scene has a handful of VAOs, so each shape looks its own up directly
+	for (size_t s = 0; s < shapes->size(); s++)
+	{
+		DrawRange& shape = (*shapes)[s];
+		for (size_t i = 0; i < layouts.size(); i++)
+		{
+			if (layouts[i].VAO == shape.VAO)
+			{
+				shape.VAO = (*made)[i];
+				break;
+			}
+		}
+	}
+}
+
+//-------------------------------------------------------------------
+//	uploads an indexed mesh into a single VAO with a vertex buffer and
+//	a 16 or 32 bit element buffer
+//
+//	@param:		mesh		the mesh to upload
+//	@param:		shapes		receives one draw range per shape of the
+//							mesh, all referencing the same VAO
+//	@param:		shapeIds	the shapeStream of the mesh, NULL for every
+//							vertex to be shape 0
+//	@param:		uploader	the upload layer the buffers are sent through
+//	@param:		layouts		receives the layout of the VAO
+//-------------------------------------------------------------------
+void makeIndexedVAO(const Mesh& mesh, DrawRange* shapes, const unsigned int* shapeIds, BufferUploader* uploader, std::vector<VertexLayout>* layouts)
+{
+	PROFILE_ZONE("makeIndexedVAO");
+	unsigned int VBO, EBO;
+	std::vector<unsigned char> indices;
+	packIndices(mesh, &indices);
+
+	int indexBytes = indexSize(mesh);
+	unsigned int indexType = (indexBytes == 2) ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT;
+
+	glGenBuffers(1, &VBO);
+	glGenBuffers(1, &EBO);
+
+	// copy vertices and indices into buffers for OpenGL to use
+	uploader->uploadArray(VBO, &mesh.vertices[0], mesh.vertices.size(), GL_STATIC_DRAW);
+	uploader->uploadArray(EBO, &indices[0], indices.size(), GL_STATIC_DRAW);
+
+	VertexLayout layout = positionColorLayout(VBO, EBO);
+	if (shapeIds != NULL)
+	{
+		glGenBuffers(1, &layout.shapeBuffer);
+		uploader->uploadArray(layout.shapeBuffer, shapeIds, (size_t)vertexCount(mesh), GL_STATIC_DRAW);
+	}
+	layout.VAO = makeVertexArray(layout);
+	layouts->push_back(layout);
+
+	for (size_t i = 0; i < mesh.shapes.size(); i++)
+	{
+		shapes[i].VAO = layout.VAO;
+		shapes[i].first = (int)mesh.shapes[i].firstIndex * indexBytes;
+		shapes[i].count = (int)mesh.shapes[i].indexCount;
+		shapes[i].indexType = indexType;
+	}
+}
+
+//-------------------------------------------------------------------
+//	handles a key press/release from GLFW by queueing it; runs inside
+//	glfwPollEvents on the main thread
+//
+//	@param:		window		window that received the key; its user
+//							pointer is render's WindowEvents
+//	@param:		key			GLFW key code
+//	@param:		scancode	unused
+//	@param:		action		GLFW_PRESS, GLFW_RELEASE or GLFW_REPEAT
+//	@param:		mods		unused
+//-------------------------------------------------------------------
+void key_callback(GLFWwindow* window, int key, int /*scancode*/, int action, int /*mods*/)
+{
+	WindowEvents* events = (WindowEvents*)glfwGetWindowUserPointer(window);
+	if (events != NULL && action != GLFW_REPEAT)
+	{
+		std::lock_guard<std::mutex> lock(events->lock);
+		if (events->keys.events().empty())
+		{
+			events->keyTime = std::chrono::steady_clock::now();
+		}
+		events->keys.keyEvent(key, action == GLFW_PRESS);
+	}
+}
+
+//-------------------------------------------------------------------
+//	responds to each key press/release since the last frame; every
+//	change of state happens once, on the edge that caused it
+//
+//	@param: window		window that is rendered to; NULL when headless
+//	@param:	input		the key edges to handle (from the window or a replay)
+//	@param: fPtr		pointer to an integer that switches which
+//						frag shader is used inside of the render loop
+//							0 == Blue
+//							1 == Yellow
+//							2 == Red
+//							3 == White
+//	@param:	tPtr		pointer to an integer that switches which 
+//						triangle is being transformed inside of the
+//						render loop
+//							W == Top triangle (triangle 1)
+//							A == Left Triangle (triangle 2)
+//							D == Right Triangle (triangle 3)
+//	@param:	bPtr		pointer to a int which determines if
+//						blink is on/off
+//							0 == off
+//							1 == on
+//	@param:	pPtr		pointer to the polygon mode the render
+//						queue draws with
+//							GL_LINE == Polygon (wireframe)
+//							GL_FILL == Fill (solid)
+//	@param:	colors		the color of each triangle; a new color is
+//						given to the triangle selected by tPtr
+//-------------------------------------------------------------------
+void processInput(GLFWwindow *window, const InputQueue& input, int * fPtr, int * tPtr, int * bPtr, GLenum * pPtr, std::vector<int>* colors)
+{
+	PROFILE_ZONE("processInput");
+	const std::vector<KeyEvent>& events = input.events();
+
+	for (size_t i = 0; i < events.size(); i++)
+	{
+		int key = events[i].key;
+
+		// releasing 'B' turns blink off; no other key acts on release
+		if (!events[i].pressed)
+		{
+			if (key == GLFW_KEY_B)
+			{
+				*bPtr = 0;
+			}
+			continue;
+		}
+
+		// if the user presses ESCAPE, close the window and exit rendering
+		if (key == GLFW_KEY_ESCAPE)
+		{
+			if (window != NULL)
+			{
+				glfwSetWindowShouldClose(window, true);
+			}
+		}
+
+		// change between shaders: '1' Blue, '2' Yellow, '3' Red, '4' Interpolated
+		//---------------------------------
+		else if (key >= GLFW_KEY_1 && key <= GLFW_KEY_4)
+		{
+			*fPtr = key - GLFW_KEY_1;
+			(*colors)[*tPtr] = *fPtr;			// change the color of the current triangle
+		}
+
+		// change between triangles: 'W' Top, 'A' Left, 'D' Right
+		//---------------------------------
+		else if (key == GLFW_KEY_W || key == GLFW_KEY_A || key == GLFW_KEY_D)
+		{
+			*tPtr = (key == GLFW_KEY_W) ? 0 : (key == GLFW_KEY_A) ? 1 : 2;
+			*fPtr = (*colors)[*tPtr];			// the current color follows the triangle
+		}
+
+		// change between polygon and fill
+		//---------------------------------
+
+		// if the user presses 'P', switch to Polygon (wireframe) Mode
+		else if (key == GLFW_KEY_P)
+		{
+			*pPtr = GL_LINE;
+		}
+		// else if the user presses 'F', switch to Fill (solid) mode
+		else if (key == GLFW_KEY_F)
+		{
+			*pPtr = GL_FILL;
+		}
+
+		// while 'B' is held the saturation changes
+		//---------------------------------
+		else if (key == GLFW_KEY_B)
+		{
+			*bPtr = 1;
+		}
+	}
+}
+
+//-------------------------------------------------------------------
+//	uploads a memory mapped mesh file into a single VAO; the mapped
+//	payloads are passed to glBufferData without being copied or parsed
+//
+//	@param:		mesh		the mapped mesh file
+//	@param:		shapes		receives one draw range per shape of the
+//							file, all referencing the same VAO
+//	@param:		shapeIds	the shapeStream of the file, NULL for every
+//							vertex to be shape 0
+//	@param:		uploader	the upload layer the buffers are sent through
+//	@param:		layouts		receives the layout of the VAO
+//-------------------------------------------------------------------
+void makeMappedVAO(const MappedMesh& mesh, DrawRange* shapes, const unsigned int* shapeIds, BufferUploader* uploader, std::vector<VertexLayout>* layouts)
+{
+	PROFILE_ZONE("makeMappedVAO");
+	const MeshFileHeader& header = *mesh.header;
+	unsigned int VBO, EBO;
+
+	glGenBuffers(1, &VBO);
+	glGenBuffers(1, &EBO);
+
+	// copy the payloads straight from the mapping into buffers for OpenGL to use
+	uploader->upload(VBO, mesh.vertices, (size_t)header.vertexCount * header.vertexStride, GL_STATIC_DRAW);
+	uploader->upload(EBO, mesh.indices, (size_t)header.indexCount * header.indexSize, GL_STATIC_DRAW);
+
+	// the vertex attributes the file describes
+	VertexLayout layout;
+	layout.vertexBuffer = VBO;
+	layout.elementBuffer = EBO;
+	layout.shapeBuffer = 0;
+	layout.stride = (int)header.vertexStride;
+	layout.attributeCount = (int)std::min(header.attributeCount, (uint32_t)MAX_VERTEX_ATTRIBUTES);
+	for (int i = 0; i < layout.attributeCount; i++)
+	{
+		const MeshFileAttribute& attrib = header.attributes[i];
+		layout.attributes[i].location = attrib.location;
+		layout.attributes[i].components = (int)attrib.components;
+		layout.attributes[i].type = attrib.type;
+		layout.attributes[i].offset = attrib.offset;
+	}
+	if (shapeIds != NULL)
+	{
+		glGenBuffers(1, &layout.shapeBuffer);
+		uploader->uploadArray(layout.shapeBuffer, shapeIds, (size_t)header.vertexCount, GL_STATIC_DRAW);
+	}
+	layout.VAO = makeVertexArray(layout);
+	layouts->push_back(layout);
+
+	unsigned int indexType = (header.indexSize == 2) ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT;
+	for (unsigned int i = 0; i < header.shapeCount; i++)
+	{
+		shapes[i].VAO = layout.VAO;
+		shapes[i].first = (int)(mesh.shapes[i].firstIndex * header.indexSize);
+		shapes[i].count = (int)mesh.shapes[i].indexCount;
+		shapes[i].indexType = indexType;
+	}
+}
+
+//-------------------------------------------------------------------
+//	takes what a window's callbacks queued since the last frame
+//
+//	@param:		events		the window's events
+//	@param:		input		receives the key presses/releases
+//	@param:		state		cache of render's context; a new
+//							framebuffer size is set as its viewport
+//	@param:		keyTime		receives when the oldest key arrived
+//	@return:	true if any keys were taken
+//-------------------------------------------------------------------
+static bool takeWindowEvents(WindowEvents* events, InputQueue* input, GLStateCache* state, std::chrono::steady_clock::time_point* keyTime)
+{
+	std::lock_guard<std::mutex> lock(events->lock);
+	const std::vector<KeyEvent>& keys = events->keys.events();
+	bool tookKeys = !keys.empty();
+	for (size_t i = 0; i < keys.size(); i++)
+	{
+		input->keyEvent(keys[i].key, keys[i].pressed);
+	}
+	events->keys.clearEvents();
+	*keyTime = events->keyTime;
+
+	if (events->resized)
+	{
+		state->viewport(0, 0, events->width, events->height);
+		events->resized = false;
+	}
+	events->redraw = false;
+	return tookKeys;
+}
+
+//-------------------------------------------------------------------
+//	@param:		events		a window's events
+//	@return:	true if the window needs drawing or has keys waiting
+//-------------------------------------------------------------------
+static bool windowEventsPending(WindowEvents* events)
+{
+	std::lock_guard<std::mutex> lock(events->lock);
+	return events->redraw || !events->keys.events().empty();
+}
+
+//-------------------------------------------------------------------
+//	picks the level of subdivision to draw a shape at: the finest one
+//	whose triangles are still minPixels across. A shape already drawn
+//	at a level stays there until the level it should be at is more
+//	than LOD_HYSTERESIS of a level past it
+//
+//	@param:		pixels		size of the shape on screen; the triangles
+//							of level l are pixels / 2^l across
+//	@param:		minPixels	smallest triangle wanted, in pixels
+//	@param:		count		levels the shape has
+//	@param:		current		level it was drawn at last, -1 for none
+//	@return:	the level, 0 (coarsest) to count - 1
+//-------------------------------------------------------------------
+static int chooseLevel(double pixels, double minPixels, int count, int current)
+{
+	double ideal = (pixels > minPixels) ? log2(pixels / minPixels) : 0.0;
+	int level = std::max(0, std::min((int)floor(ideal), count - 1));
+	if (current >= 0 && current < count)
+	{
+		if ((level > current && ideal < current + 1 + LOD_HYSTERESIS) || (level < current && ideal > current - LOD_HYSTERESIS))
+		{
+			level = current;
+		}
+	}
+	return level;
+}
+
+//-------------------------------------------------------------------
+//	what the shaders know about each shape: buffer textures this
+//	context owns, mirrored in records. A buffer texture can only
+//	address so many texels, so the table is split into chunks of
+//	chunkShapes records, each its own buffer and texture; a draw
+//	binds the chunk holding its shape
+//-------------------------------------------------------------------
+struct ShapeTable
+{
+	int							chunkShapes;	// records in a chunk
+	std::vector<GLuint>			buffers;		// a buffer per chunk
+	std::vector<GLuint>			textures;		// and the buffer texture over it
+	std::vector<int>			capacity;		// records each chunk's buffer has room for
+	std::vector<ShapeRecord>	records;
+	std::vector<ShapeAnimation>	animations;
+	int							prevSelected;	// the shape selected when the table was last written
+};
+
+//-------------------------------------------------------------------
+//	@param:		table		the table to size for this context; it
+//							holds no shapes yet
+//-------------------------------------------------------------------
+static void initShapeTable(ShapeTable* table)
+{
+	GLint maxTexels = 0;
+	glGetIntegerv(GL_MAX_TEXTURE_BUFFER_SIZE, &maxTexels);
+	table->chunkShapes = std::max(maxTexels / SHAPE_RECORD_TEXELS, 1);
+	table->prevSelected = -1;
+}
+
+//-------------------------------------------------------------------
+//	brings the shape table up to date for a frame: shapes that
+//	arrived are added, and the ones input can change (the selected
+//	triangle, the one being colored) are compared with what the table
+//	holds; what differs is written with one upload per chunk. A chunk's
+//	buffer grows, and is given to its texture again, only when shapes
+//	arrive
+//
+//	@param:		table			the table
+//	@param:		numShapes		shapes arrived so far
+//	@param:		triangleColors	the color of each of them
+//	@param:		selected		the shape drawn white, -1 for none
+//	@param:		currentTriangle	the shape input colors
+//	@param:		prevTriangle	the one it colored last frame
+//	@param:		variedPulse		give each shape its own animation
+//	@param:		state			cache of the context's state
+//-------------------------------------------------------------------
+static void updateShapeTable(ShapeTable* table, int numShapes, const std::vector<int>& triangleColors, int selected,
+	int currentTriangle, int prevTriangle, bool variedPulse, GLStateCache* state)
+{
+	PROFILE_ZONE("shape table");
+	std::vector<ShapeRecord>& records = table->records;
+	int firstDirty = numShapes;
+	int lastDirty = -1;
+	int recorded = (int)records.size();
+	if (recorded < numShapes)
+	{
+		if (variedPulse)
+		{
+			variedAnimations(numShapes, &table->animations);
+		}
+		else
+		{
+			table->animations.assign(numShapes, defaultAnimation());
+		}
+		records.resize(numShapes);
+		for (int i = recorded; i < numShapes; i++)
+		{
+			ShapeRecord& record = records[i];
+			record.phase = table->animations[i].phase;
+			record.frequency = table->animations[i].frequency;
+			record.amplitude = table->animations[i].amplitude;
+			record.color = (float)triangleColors[i];
+			record.offset[0] = 0.0f;
+			record.offset[1] = 0.0f;
+			record.scale = 1.0f;
+			record.selected = 0.0f;
+		}
+		firstDirty = recorded;
+		lastDirty = numShapes - 1;
+	}
+
+	int changeable[4] = { selected, table->prevSelected, currentTriangle, prevTriangle };
+	for (int c = 0; c < 4; c++)
+	{
+		int i = changeable[c];
+		if (i < 0 || i >= numShapes)
+		{
+			continue;
+		}
+		float color = (float)triangleColors[i];
+		float isSelected = (i == selected) ? 1.0f : 0.0f;
+		if (records[i].color != color || records[i].selected != isSelected)
+		{
+			records[i].color = color;
+			records[i].selected = isSelected;
+			firstDirty = std::min(firstDirty, i);
+			lastDirty = std::max(lastDirty, i);
+		}
+	}
+	table->prevSelected = selected;
+
+	int chunkShapes = table->chunkShapes;
+	int numChunks = (numShapes + chunkShapes - 1) / chunkShapes;
+	for (int t = 0; t < numChunks; t++)
+	{
+		int first = t * chunkShapes;
+		int count = std::min(numShapes - first, chunkShapes);
+		if (t == (int)table->buffers.size())
+		{
+			GLuint buffer = 0;
+			GLuint texture = 0;
+			glGenBuffers(1, &buffer);
+			glGenTextures(1, &texture);
+			table->buffers.push_back(buffer);
+			table->textures.push_back(texture);
+			table->capacity.push_back(0);
+		}
+
+		// a chunk that grew is uploaded whole; otherwise only the part of the dirty range in it
+		state->bindBuffer(GL_TEXTURE_BUFFER, table->buffers[t]);
+		if (table->capacity[t] < count)
+		{
+			table->capacity[t] = count;
+			glBufferData(GL_TEXTURE_BUFFER, (GLsizeiptr)count * sizeof(ShapeRecord), &records[first], GL_DYNAMIC_DRAW);
+			glActiveTexture(GL_TEXTURE0 + SHAPE_TABLE_UNIT);
+			glBindTexture(GL_TEXTURE_BUFFER, table->textures[t]);
+			glTexBuffer(GL_TEXTURE_BUFFER, GL_RGBA32F, table->buffers[t]);
+		}
+		else
+		{
+			int from = std::max(firstDirty, first);
+			int to = std::min(lastDirty, first + count - 1);
+			if (to >= from)
+			{
+				glBufferSubData(GL_TEXTURE_BUFFER, (GLintptr)(from - first) * sizeof(ShapeRecord),
+					(GLsizeiptr)(to - from + 1) * sizeof(ShapeRecord), &records[from]);
+			}
+		}
+	}
+}
+
+//-------------------------------------------------------------------
+//	@param:		table		the table whose buffers and textures are
+//							deleted
+//	@param:		state		cache of the context's state
+//-------------------------------------------------------------------
+static void releaseShapeTable(ShapeTable* table, GLStateCache* state)
+{
+	if (!table->buffers.empty())
+	{
+		state->deleteBuffers((GLsizei)table->buffers.size(), &table->buffers[0]);
+		glDeleteTextures((GLsizei)table->textures.size(), &table->textures[0]);
+	}
+	table->buffers.clear();
+	table->textures.clear();
+	table->capacity.clear();
+}
+
+//-------------------------------------------------------------------
+//	what decides which shapes a frame draws, and at which level. The
+//	shapes are filed by their bounds as they arrive, so finding the
+//	ones in view only looks at the cells under it. With --gpu-cull, a
+//	compute shader culls the shapes and picks their levels instead,
+//	once they have arrived in one indexed VAO; contexts older than
+//	GL 4.3, and other meshes, are culled on the CPU
+//-------------------------------------------------------------------
+struct ShapeCulling
+{
+	SpatialGrid				grid;
+	std::vector<int>		visible;			// the shapes under the view, in shape order
+	std::vector<int>		shapeLevels;		// the level each shape was last drawn at, for the hysteresis
+	GpuCuller				gpuCuller;
+	std::vector<SubMesh>	cullRanges;			// each shape's draw range, for the GPU culler without levels
+	int						gpuCheckedShapes;	// shapes last checked for the GPU culler
+
+	// what cullShapes found for the frame
+	bool					culling;			// every shape has bounds
+	bool					lod;				// each shape's level is picked
+	bool					gpuCulling;			// the GPU culls and draws the shapes
+	double					pixelsX;			// pixels per unit of what is drawn to
+	double					pixelsY;
+};
+
+//-------------------------------------------------------------------
+//	finds the shapes under the view. Shapes that arrived since the
+//	last frame are filed, in cells about the size of an average shape;
+//	without bounds for every shape nothing can be culled, and every
+//	shape is visible. On the GPU path the compute shader is run here
+//	and visible is left empty
+//
+//	@param:		cull		the culling state, given the frame's result
+//	@param:		shapes		the draw range of each shape
+//	@param:		bounds		the xy bounds of each shape
+//	@param:		levels		every level of subdivision of each shape
+//	@param:		chunkShapes	records in a shape table chunk
+//	@param:		frameView	the view the frame is drawn from
+//	@param:		program		the shader program, 0 until uploaded
+//	@param:		frameSlot	the frame's slot in the frames in flight
+//	@param:		options		the level of detail wanted
+//	@param:		state		cache of the context's state
+//	@param:		gpuProfiler	times the compute pass
+//-------------------------------------------------------------------
+static void cullShapes(ShapeCulling* cull, const std::vector<DrawRange>& shapes, const std::vector<Bounds2D>& bounds, const ShapeLevels& levels,
+	int chunkShapes, const float frameView[4], unsigned int program, int frameSlot, const RenderOptions& options, GLStateCache* state, GpuProfiler* gpuProfiler)
+{
+	int numShapes = (int)shapes.size();
+	cull->culling = ((int)bounds.size() == numShapes);
+	cull->lod = cull->culling && options.lodPixels > 0.0 && levels.count > 0 && (int)levels.ranges.size() == numShapes * levels.count;
+	if (cull->gpuCuller.enabled() && cull->culling && numShapes > 0 && cull->gpuCheckedShapes != numShapes)
+	{
+		bool oneVAO = (shapes[0].indexType != 0);
+		for (int i = 1; i < numShapes && oneVAO; i++)
+		{
+			oneVAO = (shapes[i].VAO == shapes[0].VAO && shapes[i].indexType == shapes[0].indexType);
+		}
+		if (oneVAO)
+		{
+			int indexBytes = (shapes[0].indexType == GL_UNSIGNED_SHORT) ? 2 : 4;
+			cull->cullRanges.resize(numShapes);
+			for (int i = 0; i < numShapes && !cull->lod; i++)
+			{
+				cull->cullRanges[i].firstIndex = (unsigned int)(shapes[i].first / indexBytes);
+				cull->cullRanges[i].indexCount = (unsigned int)shapes[i].count;
+			}
+			cull->gpuCuller.setShapes(&bounds[0], cull->lod ? &levels.ranges[0] : &cull->cullRanges[0], numShapes,
+				cull->lod ? levels.count : 1, chunkShapes);
+		}
+		cull->gpuCheckedShapes = numShapes;
+	}
+	cull->gpuCulling = (numShapes > 0 && cull->gpuCuller.shapeCount() == numShapes);
+	if (cull->culling && !cull->gpuCulling && cull->grid.size() < numShapes)
 	{
-		*fPtr = 1;
+		PROFILE_ZONE("file shapes");
+		int first = cull->grid.size();
+		Bounds2D arrived = bounds[first];
+		double extent = 0.0;
+		for (int i = first; i < numShapes; i++)
+		{
+			arrived.minX = std::min(arrived.minX, bounds[i].minX);
+			arrived.minY = std::min(arrived.minY, bounds[i].minY);
+			arrived.maxX = std::max(arrived.maxX, bounds[i].maxX);
+			arrived.maxY = std::max(arrived.maxY, bounds[i].maxY);
+			extent += std::max(bounds[i].maxX - bounds[i].minX, bounds[i].maxY - bounds[i].minY);
+		}
+		if (first == 0)
+		{
+			cull->grid.setCellSize((float)(extent / numShapes));
+		}
+		cull->grid.reserve(arrived);
+		for (int i = first; i < numShapes; i++)
+		{
+			cull->grid.insert(i, bounds[i]);
+		}
 	}
-	// else if the user presses '3', switch to the Red Shader
-	else if (glfwGetKey(window, GLFW_KEY_3) == GLFW_PRESS)
+
+	// each shape's level follows its size in pixels of what is drawn
+	// to, so a smaller window or resolution scale draws fewer triangles
+	//---------------------------------
+	GLint drawViewport[4];
+	state->getViewport(drawViewport);
+	cull->pixelsX = 0.5 * drawViewport[2] * frameView[2];
+	cull->pixelsY = 0.5 * drawViewport[3] * frameView[3];
+	if (cull->lod && (int)cull->shapeLevels.size() < numShapes)
 	{
-		*fPtr = 2;
+		cull->shapeLevels.resize(numShapes, -1);
 	}
-	
-	//else if the user presses '4', switch to the Interpolated Shader
-	else if (glfwGetKey(window, GLFW_KEY_4) == GLFW_PRESS)
+
+	PROFILE_ZONE("cull");
+	cull->visible.clear();
+	if (cull->gpuCulling)
 	{
-		*fPtr = 3;
+		if (program != 0)
+		{
+			GpuCullView cullView;
+			cullView.rect[0] = frameView[0] - 1.0f / frameView[2];
+			cullView.rect[1] = frameView[1] - 1.0f / frameView[3];
+			cullView.rect[2] = frameView[0] + 1.0f / frameView[2];
+			cullView.rect[3] = frameView[1] + 1.0f / frameView[3];
+			cullView.pixelsPerUnit[0] = (float)cull->pixelsX;
+			cullView.pixelsPerUnit[1] = (float)cull->pixelsY;
+			cullView.minPixels = (float)options.lodPixels;
+			cullView.hysteresis = (float)LOD_HYSTERESIS;
+			gpuProfiler->beginScope("cull");
+			cull->gpuCuller.cull(frameSlot, cullView, state);
+			gpuProfiler->endScope();
+		}
 	}
-	/*													
-	// else if the user presses '5', switch to the White Shader
-	else if (glfwGetKey(window, GLFW_KEY_5) == GLFW_PRESS)
+	else if (cull->culling)
 	{
-		*fPtr = 4;
-	}														*/
+		Bounds2D viewRect;
+		viewRect.minX = frameView[0] - 1.0f / frameView[2];
+		viewRect.maxX = frameView[0] + 1.0f / frameView[2];
+		viewRect.minY = frameView[1] - 1.0f / frameView[3];
+		viewRect.maxY = frameView[1] + 1.0f / frameView[3];
+		cull->grid.query(viewRect, &cull->visible);
+	}
+	else
+	{
+		for (int i = 0; i < numShapes; i++)
+		{
+			cull->visible.push_back(i);
+		}
+	}
+}
+
+//-------------------------------------------------------------------
+//	the visible shapes are split into partitions; each is sorted and
+//	recorded into a command buffer on the pool, then replayed in order
+//-------------------------------------------------------------------
+struct DrawRecording
+{
+	DrawRecording() : pool(0) {}
+
+	ThreadPool					pool;
+	std::vector<RenderQueue>	queues;
+	std::vector<CommandBuffer>	commandBuffers;
+	std::vector<int>			partTriangles;		// what each partition drew
+	std::vector<int>			partLevelChanges;
+};
+
+//-------------------------------------------------------------------
+//	what a frame drew
+//-------------------------------------------------------------------
+struct FrameDraws
+{
+	RenderQueueStats	stats;
+	int					visible;		// shapes drawn
+	int					triangles;
+	int					levelChanges;	// shapes drawn at another level than before
+};
+
+//-------------------------------------------------------------------
+//	records the visible shapes, one partition per task, then submits
+//	them; the replay is the only serial stage. On the GPU path one
+//	multi-draw per shape table chunk submits what the compute shader
+//	kept, and the counts are the culler's, a few frames late
+//
+//	@param:		recording	the partitions' queues and command buffers
+//	@param:		cull		the frame's culling, from cullShapes; the
+//							levels drawn are kept in it
+//	@param:		table		the shape table the draws read
+//	@param:		shapes		the draw range of each shape
+//	@param:		bounds		the xy bounds of each shape
+//	@param:		levels		every level of subdivision of each shape
+//	@param:		program		the shader program; nothing is drawn while
+//							it is 0
+//	@param:		polygonMode	wireframe or solid
+//	@param:		lodPixels	smallest triangle wanted, in pixels
+//	@param:		state		cache of the context's state
+//	@param:		gpuProfiler	times the draws
+//	@return:	what was drawn
+//-------------------------------------------------------------------
+static FrameDraws drawShapes(DrawRecording* recording, ShapeCulling* cull, const ShapeTable& table, const std::vector<DrawRange>& shapes,
+	const std::vector<Bounds2D>& bounds, const ShapeLevels& levels, unsigned int program, GLenum polygonMode, double lodPixels,
+	GLStateCache* state, GpuProfiler* gpuProfiler)
+{
+	int numVisible = (int)cull->visible.size();
+	int numPartitions = cull->gpuCulling ? 0 : (numVisible + RECORD_PARTITION_SIZE - 1) / RECORD_PARTITION_SIZE;
+	if ((int)recording->queues.size() < numPartitions)
+	{
+		recording->queues.resize(numPartitions);
+		recording->commandBuffers.resize(numPartitions);
+	}
+	recording->partTriangles.assign(numPartitions, 0);
+	recording->partLevelChanges.assign(numPartitions, 0);
+
+	recording->pool.parallelFor(numPartitions, [&](int part)
+	{
+		PROFILE_ZONE("record partition");
+		RenderQueue& queue = recording->queues[part];
+		int end = std::min(numVisible, (part + 1) * RECORD_PARTITION_SIZE);
+
+		queue.clear();
+		for (int k = part * RECORD_PARTITION_SIZE; k < end; k++)
+		{
+			int i = cull->visible[k];
+			if (program == 0)
+			{
+				continue;
+			}
+
+			DrawItem item;
+			item.program = program;
+			item.polygonMode = polygonMode;
+			item.range = shapes[i];
+			item.table = table.textures[i / table.chunkShapes];
+			item.tableBase = (unsigned int)(i / table.chunkShapes * table.chunkShapes);
+			item.key = RenderQueue::makeSortKey(program, shapes[i].VAO, polygonMode, (unsigned int)i);
+			if (cull->lod)
+			{
+				double pixels = std::max((bounds[i].maxX - bounds[i].minX) * cull->pixelsX, (bounds[i].maxY - bounds[i].minY) * cull->pixelsY);
+				int level = chooseLevel(pixels, lodPixels, levels.count, cull->shapeLevels[i]);
+				if (level != cull->shapeLevels[i])
+				{
+					recording->partLevelChanges[part]++;
+					cull->shapeLevels[i] = level;
+				}
+				const SubMesh& range = levels.ranges[i * levels.count + level];
+				item.range.first = (int)range.firstIndex * ((item.range.indexType == GL_UNSIGNED_SHORT) ? 2 : 4);
+				item.range.count = (int)range.indexCount;
+			}
+			recording->partTriangles[part] += item.range.count / 3;
+			queue.add(item);
+		}
+
+		recording->commandBuffers[part].clear();
+		queue.record(&recording->commandBuffers[part]);
+	});
+
+	FrameDraws draws;
+	memset(&draws, 0, sizeof(draws));
+	draws.visible = numVisible;
+	gpuProfiler->beginScope("draws");
+	for (int part = 0; part < numPartitions; part++)
+	{
+		PROFILE_ZONE("replay partition");
+		gpuProfiler->beginScope("draw group");
+		replayCommands(recording->commandBuffers[part], state);
+		gpuProfiler->endScope();
+
+		const RenderQueueStats& partStats = recording->queues[part].stats();
+		draws.stats.draws += partStats.draws;
+		draws.stats.programBinds += partStats.programBinds;
+		draws.stats.vaoBinds += partStats.vaoBinds;
+		draws.stats.bindsAvoided += partStats.bindsAvoided;
+		draws.stats.batched += partStats.batched;
+		draws.triangles += recording->partTriangles[part];
+		draws.levelChanges += recording->partLevelChanges[part];
+	}
+
+	if (cull->gpuCulling && program != 0)
+	{
+		GpuCuller& gpuCuller = cull->gpuCuller;
+		state->useProgram(program);
+		state->bindVertexArray(shapes[0].VAO);
+		state->polygonMode(polygonMode);
+		for (int t = 0; t < gpuCuller.chunkCount(); t++)
+		{
+			bindShapeTable(table.textures[t], (GLuint)(t * table.chunkShapes));
+			gpuCuller.draw(t, shapes[0].indexType, state);
+		}
+		draws.stats.draws = gpuCuller.chunkCount();
+		draws.stats.programBinds = 1;
+		draws.stats.vaoBinds = 1;
+		draws.visible = gpuCuller.stats().visible;
+		draws.triangles = gpuCuller.stats().triangles;
+		draws.levelChanges = gpuCuller.stats().levelChanges;
+	}
+	gpuProfiler->endScope();
+	return draws;
+}
+
+//-------------------------------------------------------------------
+//	reports how many binds the sorting saved, the GPU frame time and
+//	what was drawn in the window's title, or on stdout when headless
+//
+//	@param:		win				the window, NULL when headless
+//	@param:		pollEvents		this thread runs the window's events
+//	@param:		windowEvents	the window's events, for a title set
+//								from another thread
+//	@param:		draws			what the frame drew
+//	@param:		numShapes		shapes arrived so far
+//	@param:		stateStats		the frame's GL calls
+//	@param:		gpuProfiler		the GPU times
+//	@param:		framesInFlight	the frame latency
+//	@param:		resolution		the resolution scale
+//-------------------------------------------------------------------
+static void reportFrame(GLFWwindow* win, bool pollEvents, WindowEvents* windowEvents, const FrameDraws& draws, int numShapes,
+	const GLStateStats& stateStats, const GpuProfiler& gpuProfiler, const FramesInFlight& framesInFlight, const DynamicResolution& resolution)
+{
+	std::stringstream title;
+	title << "LearnOPenGL - " << draws.stats.draws << " draws, " << draws.stats.programBinds << " programs, "
+		<< draws.stats.vaoBinds << " VAOs, " << draws.stats.bindsAvoided << " binds avoided, "
+		<< stateStats.filtered << " GL calls filtered";
+
+	std::vector<GpuScopeStats> gpuStats;
+	gpuProfiler.summarize(&gpuStats);
+	if (!gpuStats.empty())
+	{
+		title << ", GPU " << gpuStats[0].avgMs << " ms";		// the frame scope is always resolved first
+	}
+	title << ", latency " << framesInFlight.stats().lastLatencyMs << " ms";
+	if (resolution.enabled())
+	{
+		title << ", resolution " << (int)(resolution.stats().scale * 100.0 + 0.5) << "%";
+	}
+	title << ", " << draws.visible << " of " << numShapes << " shapes visible, " << draws.triangles << " triangles";
+	if (pollEvents)
+	{
+		glfwSetWindowTitle(win, title.str().c_str());
+	}
+	else if (win != NULL)
+	{
+		// titles can only be set on the main thread; it is woken to do so
+		{
+			std::lock_guard<std::mutex> lock(windowEvents->lock);
+			windowEvents->title = title.str();
+			windowEvents->titleChanged = true;
+		}
+		glfwPostEmptyEvent();
+	}
+	else
+	{
+		std::cout << title.str() << std::endl;
+	}
+}
+
+//-------------------------------------------------------------------
+//	what render counted over a run, for reportRun
+//-------------------------------------------------------------------
+struct RunCounts
+{
+	int		frames;			// every frame rendered
+	int		loadedFrames;	// frames rendered with every asset loaded
+	double	cpuTotalMs;		// CPU time of the loaded frames
+	double	cpuMaxMs;
+	int		idleWaits;		// on demand, waits for events
+	double	idleSeconds;
+};
+
+//-------------------------------------------------------------------
+//	reports a finished run: captures, frame pacing, resolution scale,
+//	idle time, the GPU and CPU profiles, and for a headless run how
+//	long the frames took and the last frame's pixels
+//
+//	@param:		win				the window, NULL when headless
+//	@param:		options			where images, traces and the report go
+//	@param:		counts			what render counted
+//	@param:		loadedTime		when every asset was loaded
+//	@param:		onDemand		the window was drawn on demand
+//	@param:		capture			the frame capture, closed here
+//	@param:		framesInFlight	the frame pacing
+//	@param:		resolution		the resolution scaling
+//	@param:		gpuProfiler		the GPU profile
+//-------------------------------------------------------------------
+static void reportRun(GLFWwindow* win, const RenderOptions& options, const RunCounts& counts, std::chrono::steady_clock::time_point loadedTime, bool onDemand, FrameCapture* capture,
+	const FramesInFlight& framesInFlight, const DynamicResolution& resolution, const GpuProfiler& gpuProfiler)
+{
+	if (capture->isOpen())
+	{
+		capture->close();
+		FrameCaptureStats captureStats = capture->stats();
+		std::cout << "CAPTURE::FRAMES " << captureStats.written << " of " << captureStats.captured << " written to "
+			<< options.capturePath << ", " << captureStats.dropped << " dropped, " << captureStats.stalls << " stalls" << std::endl;
+	}
+	FramePacingStats pacing = framesInFlight.stats();
+	std::cout << "PACING::FRAMES_IN_FLIGHT " << framesInFlight.depth() << ": waited for the GPU " << pacing.waitedMs << " ms in "
+		<< pacing.waits << " of " << counts.frames << " frames" << std::endl;
+	std::cout << "PACING::LATENCY avg " << pacing.latencyAvgMs << " ms, max " << pacing.latencyMaxMs << " ms over "
+		<< pacing.frames << " frames; key to photon avg " << pacing.keyLatencyAvgMs << " ms, max " << pacing.keyLatencyMaxMs
+		<< " ms over " << pacing.keyFrames << " frames" << std::endl;
+	if (resolution.enabled())
+	{
+		DynamicResolutionStats scaling = resolution.stats();
+		std::cout << "DYNAMIC_RESOLUTION::SCALE avg " << scaling.avgScale << ", min " << scaling.minScale << ", last " << scaling.scale
+			<< " over " << scaling.frames << " frames, " << scaling.changes << " changes" << std::endl;
+	}
+	if (onDemand)
+	{
+		std::cout << "ON_DEMAND::IDLE " << counts.idleSeconds << " s in " << counts.idleWaits << " waits over " << counts.frames << " frames" << std::endl;
+	}
+
+	// headless runs are benchmarks; report how long the frames took
+	//---------------------------------
+	int loadedFrames = counts.loadedFrames;
+	if (win == NULL)
+	{
+		glFinish();
+		double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - loadedTime).count();
+		std::cout << "HEADLESS::FRAMES " << loadedFrames << " in " << ms << " ms (" << ms / (loadedFrames > 0 ? loadedFrames : 1)
+			<< " ms per frame)" << std::endl;
+
+		// the offscreen framebuffer still holds the last frame
+		if (options.imagePath != NULL || options.report != NULL)
+		{
+			GLint viewport[4];
+			glGetIntegerv(GL_VIEWPORT, viewport);
+			std::vector<unsigned char> image((size_t)viewport[2] * viewport[3] * 4);
+			glPixelStorei(GL_PACK_ALIGNMENT, 1);
+			glReadPixels(0, 0, viewport[2], viewport[3], GL_RGBA, GL_UNSIGNED_BYTE, &image[0]);
+			if (options.imagePath != NULL)
+			{
+				writeImage(options.imagePath, viewport[2], viewport[3], &image[0]);
+			}
+			if (options.report != NULL)
+			{
+				options.report->width = viewport[2];
+				options.report->height = viewport[3];
+				options.report->image.swap(image);
+			}
+		}
+	}
+
+	// GPU profile of the last GPU_PROFILER_HISTORY frames and the CPU zones still held
+	//---------------------------------
+	std::vector<GpuScopeStats> gpuStats;
+	gpuProfiler.summarize(&gpuStats);
+	for (size_t i = 0; i < gpuStats.size(); i++)
+	{
+		std::cout << "GPU::" << gpuStats[i].name << ": min " << gpuStats[i].minMs << " ms, avg " << gpuStats[i].avgMs
+			<< " ms, p99 " << gpuStats[i].p99Ms << " ms over " << gpuStats[i].samples << " frames" << std::endl;
+	}
+	std::vector<CpuZoneStats> cpuStats;
+	summarizeCpuZones(&cpuStats);
+	for (size_t i = 0; i < cpuStats.size(); i++)
+	{
+		std::cout << "CPU::" << cpuStats[i].name << ": " << cpuStats[i].calls << " calls, " << cpuStats[i].totalMs << " ms, avg "
+			<< cpuStats[i].avgUs << " us, max " << cpuStats[i].maxUs << " us" << std::endl;
+	}
+	if (gpuProfiler.droppedFrames() > 0)
+	{
+		std::cout << "GPU::DROPPED " << gpuProfiler.droppedFrames() << " frames not ready in time" << std::endl;
+	}
+	if (gpuProfiler.droppedScopes() > 0)
+	{
+		std::cout << "GPU::DROPPED " << gpuProfiler.droppedScopes() << " scopes past the " << GPU_PROFILER_MAX_SCOPES
+			<< " a frame can time" << std::endl;
+	}
+	if (options.tracePath != NULL)
+	{
+		gpuProfiler.writeTrace(options.tracePath);
+	}
+
+	if (options.report != NULL)
+	{
+		RenderReport* report = options.report;
+		report->frames = loadedFrames;
+		report->cpuAvgMs = counts.cpuTotalMs / (loadedFrames > 0 ? loadedFrames : 1);
+		report->cpuMaxMs = counts.cpuMaxMs;
+		report->gpuAvgMs = gpuStats.empty() ? 0.0 : gpuStats[0].avgMs;		// the frame scope is always resolved first
+		report->gpuP99Ms = gpuStats.empty() ? 0.0 : gpuStats[0].p99Ms;
+	}
+}
+
+//-------------------------------------------------------------------
+// render loop - renders pixels to a window
+//
+//	@param:		win			the window to be rendered to
+//	@param:		shaderProg	the shader program's reference ID, 0 until
+//							it has been uploaded
+//	@param:		shapeList	the draw range of each shape; empty until
+//							the mesh has been uploaded
+//	@param:		bounds		the xy bounds of each shape, filled in with
+//							shapeList; shapes are only culled when
+//							every one of them has bounds
+//	@param:		levels		every level of subdivision of each shape,
+//							filled in with shapeList; with none, or
+//							without options.lodPixels, each shape is
+//							drawn as shapeList has it
+//	@param:		loader		the loader whose uploads run each frame
+//	@param:		uploader	the upload layer flushed before each frame
+//	@param:		options		frame limit and profiling output
+//
+//	win is NULL when running headless; input is ignored and frames
+//	go to whatever framebuffer is bound
+//-------------------------------------------------------------------
+void render(GLFWwindow* win, const unsigned int* shaderProg, std::vector<DrawRange>* shapeList, const std::vector<Bounds2D>& bounds, const ShapeLevels& levels, AssetLoader* loader, BufferUploader* uploader, const RenderOptions& options)
+{
+	const std::vector<DrawRange>& shapes = *shapeList;
+
+	// determines which fragmentation shader is in current use
+	//---------------------------------
+	int currentFrag = 0;
+	int * currentFragPtr = &currentFrag;
+
+	// determines which triangle is selected for manipulation
+	//---------------------------------
+	int currentTriangle = 0;
+	int * currentTriPtr = &currentTriangle;
+	int prevTriangle = 0;
+
+	// turns blinking off and on
+	//---------------------------------
+	int blink = 0;
+	int * blinkPtr = &blink;
+
+	// the shaders work out each shape's saturation from the time the
+	// animation has run, which only advances in fixed simulation steps;
+	// frames draw it between the last two steps
+	//---------------------------------
+	SimulationClock simClock(SIMULATION_STEP);
+	double animationTime = 0.0;
+	double prevAnimationTime = 0.0;
+	float frameTime = 0.0f;
+	double lastFrameTime = 0.0;
+
+	// the part of the plane in view, moved with the arrow keys, = and -
+	// in the same steps as the animation; the shaders draw from its
+	// centre (x, y) at its zoom, and only the shapes under it are drawn
+	//---------------------------------
+	double view[3] = { 0.0, 0.0, 1.0 };
+	double prevView[3] = { 0.0, 0.0, 1.0 };
+	float frameView[4] = { 0.0f, 0.0f, 1.0f, 1.0f };
+
+	// vertices without a shape number of their own are shape 0
+	//---------------------------------
+	glVertexAttribI4ui(SHAPE_ATTRIBUTE, 0, 0, 0, 0);
+
+	// caps the frame rate when asked to; vsync already paces a window
+	//---------------------------------
+	FrameLimiter limiter(options.maxFps);
+	if (win != NULL)
+	{
+		glfwSwapInterval(options.swapInterval);
+	}
 
-	// change between triangles
+	// wireframe or solid, switched with P and F
 	//---------------------------------
+	GLenum polygonMode = GL_FILL;
+	GLenum * polygonModePtr = &polygonMode;
 
-	// if the user presses 'W', switch to the Top Triangle
-	if (glfwGetKey(window, GLFW_KEY_W) == GLFW_PRESS)
-	{
-		*tPtr = 0;
-	}
-	// else if the user presses 'A', switch to the Left Triangle
-	else if (glfwGetKey(window, GLFW_KEY_A) == GLFW_PRESS)
+	// binds and fixed function state go through the state cache,
+	// which drops calls that would not change anything
+	//---------------------------------
+	GLStateCache* state = currentGLState();
+	state->invalidate();		// an earlier scene may have used the context
+
+	// the CPU runs at most options.framesInFlight frames ahead of the
+	// GPU; each frame is fenced once swapped
+	//---------------------------------
+	FramesInFlight framesInFlight;
+	framesInFlight.init(options.framesInFlight);
+	double lastWaitedMs = 0.0;
+
+	// values that change once per frame go to the programs' FrameBlock
+	// through this context's own buffer, as programs may be shared. It
+	// holds a copy for each frame in flight; a frame writes its own copy
+	// unsynchronized, as the frame that last read it has finished
+	//---------------------------------
+	GLint uniformAlignment = 1;
+	glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &uniformAlignment);
+	uniformAlignment = std::max(uniformAlignment, 1);
+	GLsizeiptr frameBlockSize = sizeof(FrameBlockData);
+	GLsizeiptr frameBlockStride = (frameBlockSize + uniformAlignment - 1) / uniformAlignment * uniformAlignment;
+	GLuint frameBlock = 0;
+	glGenBuffers(1, &frameBlock);
+	state->bindBuffer(GL_UNIFORM_BUFFER, frameBlock);
+	glBufferData(GL_UNIFORM_BUFFER, frameBlockStride * framesInFlight.depth(), NULL, GL_DYNAMIC_DRAW);
+	FrameBlockData frameBlockCopies[MAX_FRAMES_IN_FLIGHT];		// what each copy holds; an animation time of -1 until written
+	memset(frameBlockCopies, 0, sizeof(frameBlockCopies));
+	for (int i = 0; i < MAX_FRAMES_IN_FLIGHT; i++)
 	{
-		*tPtr = 1;
+		frameBlockCopies[i].animationTime = -1.0f;
 	}
-	// else if the user presses 'D', switch to the Right Triangle
-	else if (glfwGetKey(window, GLFW_KEY_D) == GLFW_PRESS)
+
+	// a frame writes the shape records that changed to the shape table,
+	// so drawing a shape sets no uniforms of its own; the shapes under
+	// the view are then found, and recorded and submitted
+	//---------------------------------
+	ShapeTable shapeTable;
+	initShapeTable(&shapeTable);
+	ShapeCulling cull;
+	cull.gpuCheckedShapes = 0;
+	if (options.gpuCull)
 	{
-		*tPtr = 2;
+		cull.gpuCuller.init(framesInFlight.depth());
 	}
+	DrawRecording recording;
+	double lastReport = 0.0;
+
+	// GPU time of each part of the frame, read back a few frames late
+	//---------------------------------
+	GpuProfiler gpuProfiler;
+	gpuProfiler.init();
+
+	// with a GPU budget, the scene is drawn offscreen at a scale that
+	// follows the frame times the profiler reads back
+	//---------------------------------
+	DynamicResolution resolution;
+	resolution.init(options.resolutionBudgetMs);
+	int resolvedFrames = 0;
 
-	// change between polygon and fill
+	// counts frames for the upload report, and the frames rendered
+	// with every asset loaded for the frame limit; the input session
+	// starts with the first of those
 	//---------------------------------
+	RunCounts counts;
+	memset(&counts, 0, sizeof(counts));
+	std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+	std::chrono::steady_clock::time_point loadedTime = startTime;
+	double sessionTime = 0.0;
 
-	// if the user presses 'P', switch to Polygon (wireframe) Mode
-	if (glfwGetKey(window, GLFW_KEY_P) == GLFW_PRESS)
+	// key edges come from the window's key callback, or from a
+	// recorded session
+	//---------------------------------
+	InputQueue input;
+	InputRecorder recorder;
+	InputPlayer player;
+	WindowEvents ownEvents;
+	WindowEvents* windowEvents = (options.windowEvents != NULL) ? options.windowEvents : &ownEvents;
+	bool pollEvents = (win != NULL && options.windowEvents == NULL);		// otherwise the main thread runs the callbacks
+	if (pollEvents)
 	{
-		glPolygonMode(GL_FRONT_AND_BACK, GL_LINE);
+		glfwSetWindowUserPointer(win, windowEvents);
 	}
-	// else if the user presses 'F', switch to Fill (solid) mode
-	else if (glfwGetKey(window, GLFW_KEY_F) == GLFW_PRESS)
+	if (options.replayPath != NULL)
 	{
-		glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
+		player.open(options.replayPath);
 	}
-
-	// turn blink on/off
-	//---------------------------------
-
-	// if the user presses 'B', switch to increase Saturation
-	if (glfwGetKey(window, GLFW_KEY_B) == GLFW_PRESS)
+	else if (options.replayEvents != NULL)
 	{
-		*bPtr = 1;
+		player.load(*options.replayEvents);
 	}
-	// else if user presses "V", switch to decrease Saturation
-	else if (glfwGetKey(window, GLFW_KEY_B) == GLFW_RELEASE)
+	else if (win != NULL)
 	{
-		*bPtr = 0;
+		if (pollEvents)
+		{
+			glfwSetKeyCallback(win, key_callback);
+		}
+		if (options.recordPath != NULL)
+		{
+			recorder.open(options.recordPath);
+		}
 	}
-}
 
-//-------------------------------------------------------------------
-// render loop - renders pixels to a window
-//
-//	@param:		win			the window to be rendered to
-//	@param:		shaderProg	an array of shader program reference IDs
-//	@param:		VAO			reference ID to a Virtual Array Object
-//	@param:		numVAOs		the number of VAOs being passed
-//-------------------------------------------------------------------
-void render(GLFWwindow* win, unsigned int * shaderProg[], unsigned int* VAO, int numVAOs)
-{
-	// determines which fragmentation shader is in current use
+	// on demand, a window is only drawn when something changed; a
+	// replay or an offscreen benchmark always draws every frame, and
+	// only the thread running the window's events can wait for them
 	//---------------------------------
-	int currentFrag = 0;
-	int * currentFragPtr = &currentFrag;
-	int prevFrag = 0;
+	bool onDemand = options.onDemand && pollEvents && !player.isOpen();
 
-	// determines which triangle is selected for manipulation
+	// per frame statistics for comparing runs
 	//---------------------------------
-	int currentTriangle = 0;
-	int * currentTriPtr = &currentTriangle;
-	int prevTriangle = 0;
+	std::ofstream statsFile;
+	if (options.statsPath != NULL)
+	{
+		statsFile.open(options.statsPath, std::ios::out | std::ios::trunc);
+		statsFile << "frame,session_ms,cpu_ms,draws,program_binds,vao_binds,binds_avoided,gl_calls,gl_filtered,animation_time,"
+			"gpu_wait_ms,latency_ms,resolution_scale,visible,triangles,level_changes,batched" << std::endl;
+	}
 
-	// turns blinking off and on
+	// every frame of the session saved without stalling on the read back
 	//---------------------------------
-	int blink = 0;
-	int * blinkPtr = &blink;
-
-	float satValue = 1.0f;
+	FrameCapture capture;
+	if (options.capturePath != NULL)
+	{
+		capture.open(options.capturePath);
+	}
 
 	// holds which triangle is which color
 	//---------------------------------
-	int triangleColors[3] = {
-		0,	1,	2				// colors	 (0 = Blue,	1 = Yellow, 2 = Red)
-	};
+	std::vector<int> triangleColors(3);
+	for (int i = 0; i < 3; i++)
+	{
+		triangleColors[i] = i;		// colors	 (0 = Blue,	1 = Yellow, 2 = Red)
+	}
 
 	//---------------------------------
 	// render loop
 	//---------------------------------
-	while (!glfwWindowShouldClose(win))
+	while ((win == NULL || !glfwWindowShouldClose(win)) && (options.frameLimit <= 0 || counts.loadedFrames < options.frameLimit))
 	{
-		// process state changes via input
+		PROFILE_ZONE("frame");
+		int frameSlot = framesInFlight.beginFrame();		// waits while the GPU is a whole depth behind
+		std::chrono::steady_clock::time_point frameStart = std::chrono::steady_clock::now();
+		double timeValue = std::chrono::duration<double>(frameStart - startTime).count();
+		gpuProfiler.beginFrame();
+		if (gpuProfiler.resolvedFrames() != resolvedFrames)
+		{
+			resolution.addFrameTime(gpuProfiler.lastFrameMs());
+			resolvedFrames = gpuProfiler.resolvedFrames();
+		}
+
+		// finish loading whatever the workers have ready, within budget
+		//---------------------------------
+		gpuProfiler.beginScope("uploads");
+		loader->pumpUploads(UPLOAD_BUDGET_MS);
+		uploader->flush();
+		gpuProfiler.endScope();
+
+		bool loaded = loader->settled();
+		if (loaded && counts.loadedFrames == 0)
+		{
+			loadedTime = frameStart;
+		}
+
+		// advance the simulation by the real frame time, or by a fixed
+		// step once a replay is running
 		//---------------------------------
-		processInput(win, currentFragPtr, currentTriPtr, blinkPtr);
+		double frameSeconds = timeValue - lastFrameTime;
+		if (player.isOpen())
+		{
+			frameSeconds = loaded ? REPLAY_FRAME_TIME : 0.0;
+			sessionTime = counts.loadedFrames * REPLAY_FRAME_TIME;
+		}
+		else if (loaded)
+		{
+			sessionTime = std::chrono::duration<double>(frameStart - loadedTime).count();
+		}
+		int simSteps = simClock.advance(frameSeconds);
+		lastFrameTime = timeValue;
+
+		UploadStats uploads = uploader->endFrame();
+		if (uploads.bytes > 0)
+		{
+			std::cout << "UPLOAD::FRAME " << counts.frames << ": " << uploads.bytes << " bytes into " << uploads.spans
+				<< " buffers in " << uploads.transfers << " transfers" << std::endl;
+		}
+		counts.frames++;
+
+		int numShapes = (int)shapes.size();
+		while ((int)triangleColors.size() < numShapes)
+		{
+			triangleColors.push_back((int)triangleColors.size() % 3);
+		}
 
-		// set the color of the current triangle selected
+		// process state changes via input
 		//---------------------------------
-		// Same Triangle
-		if (currentTriangle == prevTriangle)
+		std::chrono::steady_clock::time_point sampleTime = std::chrono::steady_clock::now();
+		std::chrono::steady_clock::time_point keyTime = sampleTime;
+		bool keyInput = false;
+		if (win != NULL)
+		{
+			keyInput = takeWindowEvents(windowEvents, &input, state, &keyTime);
+		}
+		if (player.isOpen())
 		{
-			// Different Color
-			if (currentFrag != prevFrag)
+			if (loaded)
 			{
-				triangleColors[currentTriangle] = currentFrag;		// change the color of the current triangle
-				prevFrag = currentFrag;								// and update the previously selected color
+				player.play(sessionTime, &input);
 			}
 		}
-		// Different Triangle
-		else // (currentTriangle != prevTriangle)
+		else
 		{
-			prevFrag = triangleColors[currentTriangle];	
-			currentFrag = prevFrag;				
-			prevTriangle = currentTriangle;		
+			for (size_t i = 0; i < input.events().size(); i++)
+			{
+				recorder.record(sessionTime, input.events()[i].key, input.events()[i].pressed);
+			}
 		}
+		prevTriangle = currentTriangle;
+		processInput(win, input, currentFragPtr, currentTriPtr, blinkPtr, polygonModePtr, &triangleColors);
+		input.clearEvents();
 
 		// render
 		//---------------------------------
-		glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
+		resolution.beginFrame(state);
+		state->clearColor(0.0f, 0.0f, 0.0f, 0.0f);
+		gpuProfiler.beginScope("clear");
 		glClear(GL_COLOR_BUFFER_BIT);
+		gpuProfiler.endScope();
 
 		// draw to the window buffer
 		//---------------------------------
 
 		// Change the color of the selected triangle to White when selected
+		int selected = -1;
+		if (input.isDown(GLFW_KEY_W))
+		{
+			selected = 0;		// Top Triangle
+		}
+		else if (input.isDown(GLFW_KEY_A))
+		{
+			selected = 1;		// Left Triangle
+		}
+		else if (input.isDown(GLFW_KEY_D))
+		{
+			selected = 2;		// Right Triangle
+		}
 
-		// Top Triangle
-		if ((glfwGetKey(win, GLFW_KEY_W) == GLFW_PRESS))
+		// the animation only runs while rendering normally; the view moves while its keys are held
+		double panX = (input.isDown(GLFW_KEY_RIGHT) ? 1.0 : 0.0) - (input.isDown(GLFW_KEY_LEFT) ? 1.0 : 0.0);
+		double panY = (input.isDown(GLFW_KEY_UP) ? 1.0 : 0.0) - (input.isDown(GLFW_KEY_DOWN) ? 1.0 : 0.0);
+		double zoomIn = (input.isDown(GLFW_KEY_EQUAL) ? 1.0 : 0.0) - (input.isDown(GLFW_KEY_MINUS) ? 1.0 : 0.0);
+		for (int step = 0; step < simSteps; step++)
 		{
-			for (int i = 0; i < numVAOs; i++)
+			prevAnimationTime = animationTime;
+			if (selected == -1 && blink == 1)
 			{
-				if (i == 0)
-				{
-					glUseProgram(*shaderProg[4]);					// use the white shader on the top triangle
-					glBindVertexArray(VAO[i]);
-					glDrawArrays(GL_TRIANGLES, 0, 3);
-					glBindVertexArray(0);
-
-				}
-				else
-				{
-					glUseProgram(*shaderProg[triangleColors[i]]);	// and the correct shaders on the others
-					glBindVertexArray(VAO[i]);
-					glDrawArrays(GL_TRIANGLES, 0, 3);
-					glBindVertexArray(0);
-				}
+				animationTime += simClock.step();
 			}
+
+			// the view is 2 units across at zoom 1
+			prevView[0] = view[0];
+			prevView[1] = view[1];
+			prevView[2] = view[2];
+			view[0] += panX * PAN_RATE * 2.0 / view[2] * simClock.step();
+			view[1] += panY * PAN_RATE * 2.0 / view[2] * simClock.step();
+			view[2] = std::max(MIN_ZOOM, std::min(view[2] * pow(ZOOM_RATE, zoomIn * simClock.step()), MAX_ZOOM));
 		}
-		// If the Left Triangle is currently being selected
-		else if ((glfwGetKey(win, GLFW_KEY_A) == GLFW_PRESS))
+		frameTime = (float)(prevAnimationTime + (animationTime - prevAnimationTime) * simClock.alpha());
+		frameView[0] = (float)(prevView[0] + (view[0] - prevView[0]) * simClock.alpha());
+		frameView[1] = (float)(prevView[1] + (view[1] - prevView[1]) * simClock.alpha());
+		frameView[2] = (float)(prevView[2] + (view[2] - prevView[2]) * simClock.alpha());
+		frameView[3] = frameView[2];
+
+		// every program reads the animation time and the view from the frame's copy of the block
+		GLintptr frameBlockOffset = frameSlot * frameBlockStride;
+		state->bindBuffer(GL_UNIFORM_BUFFER, frameBlock);
+		glBindBufferRange(GL_UNIFORM_BUFFER, FRAME_BLOCK_BINDING, frameBlock, frameBlockOffset, frameBlockSize);
+		FrameBlockData blockData;
+		memset(&blockData, 0, sizeof(blockData));
+		blockData.animationTime = frameTime;
+		memcpy(blockData.view, frameView, sizeof(frameView));
+		if (memcmp(&blockData, &frameBlockCopies[frameSlot], sizeof(blockData)) != 0)
 		{
-			for (int i = 0; i < numVAOs; i++)
+			void* block = glMapBufferRange(GL_UNIFORM_BUFFER, frameBlockOffset, frameBlockSize,
+				GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT);
+			if (block != NULL)
 			{
-				if (i == 1)
-				{
-					glUseProgram(*shaderProg[4]);					// use the white shader on the left triangle
-					glBindVertexArray(VAO[i]);
-					glDrawArrays(GL_TRIANGLES, 0, 3);
-					glBindVertexArray(0);
+				memcpy(block, &blockData, sizeof(blockData));
+				glUnmapBuffer(GL_UNIFORM_BUFFER);
+				frameBlockCopies[frameSlot] = blockData;
+			}
+		}
 
-				}
-				else
-				{
-					glUseProgram(*shaderProg[triangleColors[i]]);	// and the correct shaders on the others
-					glBindVertexArray(VAO[i]);
-					glDrawArrays(GL_TRIANGLES, 0, 3);
-					glBindVertexArray(0);
-				}
+		unsigned int program = *shaderProg;
+		updateShapeTable(&shapeTable, numShapes, triangleColors, selected, currentTriangle, prevTriangle, options.variedPulse, state);
+		cullShapes(&cull, shapes, bounds, levels, shapeTable.chunkShapes, frameView, program, frameSlot, options, state, &gpuProfiler);
+		FrameDraws draws = drawShapes(&recording, &cull, shapeTable, shapes, bounds, levels, program, polygonMode, options.lodPixels, state, &gpuProfiler);
+
+		if (resolution.enabled())
+		{
+			gpuProfiler.beginScope("upscale");
+			resolution.endFrame(state);
+			gpuProfiler.endScope();
+		}
+
+		// start reading the finished frame back; it is written out frames later
+		if (loaded && capture.isOpen())
+		{
+			gpuProfiler.beginScope("capture");
+			capture.capture();
+			gpuProfiler.endScope();
+		}
+		GLStateStats stateStats = state->endFrame();
+
+		if (timeValue - lastReport >= 1.0)
+		{
+			reportFrame(win, pollEvents, windowEvents, draws, numShapes, stateStats, gpuProfiler, framesInFlight, resolution);
+			lastReport = timeValue;
+		}
+
+		double cpuMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - frameStart).count();
+		if (loaded)
+		{
+			counts.cpuTotalMs += cpuMs;
+			counts.cpuMaxMs = std::max(counts.cpuMaxMs, cpuMs);
+		}
+		FramePacingStats pacing = framesInFlight.stats();
+		if (statsFile.is_open() && loaded)
+		{
+			statsFile << counts.loadedFrames << "," << sessionTime * 1000.0 << "," << cpuMs << ","
+				<< draws.stats.draws << "," << draws.stats.programBinds << "," << draws.stats.vaoBinds << ","
+				<< draws.stats.bindsAvoided << "," << stateStats.issued << "," << stateStats.filtered << "," << frameTime << ","
+				<< pacing.waitedMs - lastWaitedMs << "," << pacing.lastLatencyMs << "," << resolution.stats().scale << "," << draws.visible << ","
+				<< draws.triangles << "," << draws.levelChanges << "," << draws.stats.batched << "\n";
+		}
+		lastWaitedMs = pacing.waitedMs;
+
+		// frames only count towards the limit once nothing is left to stream in
+		if (loaded)
+		{
+			counts.loadedFrames++;
+		}
+
+		// check and call events and swap the buffers
+		//---------------------------------
+		gpuProfiler.beginScope("swap");
+		if (win != NULL)
+		{
+			PROFILE_ZONE("swap");
+			glfwSwapBuffers(win);
+			if (pollEvents)
+			{
+				glfwPollEvents();
 			}
 		}
-		// Right Triangle
-		else if ((glfwGetKey(win, GLFW_KEY_D) == GLFW_PRESS))
+		else
+		{
+			glFlush();		// nothing swaps an offscreen frame; send it to the GPU as a swap would
+		}
+		gpuProfiler.endScope();
+		gpuProfiler.endFrame();
+		framesInFlight.endFrame(sampleTime, keyInput, keyTime);
+
+		// on demand, sleep until the next frame would differ from this one
+		//---------------------------------
+		bool animating = (blink == 1 && selected == -1) || panX != 0.0 || panY != 0.0 || zoomIn != 0.0;
+		if (onDemand && loaded && !animating)
 		{
-			for (int i = 0; i < numVAOs; i++)
+			PROFILE_ZONE("idle");
+			framesInFlight.finish();		// the frames are seen to finish now rather than after the sleep
+			std::chrono::steady_clock::time_point idleStart = std::chrono::steady_clock::now();
+			while (!windowEventsPending(windowEvents) && !glfwWindowShouldClose(win))
 			{
-				if (i == 2)
-				{
-					glUseProgram(*shaderProg[4]);					// use the white shader on the right triangle
-					glBindVertexArray(VAO[i]);
-					glDrawArrays(GL_TRIANGLES, 0, 3);
-					glBindVertexArray(0);
+				glfwWaitEventsTimeout(ON_DEMAND_WAIT);
+				counts.idleWaits++;
+			}
+			std::chrono::steady_clock::time_point idleEnd = std::chrono::steady_clock::now();
+			counts.idleSeconds += std::chrono::duration<double>(idleEnd - idleStart).count();
 
-				}
-				else
-				{
-					glUseProgram(*shaderProg[triangleColors[i]]);	// and the correct shaders on the others
-					glBindVertexArray(VAO[i]);
-					glDrawArrays(GL_TRIANGLES, 0, 3);
-					glBindVertexArray(0);
-				}
+			// nothing moved while idle, so the simulation does not catch up on it
+			lastFrameTime = std::chrono::duration<double>(idleEnd - startTime).count();
+		}
+
+		// hold the next frame back until the frame rate cap allows it
+		limiter.wait();
+
+		// a replay stops when the recorded session did
+		if (player.isOpen() && loaded && player.finished(sessionTime))
+		{
+			break;
+		}
+	}
+	recorder.close(sessionTime);
+	if (pollEvents)
+	{
+		glfwSetKeyCallback(win, NULL);
+		glfwSetWindowUserPointer(win, NULL);
+	}
+	reportRun(win, options, counts, loadedTime, onDemand, &capture, framesInFlight, resolution, gpuProfiler);
+
+	gpuProfiler.release();
+	resolution.release();
+	cull.gpuCuller.release();
+	framesInFlight.release();
+	state->deleteBuffers(1, &frameBlock);
+	releaseShapeTable(&shapeTable, state);
+}
+
+//-------------------------------------------------------------------
+//	renders several windows at once, each on its own thread and in
+//	its own context. Loading finishes first in the current context
+//	(the first window's), whose shader programs and buffers every
+//	other context shares; VAOs are not shared, so those contexts
+//	build their own from the layouts. GLFW only delivers events on
+//	the main thread, so this thread runs them for every window and
+//	passes them on through each window's WindowEvents
+//
+//	@param:		windows		the windows, all sharing the first one's
+//							objects
+//	@param:		shaderProg	the shader program's reference ID
+//	@param:		shapes		the draw range of each shape, with the
+//							first window's VAOs
+//	@param:		bounds		the xy bounds of each shape
+//	@param:		levels		every level of subdivision of each shape
+//	@param:		layouts		buffers and format of each of those VAOs
+//	@param:		loader		the loader of the scene
+//	@param:		uploader	the upload layer the scene was loaded with
+//	@param:		options		how render runs; only the first window
+//							records input, captures or writes files
+//-------------------------------------------------------------------
+void renderWindows(const std::vector<GLFWwindow*>& windows, const unsigned int* shaderProg, const std::vector<DrawRange>& shapes,
+	const std::vector<Bounds2D>& bounds, const ShapeLevels& levels, const std::vector<VertexLayout>& layouts, AssetLoader* loader, BufferUploader* uploader, const RenderOptions& options)
+{
+	// objects are only complete for other contexts once the commands
+	// that made them have finished
+	//---------------------------------
+	{
+		PROFILE_ZONE("load shared scene");
+		while (!loader->settled())
+		{
+			if (loader->pumpUploads(UPLOAD_BUDGET_MS) == 0)
+			{
+				std::this_thread::sleep_for(std::chrono::milliseconds(1));
 			}
+			uploader->flush();
+			uploader->endFrame();
 		}
-		// No triangle currently being selected; Render normally
-		else
+		glFinish();
+	}
+	glfwMakeContextCurrent(NULL);		// the first window's thread takes its context over
+
+	// each window gets its events and a copy of the options; files
+	// would collide, so only the first window writes any
+	//---------------------------------
+	int count = (int)windows.size();
+	std::vector<std::unique_ptr<WindowEvents> > events(count);
+	std::vector<RenderOptions> windowOptions(count, options);
+	bool replaying = (options.replayPath != NULL || options.replayEvents != NULL);
+	for (int i = 0; i < count; i++)
+	{
+		events[i].reset(new WindowEvents);
+		glfwSetWindowUserPointer(windows[i], events[i].get());
+		if (!replaying)
+		{
+			glfwSetKeyCallback(windows[i], key_callback);
+		}
+
+		windowOptions[i].windowEvents = events[i].get();
+		if (i > 0)
 		{
-			// determine current color saturation
-			//---------------------------------
-			int vertexSatLocation = -1;												// initialize vertexSatLocation
+			windowOptions[i].tracePath = NULL;
+			windowOptions[i].recordPath = NULL;
+			windowOptions[i].statsPath = NULL;
+			windowOptions[i].capturePath = NULL;
+		}
+	}
+
+	// a render thread per window
+	//---------------------------------
+	std::vector<std::thread> threads;
+	for (int i = 0; i < count; i++)
+	{
+		threads.push_back(std::thread([&, i]()
+		{
+			PROFILE_THREAD("render window");
+			glfwMakeContextCurrent(windows[i]);
 
-			// change saturation
-			if (blink == 1)
+			std::vector<DrawRange> windowShapes = shapes;
+			std::vector<unsigned int> windowVAOs;
+			if (i > 0)
 			{
-				float timeValue = glfwGetTime();									// used to create saturation change
-				satValue = (sin((1.5 * timeValue) + satValue) / 2.0) + 0.5f;		// rate of saturation change
+				shareVertexArrays(layouts, &windowShapes, &windowVAOs);
+			}
+			BufferUploader windowUploader;		// everything is uploaded; keeps each thread's upload counters apart
 
-				for (int i = 0; i < numVAOs; i++)
-				{
-					glUseProgram(*shaderProg[triangleColors[i]]);					// determine which shader program to draw with
-					vertexSatLocation = glGetUniformLocation(*shaderProg[triangleColors[i]], "saturation");
-					glUniform1f(vertexSatLocation, satValue);
-					glBindVertexArray(VAO[i]);
-					glDrawArrays(GL_TRIANGLES, 0, 3);
-					glBindVertexArray(0);
-				}
+			render(windows[i], shaderProg, &windowShapes, bounds, levels, loader, &windowUploader, windowOptions[i]);
+
+			if (!windowVAOs.empty())
+			{
+				currentGLState()->deleteVertexArrays((GLsizei)windowVAOs.size(), &windowVAOs[0]);
 			}
-			else // (blink != 1) - dont change saturation
+			windowUploader.release();
+			glfwMakeContextCurrent(NULL);
+
 			{
-				for (int i = 0; i < numVAOs; i++)
-				{
-					glUseProgram(*shaderProg[triangleColors[i]]);					// determine which shader program to draw with
-					vertexSatLocation = glGetUniformLocation(*shaderProg[triangleColors[i]], "saturation");
-					glUniform1f(vertexSatLocation, satValue);
-					glBindVertexArray(VAO[i]);
-					glDrawArrays(GL_TRIANGLES, 0, 3);
-					glBindVertexArray(0);
-				}
+				std::lock_guard<std::mutex> lock(events[i]->lock);
+				events[i]->finished = true;
+			}
+			glfwPostEmptyEvent();
+		}));
+	}
+
+	// run every window's events until all of them have stopped; a
+	// window whose thread is done is hidden
+	//---------------------------------
+	std::vector<bool> hidden(count, false);
+	int running = count;
+	while (running > 0)
+	{
+		glfwWaitEvents();
+		running = 0;
+		for (int i = 0; i < count; i++)
+		{
+			std::lock_guard<std::mutex> lock(events[i]->lock);
+			if (events[i]->titleChanged)
+			{
+				glfwSetWindowTitle(windows[i], events[i]->title.c_str());
+				events[i]->titleChanged = false;
+			}
+			if (!events[i]->finished)
+			{
+				running++;
+			}
+			else if (!hidden[i])
+			{
+				glfwHideWindow(windows[i]);
+				hidden[i] = true;
 			}
 		}
-		
-		// check and call events and swap the buffers
-		//---------------------------------
-		glfwSwapBuffers(win);
-		glfwPollEvents();
 	}
+
+	for (int i = 0; i < count; i++)
+	{
+		threads[i].join();
+		glfwSetKeyCallback(windows[i], NULL);
+		glfwSetWindowUserPointer(windows[i], NULL);
+	}
+
+	// the shared objects are freed in the context that made them
+	glfwMakeContextCurrent(windows[0]);
+	currentGLState()->invalidate();		// the first window's thread changed the context's state
+}
+
+//-------------------------------------------------------------------
+//	the colors of shaders/fragmentShader.fs.txt, as the software
+//	rasterizer runs them; indexed by a shape record's color, with
+//	the selected shape's white last
+//-------------------------------------------------------------------
+struct SoftwareShader
+{
+	float	color[3];		// constant color of the fragments
+	bool	vertexColor;	// use the interpolated vertex color instead
+	bool	saturated;		// the color is scaled by the shape's saturation
+};
+
+static const SoftwareShader SOFTWARE_SHADERS[5] =
+{
+	{ { 0.0f, 0.0f, 1.0f }, false, true },		// 0: blue
+	{ { 1.0f, 1.0f, 0.0f }, false, true },		// 1: yellow
+	{ { 1.0f, 0.0f, 0.0f }, false, true },		// 2: red
+	{ { 1.0f, 1.0f, 1.0f }, true, true },		// 3: vertex color
+	{ { 1.0f, 1.0f, 1.0f }, false, false }		// 4: white, selected
+};
+
+//-------------------------------------------------------------------
+//	renders the scene on the CPU with no GL context, as render would
+//	draw it: the same mesh, with the same levels of detail, and the
+//	colors, selection, saturation and view that the same key presses
+//	give on the same fixed step clock (a replay's, 1 / 60 s a frame).
+//	The polygon mode is not drawn; every shape is filled
+//
+//	@param:		meshPath	a .tfm file to draw, NULL for the Triforce
+//	@param:		depth		levels of subdivision of the Triforce
+//	@param:		width		width of the image in pixels
+//	@param:		height		height of the image in pixels
+//	@param:		options		the input to replay; frameLimit frames are
+//							drawn, or the whole replay when it is 0.
+//							The last is saved to imagePath and the CPU
+//							profile to tracePath when they are set
+//	@return:	true if the scene could be loaded and drawn
+//-------------------------------------------------------------------
+bool renderSoftware(const char* meshPath, int depth, int width, int height, const RenderOptions& options)
+{
+	// the scene, straight from system memory
+	//---------------------------------
+	Mesh triforce;
+	MappedMesh mapped;
+	mapped.header = NULL;
+	const float* vertices = NULL;
+	const void* indices = NULL;
+	int indexBytes = 0;
+	std::vector<SubMesh> shapes;
+	std::vector<Bounds2D> bounds;
+	ShapeLevels levels;
+	levels.count = 0;
+
+	if (meshPath != NULL)
+	{
+		if (!mapMeshFile(meshPath, &mapped))
+		{
+			return false;
+		}
+		const MeshFileHeader& header = *mapped.header;
+		if (header.vertexStride != FLOATS_PER_VERTEX * sizeof(float) || header.attributeCount < 2
+			|| header.attributes[0].offset != 0 || header.attributes[1].offset != 3 * sizeof(float))
+		{
+			std::cout << "ERROR::SOFTWARE::UNSUPPORTED_VERTEX_LAYOUT " << meshPath << std::endl;
+			unmapMeshFile(&mapped);
+			return false;
+		}
+		vertices = (const float*)mapped.vertices;
+		indices = mapped.indices;
+		indexBytes = (int)header.indexSize;
+		shapes.assign(mapped.shapes, mapped.shapes + header.shapeCount);
+	}
+	else
+	{
+		bool buildLevels = (options.lodPixels > 0.0 && depth > 0);
+		triforce = makeSceneMesh(options.fieldCount, depth, buildLevels ? &levels : NULL);
+		vertices = &triforce.vertices[0];
+		indices = &triforce.indices[0];
+		indexBytes = sizeof(unsigned int);
+		shapes = triforce.shapes;
+		shapeBounds(vertices, FLOATS_PER_VERTEX * (int)sizeof(float), indices, indexBytes, &shapes[0], (int)shapes.size(), &bounds);
+	}
+	int numShapes = (int)shapes.size();
+	bool lod = (levels.count > 0 && (int)levels.ranges.size() == numShapes * levels.count);
+	std::vector<int> shapeLevels(numShapes, -1);
+
+	// the state input changes, kept as render keeps it
+	//---------------------------------
+	InputQueue input;
+	InputPlayer player;
+	if (options.replayPath != NULL && !player.open(options.replayPath))
+	{
+		if (mapped.header != NULL)
+		{
+			unmapMeshFile(&mapped);
+		}
+		return false;
+	}
+	if (options.replayEvents != NULL)
+	{
+		player.load(*options.replayEvents);
+	}
+	int currentFrag = 0;
+	int currentTriangle = 0;
+	int blink = 0;
+	GLenum polygonMode = GL_FILL;
+	std::vector<int> triangleColors(std::max(numShapes, 3));		// the keys color the first three however many shapes there are
+	for (int i = 0; i < (int)triangleColors.size(); i++)
+	{
+		triangleColors[i] = i % 3;		// colors	 (0 = Blue,	1 = Yellow, 2 = Red)
+	}
+	SimulationClock simClock(SIMULATION_STEP);
+	double animationTime = 0.0;
+	double prevAnimationTime = 0.0;
+	double view[3] = { 0.0, 0.0, 1.0 };
+	double prevView[3] = { 0.0, 0.0, 1.0 };
+
+	// every shape pulses with the default animation, or its own as the
+	// vertex shader gives it with --varied-pulse
+	//---------------------------------
+	std::vector<ShapeAnimation> animations;
+	if (options.variedPulse)
+	{
+		variedAnimations(numShapes, &animations);
+	}
+	else
+	{
+		animations.assign(numShapes, defaultAnimation());
+	}
+
+	// draw the frames
+	//---------------------------------
+	ThreadPool pool(0);
+	SoftwareRasterizer rasterizer(width, height, &pool);
+	RasterStats stats;
+	memset(&stats, 0, sizeof(stats));
+
+	int frame = 0;
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	while (options.frameLimit <= 0 ? player.isOpen() : frame < options.frameLimit)
+	{
+		PROFILE_ZONE("frame");
+		double sessionTime = frame * REPLAY_FRAME_TIME;
+		int simSteps = simClock.advance(REPLAY_FRAME_TIME);
+		if (player.isOpen())
+		{
+			player.play(sessionTime, &input);
+		}
+		processInput(NULL, input, &currentFrag, &currentTriangle, &blink, &polygonMode, &triangleColors);
+		input.clearEvents();
+
+		int selected = input.isDown(GLFW_KEY_W) ? 0 : input.isDown(GLFW_KEY_A) ? 1 : input.isDown(GLFW_KEY_D) ? 2 : -1;
+		double panX = (input.isDown(GLFW_KEY_RIGHT) ? 1.0 : 0.0) - (input.isDown(GLFW_KEY_LEFT) ? 1.0 : 0.0);
+		double panY = (input.isDown(GLFW_KEY_UP) ? 1.0 : 0.0) - (input.isDown(GLFW_KEY_DOWN) ? 1.0 : 0.0);
+		double zoomIn = (input.isDown(GLFW_KEY_EQUAL) ? 1.0 : 0.0) - (input.isDown(GLFW_KEY_MINUS) ? 1.0 : 0.0);
+		for (int step = 0; step < simSteps; step++)
+		{
+			prevAnimationTime = animationTime;
+			if (selected == -1 && blink == 1)
+			{
+				animationTime += simClock.step();
+			}
+
+			prevView[0] = view[0];
+			prevView[1] = view[1];
+			prevView[2] = view[2];
+			view[0] += panX * PAN_RATE * 2.0 / view[2] * simClock.step();
+			view[1] += panY * PAN_RATE * 2.0 / view[2] * simClock.step();
+			view[2] = std::max(MIN_ZOOM, std::min(view[2] * pow(ZOOM_RATE, zoomIn * simClock.step()), MAX_ZOOM));
+		}
+		float frameTime = (float)(prevAnimationTime + (animationTime - prevAnimationTime) * simClock.alpha());
+		float frameView[4];
+		frameView[0] = (float)(prevView[0] + (view[0] - prevView[0]) * simClock.alpha());
+		frameView[1] = (float)(prevView[1] + (view[1] - prevView[1]) * simClock.alpha());
+		frameView[2] = (float)(prevView[2] + (view[2] - prevView[2]) * simClock.alpha());
+		frameView[3] = frameView[2];
+		double pixelsX = 0.5 * width * frameView[2];
+		double pixelsY = 0.5 * height * frameView[3];
+
+		rasterizer.clear(0.0f, 0.0f, 0.0f, 0.0f);
+		for (int i = 0; i < numShapes; i++)
+		{
+			const SoftwareShader& shader = SOFTWARE_SHADERS[(i == selected) ? 4 : triangleColors[i]];
+			const ShapeAnimation& pulse = animations[i];
+			float satValue = 0.5f + 0.5f * pulse.amplitude * sinf(pulse.phase + pulse.frequency * frameTime);
+
+			RasterDraw draw;
+			draw.vertices = vertices;
+			draw.indices = indices;
+			draw.indexSize = indexBytes;
+			draw.first = (int)shapes[i].firstIndex;
+			draw.count = (int)shapes[i].indexCount;
+			memcpy(draw.color, shader.color, sizeof(draw.color));
+			draw.vertexColor = shader.vertexColor;
+			draw.saturation = shader.saturated ? satValue : 1.0f;
+			memcpy(draw.view, frameView, sizeof(draw.view));
+
+			// a shape's level only changes while it is in view, as render only chooses levels for the shapes it draws
+			if (lod && bounds[i].minX <= frameView[0] + 1.0f / frameView[2] && frameView[0] - 1.0f / frameView[2] <= bounds[i].maxX
+				&& bounds[i].minY <= frameView[1] + 1.0f / frameView[3] && frameView[1] - 1.0f / frameView[3] <= bounds[i].maxY)
+			{
+				double pixels = std::max((bounds[i].maxX - bounds[i].minX) * pixelsX, (bounds[i].maxY - bounds[i].minY) * pixelsY);
+				shapeLevels[i] = chooseLevel(pixels, options.lodPixels, levels.count, shapeLevels[i]);
+				const SubMesh& range = levels.ranges[i * levels.count + shapeLevels[i]];
+				draw.first = (int)range.firstIndex;
+				draw.count = (int)range.indexCount;
+			}
+			rasterizer.draw(draw);
+		}
+		stats = rasterizer.finish();
+		frame++;
+
+		// a replay stops when the recorded session did
+		if (player.isOpen() && player.finished(sessionTime))
+		{
+			break;
+		}
+	}
+	double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+	std::cout << "SOFTWARE::FRAMES " << frame << " in " << ms << " ms (" << ms / (frame > 0 ? frame : 1)
+		<< " ms per frame), " << stats.triangles << " triangles in " << stats.binned << " tile bins over " << stats.tiles
+		<< " tiles on " << pool.threadCount() << " threads" << std::endl;
+
+	if (options.imagePath != NULL && frame > 0)
+	{
+		std::vector<unsigned char> image;
+		rasterizer.readPixels(&image);
+		writeImage(options.imagePath, width, height, &image[0]);
+	}
+	if (options.tracePath != NULL)
+	{
+		writeCpuTrace(options.tracePath);
+	}
+
+	if (mapped.header != NULL)
+	{
+		unmapMeshFile(&mapped);
+	}
+	return true;
 }
 
 //-------------------------------------------------------------------
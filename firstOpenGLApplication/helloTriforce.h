@@ -17,7 +17,37 @@
 #include <fstream>
 #include <sstream>
 #include <iostream>
+#include <algorithm>
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <chrono>
+#include <mutex>
+#include <thread>
 #include "dynamicArray.c"
+#include "mesh.h"
+#include "triforce.h"
+#include "meshFile.h"
+#include "assetLoader.h"
+#include "bufferUpload.h"
+#include "renderQueue.h"
+#include "commandBuffer.h"
+#include "threadPool.h"
+#include "headless.h"
+#include "gpuProfiler.h"
+#include "cpuProfiler.h"
+#include "frameTiming.h"
+#include "framesInFlight.h"
+#include "dynamicResolution.h"
+#include "spatialGrid.h"
+#include "gpuCulling.h"
+#include "input.h"
+#include "glState.h"
+#include "softwareRasterizer.h"
+#include "image.h"
+#include "frameCapture.h"
+#include "scene.h"
+#include "regression.h"
 
 // GLAD
 //---------------------------------
@@ -26,17 +56,54 @@ void initGLAD();																				// initialize GLAD to manage function pointe
 // WINDOW
 //---------------------------------
 void initWindow();																				// initializes GLFW Window
-GLFWwindow* makeWindow(int width, int height, char* name);										// create window object
+GLFWwindow* makeWindow(int width, int height, const char* name, GLFWwindow* share);				// create window object
 void framebuffer_size_callback(GLFWwindow* window, int width, int height);						// handles window resizing
+void key_callback(GLFWwindow* window, int key, int scancode, int action, int mods);				// queues key presses/releases
+void window_refresh_callback(GLFWwindow* window);												// asks for a redraw when the window is damaged
+
+// what the window callbacks hand to render; the window's user pointer while rendering. The callbacks
+// run on the main thread, which is not render's when several windows are rendered at once
+//---------------------------------
+struct WindowEvents
+{
+	std::mutex		lock;			// guards the rest
+	InputQueue		keys;			// key presses/releases render has not taken yet
+	std::chrono::steady_clock::time_point	keyTime;	// when the oldest of keys arrived
+	bool			redraw;			// set when the window was resized or damaged; render clears it
+	bool			resized;		// set with width and height when the framebuffer changed size
+	int				width;
+	int				height;
+	std::string		title;			// title render wants, set by the main thread when titleChanged
+	bool			titleChanged;
+	bool			finished;		// render has returned
+
+	WindowEvents() : redraw(false), resized(false), width(0), height(0), titleChanged(false), finished(false) {}
+};
+
+// ANIMATION
+//---------------------------------
+ShapeAnimation defaultAnimation();																// how shapes pulse unless given their own
+void variedAnimations(int count, std::vector<ShapeAnimation>* out);								// a different animation for each shape
+
+// SCENE
+//---------------------------------
+Mesh makeSceneMesh(int fieldCount, int depth, ShapeLevels* levels);							// the Triforce or a field of them, with every level when levels is given
 
 // VAOs
 //---------------------------------
-unsigned int ** makeVAOs(DynArr* trash, int numVAOs);											// creates VAOs
+void makeVAOs(unsigned int* VAOs, int numVAOs, BufferUploader* uploader, std::vector<VertexLayout>* layouts);	// creates VAOs
+void makeIndexedVAO(const Mesh& mesh, DrawRange* shapes, const unsigned int* shapeIds, BufferUploader* uploader, std::vector<VertexLayout>* layouts);	// uploads an indexed mesh into one VAO
+void makeMappedVAO(const MappedMesh& mesh, DrawRange* shapes, const unsigned int* shapeIds, BufferUploader* uploader, std::vector<VertexLayout>* layouts);	// uploads a mapped mesh file into one VAO
+VertexLayout positionColorLayout(unsigned int VBO, unsigned int EBO);							// the layout of position + color vertices
+unsigned int makeVertexArray(const VertexLayout& layout);										// builds a VAO in the current context
+void shareVertexArrays(const std::vector<VertexLayout>& layouts, std::vector<DrawRange>* shapes, std::vector<unsigned int>* made);	// rebuilds shapes' VAOs in the current context
 
 // RENDERING
 //---------------------------------
-void processInput(GLFWwindow *window, int * fPtr, int *tPtr, int *bPtr);						// processes when keys are pressed/released and responds
-void render(GLFWwindow* win, unsigned int * shaderProg[], unsigned int* VAO, int numVAOs);		// render loop
+void processInput(GLFWwindow *window, const InputQueue& input, int * fPtr, int *tPtr, int *bPtr, GLenum *pPtr, std::vector<int>* colors);	// processes when keys are pressed/released and responds
+void render(GLFWwindow* win, const unsigned int* shaderProg, std::vector<DrawRange>* shapeList, const std::vector<Bounds2D>& bounds, const ShapeLevels& levels, AssetLoader* loader, BufferUploader* uploader, const RenderOptions& options);	// render loop
+void renderWindows(const std::vector<GLFWwindow*>& windows, const unsigned int* shaderProg, const std::vector<DrawRange>& shapes, const std::vector<Bounds2D>& bounds, const ShapeLevels& levels, const std::vector<VertexLayout>& layouts, AssetLoader* loader, BufferUploader* uploader, const RenderOptions& options);	// renders several windows, a thread each
+bool renderSoftware(const char* meshPath, int depth, int width, int height, const RenderOptions& options);	// renders on the CPU without GL
 
 //	GARBAGE COLLECTION
 //---------------------------------
@@ -0,0 +1,336 @@
+//************************************************************************************************************************
+//
+//	LearnOpenGL - image.cpp
+//
+//	Name:			Tucker Dane Walker
+//	Date:			August 2017
+//	Description:	Implementation for saving and loading rendered frames.
+//
+//***********************************************************************************************************************/
+
+#include "image.h"
+
+#include <stdint.h>
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <string>
+
+//-------------------------------------------------------------------
+//	writes a frame as a binary PPM file
+//
+//	@param:		path		the file to create
+//	@param:		width		width of the frame in pixels
+//	@param:		height		height of the frame in pixels
+//	@param:		rgba		width * height RGBA8 pixels, bottom row first
+//	@return:	true if the whole file was written
+//-------------------------------------------------------------------
+bool writeImage(const char* path, int width, int height, const unsigned char* rgba)
+{
+	std::ofstream file(path, std::ios::out | std::ios::binary | std::ios::trunc);
+	if (!file)
+	{
+		std::cout << "ERROR::IMAGE::COULD_NOT_CREATE " << path << std::endl;
+		return false;
+	}
+
+	file << "P6\n" << width << " " << height << "\n255\n";
+
+	// PPM stores the top row first
+	std::vector<unsigned char> row((size_t)width * 3);
+	for (int y = height - 1; y >= 0; y--)
+	{
+		const unsigned char* src = rgba + (size_t)y * width * 4;
+		for (int x = 0; x < width; x++)
+		{
+			row[x * 3 + 0] = src[x * 4 + 0];
+			row[x * 3 + 1] = src[x * 4 + 1];
+			row[x * 3 + 2] = src[x * 4 + 2];
+		}
+		file.write((const char*)&row[0], (std::streamsize)row.size());
+	}
+
+	if (!file)
+	{
+		std::cout << "ERROR::IMAGE::WRITE_FAILED " << path << std::endl;
+		return false;
+	}
+	return true;
+}
+
+// largest stored deflate block; PNG pixel data is split into blocks of at most this many bytes
+//---------------------------------
+static const size_t DEFLATE_STORED_BLOCK = 65535;
+
+// bytes the Adler-32 sums can take before they must be reduced, as in zlib
+//---------------------------------
+static const size_t ADLER_SPAN = 5552;
+
+// the CRC-32 tables used by PNG chunks; entries[k] advances the CRC of a byte
+// followed by k zero bytes, so four bytes can be folded in at once
+//---------------------------------
+struct CrcTable
+{
+	uint32_t	entries[4][256];
+
+	CrcTable()
+	{
+		for (uint32_t n = 0; n < 256; n++)
+		{
+			uint32_t c = n;
+			for (int k = 0; k < 8; k++)
+			{
+				c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+			}
+			entries[0][n] = c;
+		}
+		for (uint32_t n = 0; n < 256; n++)
+		{
+			for (int k = 1; k < 4; k++)
+			{
+				entries[k][n] = entries[0][entries[k - 1][n] & 0xFF] ^ (entries[k - 1][n] >> 8);
+			}
+		}
+	}
+
+	//-------------------------------------------------------------------
+	//	@param:		c			the running CRC, before its final inversion
+	//	@param:		bytes		the bytes to fold in
+	//	@param:		count		how many
+	//	@return:	the running CRC after them
+	//-------------------------------------------------------------------
+	uint32_t update(uint32_t c, const unsigned char* bytes, size_t count) const
+	{
+		size_t i = 0;
+		for (; i + 4 <= count; i += 4)
+		{
+			c ^= (uint32_t)bytes[i] | ((uint32_t)bytes[i + 1] << 8) | ((uint32_t)bytes[i + 2] << 16) | ((uint32_t)bytes[i + 3] << 24);
+			c = entries[3][c & 0xFF] ^ entries[2][(c >> 8) & 0xFF] ^ entries[1][(c >> 16) & 0xFF] ^ entries[0][c >> 24];
+		}
+		for (; i < count; i++)
+		{
+			c = entries[0][(c ^ bytes[i]) & 0xFF] ^ (c >> 8);
+		}
+		return c;
+	}
+};
+
+// a zlib stream of stored deflate blocks being built
+//---------------------------------
+struct StoredStream
+{
+	std::vector<unsigned char>*	out;			// receives the stream
+	size_t						remaining;		// bytes still to be added, so the last block can be flagged
+	size_t						blockLeft;		// room left in the open block
+	uint32_t					adlerA;			// running Adler-32 sums of the bytes added
+	uint32_t					adlerB;
+};
+
+//-------------------------------------------------------------------
+//	@param:		out			receives value as 4 big endian bytes
+//	@param:		value		the value to append
+//-------------------------------------------------------------------
+static void appendBigEndian(std::vector<unsigned char>* out, uint32_t value)
+{
+	out->push_back((unsigned char)(value >> 24));
+	out->push_back((unsigned char)(value >> 16));
+	out->push_back((unsigned char)(value >> 8));
+	out->push_back((unsigned char)value);
+}
+
+//-------------------------------------------------------------------
+//	adds bytes to a stored stream, opening a new block whenever the
+//	open one is full
+//
+//	@param:		stream		the stream being built
+//	@param:		bytes		the bytes to add
+//	@param:		count		how many; never more than remaining
+//-------------------------------------------------------------------
+static void appendStored(StoredStream* stream, const unsigned char* bytes, size_t count)
+{
+	std::vector<unsigned char>& out = *stream->out;
+	while (count > 0)
+	{
+		if (stream->blockLeft == 0)
+		{
+			size_t length = std::min(DEFLATE_STORED_BLOCK, stream->remaining);
+			out.push_back(length == stream->remaining ? 1 : 0);		// last block flag, stored block type
+			out.push_back((unsigned char)length);
+			out.push_back((unsigned char)(length >> 8));
+			out.push_back((unsigned char)~length);
+			out.push_back((unsigned char)(~length >> 8));
+			stream->blockLeft = length;
+		}
+
+		size_t n = std::min(count, stream->blockLeft);
+		out.insert(out.end(), bytes, bytes + n);
+
+		uint32_t a = stream->adlerA;
+		uint32_t b = stream->adlerB;
+		for (size_t done = 0; done < n; )
+		{
+			size_t span = std::min(ADLER_SPAN, n - done);
+			for (size_t i = done; i < done + span; i++)
+			{
+				a += bytes[i];
+				b += a;
+			}
+			a %= 65521;
+			b %= 65521;
+			done += span;
+		}
+		stream->adlerA = a;
+		stream->adlerB = b;
+
+		stream->blockLeft -= n;
+		stream->remaining -= n;
+		bytes += n;
+		count -= n;
+	}
+}
+
+//-------------------------------------------------------------------
+//	writes one PNG chunk: length, type, data and the CRC of the type
+//	and data
+//
+//	@param:		file		the PNG file being written
+//	@param:		type		four letter chunk type
+//	@param:		data		the chunk data
+//	@param:		size		bytes of data
+//-------------------------------------------------------------------
+static void writeChunk(std::ofstream& file, const char* type, const unsigned char* data, size_t size)
+{
+	static const CrcTable crc;
+
+	unsigned char length[4] = { (unsigned char)(size >> 24), (unsigned char)(size >> 16), (unsigned char)(size >> 8), (unsigned char)size };
+	file.write((const char*)length, 4);
+	file.write(type, 4);
+	file.write((const char*)data, (std::streamsize)size);
+
+	uint32_t c = crc.update(0xFFFFFFFFu, (const unsigned char*)type, 4);
+	c = crc.update(c, data, size) ^ 0xFFFFFFFFu;
+
+	unsigned char check[4] = { (unsigned char)(c >> 24), (unsigned char)(c >> 16), (unsigned char)(c >> 8), (unsigned char)c };
+	file.write((const char*)check, 4);
+}
+
+//-------------------------------------------------------------------
+//	writes a frame as a PNG file with 8 bit RGBA pixels; the pixel
+//	data is a zlib stream of stored (uncompressed) deflate blocks
+//
+//	@param:		path		the file to create
+//	@param:		width		width of the frame in pixels
+//	@param:		height		height of the frame in pixels
+//	@param:		rgba		width * height RGBA8 pixels, bottom row first
+//	@return:	true if the whole file was written
+//-------------------------------------------------------------------
+bool writePNG(const char* path, int width, int height, const unsigned char* rgba)
+{
+	std::ofstream file(path, std::ios::out | std::ios::binary | std::ios::trunc);
+	if (!file)
+	{
+		std::cout << "ERROR::IMAGE::COULD_NOT_CREATE " << path << std::endl;
+		return false;
+	}
+
+	static const unsigned char SIGNATURE[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+	file.write((const char*)SIGNATURE, sizeof(SIGNATURE));
+
+	// header: size, 8 bits per channel, RGBA, no interlacing
+	//---------------------------------
+	std::vector<unsigned char> header;
+	appendBigEndian(&header, (uint32_t)width);
+	appendBigEndian(&header, (uint32_t)height);
+	header.push_back(8);
+	header.push_back(6);
+	header.push_back(0);
+	header.push_back(0);
+	header.push_back(0);
+	writeChunk(file, "IHDR", &header[0], header.size());
+
+	// scanlines, top row first, each led by filter type 0 (none), in a
+	// zlib stream that ends with their Adler-32
+	//---------------------------------
+	size_t rowBytes = (size_t)width * 4;
+	size_t scanlineBytes = (rowBytes + 1) * height;
+	size_t blocks = (scanlineBytes + DEFLATE_STORED_BLOCK - 1) / DEFLATE_STORED_BLOCK;
+
+	std::vector<unsigned char> data;
+	data.reserve(scanlineBytes + blocks * 5 + 6);
+	data.push_back(0x78);
+	data.push_back(0x01);
+
+	StoredStream stream;
+	stream.out = &data;
+	stream.remaining = scanlineBytes;
+	stream.blockLeft = 0;
+	stream.adlerA = 1;
+	stream.adlerB = 0;
+
+	static const unsigned char FILTER_NONE = 0;
+	for (int y = height - 1; y >= 0; y--)
+	{
+		appendStored(&stream, &FILTER_NONE, 1);
+		appendStored(&stream, rgba + (size_t)y * rowBytes, rowBytes);
+	}
+	appendBigEndian(&data, (stream.adlerB << 16) | stream.adlerA);
+	writeChunk(file, "IDAT", &data[0], data.size());
+	writeChunk(file, "IEND", NULL, 0);
+
+	if (!file)
+	{
+		std::cout << "ERROR::IMAGE::WRITE_FAILED " << path << std::endl;
+		return false;
+	}
+	return true;
+}
+
+//-------------------------------------------------------------------
+//	reads a binary PPM file with 8 bit channels
+//
+//	@param:		path		the file to read
+//	@param:		width		receives the width in pixels
+//	@param:		height		receives the height in pixels
+//	@param:		rgba		receives width * height RGBA8 pixels, bottom
+//							row first; alpha is always 255
+//	@return:	true if the file was a PPM and was read completely
+//-------------------------------------------------------------------
+bool readImage(const char* path, int* width, int* height, std::vector<unsigned char>* rgba)
+{
+	std::ifstream file(path, std::ios::in | std::ios::binary);
+	if (!file)
+	{
+		std::cout << "ERROR::IMAGE::COULD_NOT_OPEN " << path << std::endl;
+		return false;
+	}
+
+	std::string magic;
+	int maxValue = 0;
+	file >> magic >> *width >> *height >> maxValue;
+	file.get();		// the single whitespace before the pixels
+	if (!file || magic != "P6" || maxValue != 255 || *width <= 0 || *height <= 0)
+	{
+		std::cout << "ERROR::IMAGE::NOT_A_PPM " << path << std::endl;
+		return false;
+	}
+
+	std::vector<unsigned char> row((size_t)*width * 3);
+	rgba->resize((size_t)*width * *height * 4);
+	for (int y = *height - 1; y >= 0; y--)
+	{
+		if (!file.read((char*)&row[0], (std::streamsize)row.size()))
+		{
+			std::cout << "ERROR::IMAGE::TRUNCATED " << path << std::endl;
+			return false;
+		}
+		unsigned char* dst = &(*rgba)[(size_t)y * *width * 4];
+		for (int x = 0; x < *width; x++)
+		{
+			dst[x * 4 + 0] = row[x * 3 + 0];
+			dst[x * 4 + 1] = row[x * 3 + 1];
+			dst[x * 4 + 2] = row[x * 3 + 2];
+			dst[x * 4 + 3] = 255;
+		}
+	}
+	return true;
+}
@@ -0,0 +1,26 @@
+//************************************************************************************************************************
+//
+//	LearnOpenGL - image.h
+//
+//	Name:			Tucker Dane Walker
+//	Date:			August 2017
+//	Description:	Specifications for saving and loading rendered frames. Images are RGBA8 with the bottom row
+//					first, as glReadPixels and the software rasterizer produce them, and are stored as binary PPM
+//					files (top row first, alpha dropped) that any image viewer opens. Frames can also be written
+//					as PNG files for tools that do not read PPM; these are stored without compression, which
+//					needs no zlib and keeps writing them cheap.
+//
+//***********************************************************************************************************************/
+
+#ifndef IMAGE_H
+#define IMAGE_H
+
+#include <vector>
+
+// SAVING AND LOADING
+//---------------------------------
+bool writeImage(const char* path, int width, int height, const unsigned char* rgba);			// writes a frame as a PPM file
+bool writePNG(const char* path, int width, int height, const unsigned char* rgba);				// writes a frame as an uncompressed PNG file
+bool readImage(const char* path, int* width, int* height, std::vector<unsigned char>* rgba);	// reads a PPM file written by writeImage
+
+#endif
@@ -0,0 +1,214 @@
+//************************************************************************************************************************
+//
+//	LearnOpenGL - input.cpp
+//
+//	Name:			Tucker Dane Walker
+//	Date:			August 2017
+//	Description:	Implementation for event driven, recordable keyboard input.
+//
+//***********************************************************************************************************************/
+
+#include "input.h"
+
+#include <iostream>
+
+//-------------------------------------------------------------------
+//	@param:		key			a GLFW key code
+//	@param:		pressed		true if the key went down
+//-------------------------------------------------------------------
+void InputQueue::keyEvent(int key, bool pressed)
+{
+	if (key < 0 || key >= MAX_KEYS || down[key] == pressed)
+	{
+		return;
+	}
+	down[key] = pressed;
+
+	KeyEvent event;
+	event.key = key;
+	event.pressed = pressed;
+	pending.push_back(event);
+}
+
+//-------------------------------------------------------------------
+//	@return:	the edges since the last clearEvents, oldest first
+//-------------------------------------------------------------------
+const std::vector<KeyEvent>& InputQueue::events() const
+{
+	return pending;
+}
+
+//-------------------------------------------------------------------
+//	forgets the edges once they have been handled
+//-------------------------------------------------------------------
+void InputQueue::clearEvents()
+{
+	pending.clear();
+}
+
+//-------------------------------------------------------------------
+//	@param:		key			a GLFW key code
+//	@return:	true if the key is held down
+//-------------------------------------------------------------------
+bool InputQueue::isDown(int key) const
+{
+	return key >= 0 && key < MAX_KEYS && down[key];
+}
+
+//-------------------------------------------------------------------
+//	@param:		path		the log to create
+//	@return:	true if the log is ready for events
+//-------------------------------------------------------------------
+bool InputRecorder::open(const char* path)
+{
+	file.open(path, std::ios::out | std::ios::binary | std::ios::trunc);
+	if (!file)
+	{
+		std::cout << "ERROR::INPUT::COULD_NOT_CREATE " << path << std::endl;
+		return false;
+	}
+
+	InputLogHeader header;
+	header.magic = INPUT_LOG_MAGIC;
+	header.version = INPUT_LOG_VERSION;
+	file.write((const char*)&header, sizeof(header));
+	return true;
+}
+
+//-------------------------------------------------------------------
+//	@param:		time		session time of the change in seconds
+//	@param:		key			the GLFW key code that changed
+//	@param:		pressed		true if it went down
+//-------------------------------------------------------------------
+void InputRecorder::record(double time, int key, bool pressed)
+{
+	if (!file.is_open())
+	{
+		return;
+	}
+
+	InputLogEvent event;
+	event.timeMs = (uint32_t)(time * 1000.0 + 0.5);
+	event.key = (uint16_t)key;
+	event.pressed = pressed ? 1 : 0;
+	event.reserved = 0;
+	file.write((const char*)&event, sizeof(event));
+}
+
+//-------------------------------------------------------------------
+//	ends the log; a replay runs until this time
+//
+//	@param:		time		session time the recording stopped at
+//-------------------------------------------------------------------
+void InputRecorder::close(double time)
+{
+	if (!file.is_open())
+	{
+		return;
+	}
+
+	record(time, INPUT_LOG_END, false);
+	file.close();
+}
+
+//-------------------------------------------------------------------
+//	@return:	true while events are being written
+//-------------------------------------------------------------------
+bool InputRecorder::isOpen() const
+{
+	return file.is_open();
+}
+
+//-------------------------------------------------------------------
+//	constructor
+//-------------------------------------------------------------------
+InputPlayer::InputPlayer()
+{
+	next = 0;
+	endMs = 0;
+	loaded = false;
+}
+
+//-------------------------------------------------------------------
+//	reads a whole log into memory
+//
+//	@param:		path		a log written by InputRecorder
+//	@return:	true if the log was read
+//-------------------------------------------------------------------
+bool InputPlayer::open(const char* path)
+{
+	std::ifstream file(path, std::ios::in | std::ios::binary);
+	InputLogHeader header;
+	if (!file || !file.read((char*)&header, sizeof(header)) || header.magic != INPUT_LOG_MAGIC
+		|| header.version != INPUT_LOG_VERSION)
+	{
+		std::cout << "ERROR::INPUT::NOT_AN_INPUT_LOG " << path << std::endl;
+		return false;
+	}
+
+	std::vector<InputLogEvent> log;
+	InputLogEvent event;
+	while (file.read((char*)&event, sizeof(event)))
+	{
+		log.push_back(event);
+	}
+	load(log);
+	return true;
+}
+
+//-------------------------------------------------------------------
+//	plays a session held in memory, e.g. a scripted one
+//
+//	@param:		log			key changes in time order, as they are
+//							stored in a log; an INPUT_LOG_END event
+//							ends the session, otherwise it ends with
+//							the last change
+//-------------------------------------------------------------------
+void InputPlayer::load(const std::vector<InputLogEvent>& log)
+{
+	events.clear();
+	endMs = 0;
+	for (size_t i = 0; i < log.size(); i++)
+	{
+		endMs = log[i].timeMs;
+		if (log[i].key == INPUT_LOG_END)
+		{
+			break;
+		}
+		events.push_back(log[i]);
+	}
+
+	next = 0;
+	loaded = true;
+}
+
+//-------------------------------------------------------------------
+//	@param:		time		session time reached, in seconds
+//	@param:		input		receives every change up to time
+//-------------------------------------------------------------------
+void InputPlayer::play(double time, InputQueue* input)
+{
+	uint32_t ms = (uint32_t)(time * 1000.0 + 0.5);
+	while (next < events.size() && events[next].timeMs <= ms)
+	{
+		input->keyEvent(events[next].key, events[next].pressed != 0);
+		next++;
+	}
+}
+
+//-------------------------------------------------------------------
+//	@param:		time		session time reached, in seconds
+//	@return:	true once the recorded session is over
+//-------------------------------------------------------------------
+bool InputPlayer::finished(double time) const
+{
+	return next >= events.size() && (uint32_t)(time * 1000.0 + 0.5) >= endMs;
+}
+
+//-------------------------------------------------------------------
+//	@return:	true if a log was read
+//-------------------------------------------------------------------
+bool InputPlayer::isOpen() const
+{
+	return loaded;
+}
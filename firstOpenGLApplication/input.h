@@ -0,0 +1,113 @@
+//************************************************************************************************************************
+//
+//	LearnOpenGL - input.h
+//
+//	Name:			Tucker Dane Walker
+//	Date:			August 2017
+//	Description:	Specifications for event driven keyboard input that can be recorded and replayed. Key
+//					presses and releases (from the window's key callback, or from a replayed log) go into an
+//					InputQueue, which keeps a bitset of the keys held and a queue of the edges since the last
+//					frame; the render loop acts once per edge. Live edges are written to a compact binary log
+//					with their time; replaying the log pushes the same edges at the same times, so a session
+//					can be repeated exactly as a benchmark.
+//
+//					log:	header, then one 8 byte event per key change, then an end event
+//
+//***********************************************************************************************************************/
+
+#ifndef INPUT_H
+#define INPUT_H
+
+#include <stdint.h>
+#include <bitset>
+#include <fstream>
+#include <vector>
+
+// key codes are GLFW key codes, all below this
+//---------------------------------
+const int MAX_KEYS = 512;
+
+// input log file format
+//---------------------------------
+const uint32_t INPUT_LOG_MAGIC = 0x474C4E49;		// "INLG"
+const uint32_t INPUT_LOG_VERSION = 1;
+const uint16_t INPUT_LOG_END = 0xFFFF;				// key of the event that marks the end of the session
+
+struct InputLogHeader
+{
+	uint32_t	magic;
+	uint32_t	version;
+};
+
+struct InputLogEvent
+{
+	uint32_t	timeMs;			// session time of the change in ms
+	uint16_t	key;			// GLFW key code, or INPUT_LOG_END
+	uint8_t		pressed;		// 1 when the key went down, 0 when it came up
+	uint8_t		reserved;
+};
+
+// one key going down or coming up
+//---------------------------------
+struct KeyEvent
+{
+	int		key;			// GLFW key code
+	bool	pressed;		// true when the key went down
+};
+
+// the keys held and the edges not yet handled
+//---------------------------------
+class InputQueue
+{
+public:
+	// called from the key callback or a replay; repeats of a key's state are ignored
+	//---------------------------------
+	void keyEvent(int key, bool pressed);
+
+	// once per frame: handle events(), then clearEvents()
+	//---------------------------------
+	const std::vector<KeyEvent>& events() const;
+	void clearEvents();
+
+	bool isDown(int key) const;
+
+private:
+	std::bitset<MAX_KEYS>	down;		// one bit per key, set while held
+	std::vector<KeyEvent>	pending;	// edges in the order they happened
+};
+
+// writes key changes to a log
+//---------------------------------
+class InputRecorder
+{
+public:
+	bool open(const char* path);
+	void record(double time, int key, bool pressed);
+	void close(double time);
+	bool isOpen() const;
+
+private:
+	std::ofstream	file;
+};
+
+// feeds a log back into an InputQueue
+//---------------------------------
+class InputPlayer
+{
+public:
+	InputPlayer();
+
+	bool open(const char* path);
+	void load(const std::vector<InputLogEvent>& log);
+	void play(double time, InputQueue* input);
+	bool finished(double time) const;
+	bool isOpen() const;
+
+private:
+	std::vector<InputLogEvent>	events;		// every key change in the log, in time order
+	size_t						next;		// first event not yet played
+	uint32_t					endMs;		// when the recorded session ended
+	bool						loaded;
+};
+
+#endif
@@ -0,0 +1,521 @@
+//************************************************************************************************************************
+//
+//	LearnOpenGL - mesh.cpp
+//
+//	Name:			Tucker Dane Walker
+//	Date:			August 2017
+//	Description:	Implementation for indexed triangle meshes: vertex deduplication, Sierpinski subdivision and
+//					post-transform vertex cache optimization (Tipsify).
+//
+//***********************************************************************************************************************/
+
+#include "mesh.h"
+
+#include <string.h>
+#include <assert.h>
+#include <float.h>
+#include <algorithm>
+#include <unordered_map>
+
+//-------------------------------------------------------------------
+//	hashing of whole vertices, used to find duplicates
+//-------------------------------------------------------------------
+struct VertexKey
+{
+	unsigned int bits[FLOATS_PER_VERTEX];	// raw bits of each float in the vertex
+
+	bool operator==(const VertexKey& other) const
+	{
+		return memcmp(bits, other.bits, sizeof(bits)) == 0;
+	}
+};
+
+struct VertexKeyHash
+{
+	size_t operator()(const VertexKey& key) const
+	{
+		// FNV-1a over the float bits
+		size_t h = 2166136261u;
+		for (int i = 0; i < FLOATS_PER_VERTEX; i++)
+		{
+			h = (h ^ key.bits[i]) * 16777619u;
+		}
+		return h;
+	}
+};
+
+//-------------------------------------------------------------------
+//	builds the hash key of a vertex
+//
+//	@param:		v		the FLOATS_PER_VERTEX floats of the vertex
+//	@return:	key		the bit pattern of the vertex, with -0.0
+//						folded into 0.0 so both hash the same
+//-------------------------------------------------------------------
+static VertexKey makeKey(const float* v)
+{
+	VertexKey key;
+	for (int i = 0; i < FLOATS_PER_VERTEX; i++)
+	{
+		float f = (v[i] == 0.0f) ? 0.0f : v[i];
+		memcpy(&key.bits[i], &f, sizeof(float));
+	}
+	return key;
+}
+
+//-------------------------------------------------------------------
+//	Sierpinski subdivision of a triangle
+//
+//	@param:		tri		the 3 vertices of the triangle
+//	@param:		depth	levels of subdivision; 0 copies the triangle
+//	@param:		out		receives 3^depth triangles as a triangle
+//						soup; midpoints interpolate every attribute
+//-------------------------------------------------------------------
+void subdivideTriangle(const float* tri, int depth, std::vector<float>* out)
+{
+	const float* a = tri;
+	const float* b = tri + FLOATS_PER_VERTEX;
+	const float* c = tri + 2 * FLOATS_PER_VERTEX;
+
+	if (depth <= 0)
+	{
+		out->insert(out->end(), tri, tri + 3 * FLOATS_PER_VERTEX);
+		return;
+	}
+
+	// midpoints of each edge
+	float ab[FLOATS_PER_VERTEX], bc[FLOATS_PER_VERTEX], ca[FLOATS_PER_VERTEX];
+	for (int i = 0; i < FLOATS_PER_VERTEX; i++)
+	{
+		ab[i] = (a[i] + b[i]) * 0.5f;
+		bc[i] = (b[i] + c[i]) * 0.5f;
+		ca[i] = (c[i] + a[i]) * 0.5f;
+	}
+
+	// the three corner triangles; the middle one is left out
+	float corner[3 * FLOATS_PER_VERTEX];
+	const float* corners[3][3] = {
+		{ a,  ab, ca },
+		{ ab, b,  bc },
+		{ ca, bc, c  }
+	};
+	for (int t = 0; t < 3; t++)
+	{
+		for (int v = 0; v < 3; v++)
+		{
+			memcpy(corner + v * FLOATS_PER_VERTEX, corners[t][v], FLOATS_PER_VERTEX * sizeof(float));
+		}
+		subdivideTriangle(corner, depth - 1, out);
+	}
+}
+
+//-------------------------------------------------------------------
+//	appends a triangle soup to the mesh as a new shape, storing each
+//	distinct vertex of the shape only once
+//
+//	@param:		mesh		the mesh to add to
+//	@param:		verts		numVerts interleaved vertices, 3 per triangle
+//	@param:		numVerts	number of vertices in verts
+//-------------------------------------------------------------------
+void addShape(Mesh* mesh, const float* verts, int numVerts)
+{
+	assert(numVerts % 3 == 0);
+
+	std::unordered_map<VertexKey, unsigned int, VertexKeyHash> seen;
+	seen.reserve(numVerts);
+
+	SubMesh shape;
+	shape.firstIndex = (unsigned int)mesh->indices.size();
+	shape.indexCount = (unsigned int)numVerts;
+
+	for (int i = 0; i < numVerts; i++)
+	{
+		const float* v = verts + i * FLOATS_PER_VERTEX;
+		unsigned int next = (unsigned int)vertexCount(*mesh);
+
+		// add the vertex only if this shape has not already used it
+		std::pair<std::unordered_map<VertexKey, unsigned int, VertexKeyHash>::iterator, bool> found =
+			seen.insert(std::make_pair(makeKey(v), next));
+		if (found.second)
+		{
+			mesh->vertices.insert(mesh->vertices.end(), v, v + FLOATS_PER_VERTEX);
+		}
+		mesh->indices.push_back(found.first->second);
+	}
+
+	mesh->shapes.push_back(shape);
+}
+
+//-------------------------------------------------------------------
+//	simulates a FIFO vertex cache over a run of indices
+//
+//	@param:		idx			the indices to walk
+//	@param:		count		number of indices
+//	@param:		numVerts	number of vertices the indices refer to
+//	@param:		cacheSize	number of entries in the simulated cache
+//	@return:	the number of cache misses (vertex shader runs)
+//-------------------------------------------------------------------
+static int cacheMisses(const unsigned int* idx, int count, int numVerts, int cacheSize)
+{
+	std::vector<int> cacheTime(numVerts, -cacheSize - 1);
+	int misses = 0;
+
+	for (int i = 0; i < count; i++)
+	{
+		unsigned int v = idx[i];
+		if (misses - cacheTime[v] > cacheSize)
+		{
+			cacheTime[v] = misses;
+			misses++;
+		}
+	}
+	return misses;
+}
+
+//-------------------------------------------------------------------
+//	picks the next fanning vertex for Tipsify
+//
+//	@param:		candidates	vertices of the triangles just emitted
+//	@param:		cacheTime	time each vertex last entered the cache
+//	@param:		stamp		current cache time
+//	@param:		live		number of unemitted triangles per vertex
+//	@param:		deadEnd		stack of recently used vertices
+//	@param:		cursor		scan position over the shape's vertices
+//	@param:		numVerts	number of vertices the shape uses
+//	@param:		cacheSize	size of the simulated cache
+//	@return:	the next vertex to fan around, or -1 when done
+//-------------------------------------------------------------------
+static int nextVertex(const std::vector<unsigned int>& candidates, const std::vector<int>& cacheTime, int stamp,
+	const std::vector<int>& live, std::vector<unsigned int>* deadEnd, int* cursor, int numVerts, int cacheSize)
+{
+	// prefer a candidate that will still be in the cache once its
+	// remaining triangles are emitted, and among those the oldest
+	int best = -1;
+	int bestPriority = 0;
+	for (size_t i = 0; i < candidates.size(); i++)
+	{
+		unsigned int v = candidates[i];
+		if (live[v] > 0)
+		{
+			int priority = 0;
+			if (stamp - cacheTime[v] + 2 * live[v] <= cacheSize)
+			{
+				priority = stamp - cacheTime[v];
+			}
+			if (priority > bestPriority)
+			{
+				bestPriority = priority;
+				best = (int)v;
+			}
+		}
+	}
+	if (best != -1)
+	{
+		return best;
+	}
+
+	// dead end: fall back to a recently used vertex with triangles left
+	while (!deadEnd->empty())
+	{
+		unsigned int v = deadEnd->back();
+		deadEnd->pop_back();
+		if (live[v] > 0)
+		{
+			return (int)v;
+		}
+	}
+
+	// otherwise continue the scan over the shape's vertices
+	while (*cursor < numVerts)
+	{
+		int v = (*cursor)++;
+		if (live[v] > 0)
+		{
+			return v;
+		}
+	}
+	return -1;
+}
+
+//-------------------------------------------------------------------
+//	reorders the triangles of every shape for post-transform vertex
+//	cache locality using Tipsify (Sander, Nehab & Barczak 2007). Each
+//	shape works on its own range of vertices, numbered from 0, so the
+//	cost follows the shape rather than the whole mesh
+//
+//	@param:		mesh		the mesh to optimize in place
+//	@param:		cacheSize	size of the vertex cache to target
+//-------------------------------------------------------------------
+void optimizeVertexCache(Mesh* mesh, int cacheSize)
+{
+	std::vector<unsigned int> idx;
+
+	for (size_t s = 0; s < mesh->shapes.size(); s++)
+	{
+		unsigned int* shapeIdx = &mesh->indices[0] + mesh->shapes[s].firstIndex;
+		int numTris = (int)mesh->shapes[s].indexCount / 3;
+		if (numTris < 2)
+		{
+			continue;
+		}
+
+		// the shape's vertices, numbered from its lowest
+		unsigned int first = *std::min_element(shapeIdx, shapeIdx + numTris * 3);
+		unsigned int last = *std::max_element(shapeIdx, shapeIdx + numTris * 3);
+		int numVerts = (int)(last - first) + 1;
+		idx.resize(numTris * 3);
+		for (int i = 0; i < numTris * 3; i++)
+		{
+			idx[i] = shapeIdx[i] - first;
+		}
+
+		// vertex -> triangle adjacency, as offsets into a flat list
+		std::vector<int> live(numVerts, 0);
+		std::vector<int> offsets(numVerts + 1, 0);
+		std::vector<int> adjacency(numTris * 3);
+		for (int i = 0; i < numTris * 3; i++)
+		{
+			live[idx[i]]++;
+		}
+		for (int v = 0; v < numVerts; v++)
+		{
+			offsets[v + 1] = offsets[v] + live[v];
+		}
+		std::vector<int> fill(offsets.begin(), offsets.end() - 1);
+		for (int i = 0; i < numTris * 3; i++)
+		{
+			adjacency[fill[idx[i]]++] = i / 3;
+		}
+
+		std::vector<int> cacheTime(numVerts, 0);
+		std::vector<bool> emitted(numTris, false);
+		std::vector<unsigned int> deadEnd;
+		std::vector<unsigned int> candidates;
+		std::vector<unsigned int> output;
+		output.reserve(numTris * 3);
+
+		int stamp = cacheSize + 1;
+		int cursor = 0;
+		int fan = (int)idx[0];
+
+		while (fan >= 0)
+		{
+			candidates.clear();
+
+			// emit every remaining triangle around the fanning vertex
+			for (int a = offsets[fan]; a < offsets[fan + 1]; a++)
+			{
+				int t = adjacency[a];
+				if (emitted[t])
+				{
+					continue;
+				}
+				for (int k = 0; k < 3; k++)
+				{
+					unsigned int v = idx[t * 3 + k];
+					output.push_back(v);
+					deadEnd.push_back(v);
+					candidates.push_back(v);
+					if (stamp - cacheTime[v] > cacheSize)
+					{
+						cacheTime[v] = stamp;
+						stamp++;
+					}
+					live[v]--;
+				}
+				emitted[t] = true;
+			}
+
+			fan = nextVertex(candidates, cacheTime, stamp, live, &deadEnd, &cursor, numVerts, cacheSize);
+		}
+
+		// keep whichever order misses the cache less; shapes that are
+		// already in a space-filling order (e.g. Sierpinski) can beat it
+		assert((int)output.size() == numTris * 3);
+		if (cacheMisses(&output[0], numTris * 3, numVerts, cacheSize) < cacheMisses(&idx[0], numTris * 3, numVerts, cacheSize))
+		{
+			for (int i = 0; i < numTris * 3; i++)
+			{
+				shapeIdx[i] = output[i] + first;
+			}
+		}
+	}
+}
+
+//-------------------------------------------------------------------
+//	renumbers vertices in the order the index buffer first uses them
+//	so vertex fetches walk memory forwards
+//
+//	@param:		mesh		the mesh to reorder in place
+//-------------------------------------------------------------------
+void optimizeVertexFetch(Mesh* mesh)
+{
+	int numVerts = vertexCount(*mesh);
+	std::vector<int> remap(numVerts, -1);
+	std::vector<float> reordered(mesh->vertices.size());
+	int next = 0;
+
+	for (size_t i = 0; i < mesh->indices.size(); i++)
+	{
+		unsigned int v = mesh->indices[i];
+		if (remap[v] == -1)
+		{
+			remap[v] = next;
+			memcpy(&reordered[next * FLOATS_PER_VERTEX], &mesh->vertices[v * FLOATS_PER_VERTEX], FLOATS_PER_VERTEX * sizeof(float));
+			next++;
+		}
+		mesh->indices[i] = (unsigned int)remap[v];
+	}
+
+	// unreferenced vertices are dropped
+	reordered.resize(next * FLOATS_PER_VERTEX);
+	mesh->vertices.swap(reordered);
+}
+
+//-------------------------------------------------------------------
+//	finds the rectangle each shape covers in the xy plane
+//
+//	@param:		positions	x and y of the first vertex; z is ignored
+//	@param:		stride		bytes from one vertex's position to the next
+//	@param:		indices		the index payload, 2 or 4 bytes per index;
+//							NULL when the shapes are not indexed and
+//							their ranges count vertices
+//	@param:		indexSize	bytes per index
+//	@param:		shapes		index range of each shape
+//	@param:		shapeCount	number of shapes
+//	@param:		out			receives the bounds of each shape
+//-------------------------------------------------------------------
+void shapeBounds(const float* positions, int stride, const void* indices, int indexSize, const SubMesh* shapes, int shapeCount,
+	std::vector<Bounds2D>* out)
+{
+	const unsigned char* base = (const unsigned char*)positions;
+	const unsigned short* indices16 = (const unsigned short*)indices;
+	const unsigned int* indices32 = (const unsigned int*)indices;
+	out->resize(shapeCount);
+
+	for (int s = 0; s < shapeCount; s++)
+	{
+		Bounds2D& bounds = (*out)[s];
+		bounds.minX = FLT_MAX;
+		bounds.minY = FLT_MAX;
+		bounds.maxX = -FLT_MAX;
+		bounds.maxY = -FLT_MAX;
+
+		unsigned int end = shapes[s].firstIndex + shapes[s].indexCount;
+		for (unsigned int i = shapes[s].firstIndex; i < end; i++)
+		{
+			unsigned int v = i;
+			if (indices != NULL)
+			{
+				v = (indexSize == 2) ? indices16[i] : indices32[i];
+			}
+			const float* position = (const float*)(base + (size_t)v * stride);
+			bounds.minX = std::min(bounds.minX, position[0]);
+			bounds.minY = std::min(bounds.minY, position[1]);
+			bounds.maxX = std::max(bounds.maxX, position[0]);
+			bounds.maxY = std::max(bounds.maxY, position[1]);
+		}
+	}
+}
+
+//-------------------------------------------------------------------
+//	builds the per vertex shape stream: each vertex gets the number of
+//	the shape whose indices use it, which the shaders look the shape's
+//	record up by. Shapes never share vertices (addShape), so no vertex
+//	is claimed by two of them
+//
+//	@param:		indices			the index payload, 2 or 4 bytes per index
+//	@param:		indexSize		bytes per index
+//	@param:		ranges			index ranges of the shapes
+//	@param:		rangeCount		number of ranges
+//	@param:		rangesPerShape	consecutive ranges that belong to one
+//								shape, such as its levels of subdivision
+//	@param:		numVerts		number of vertices the indices refer to
+//	@param:		out				receives a shape number per vertex;
+//								vertices no shape uses are 0
+//-------------------------------------------------------------------
+void shapeStream(const void* indices, int indexSize, const SubMesh* ranges, int rangeCount, int rangesPerShape, int numVerts,
+	std::vector<unsigned int>* out)
+{
+	out->assign(numVerts, 0);
+	const unsigned short* indices16 = (const unsigned short*)indices;
+	const unsigned int* indices32 = (const unsigned int*)indices;
+	for (int r = 0; r < rangeCount; r++)
+	{
+		unsigned int shape = (unsigned int)(r / rangesPerShape);
+		unsigned int end = ranges[r].firstIndex + ranges[r].indexCount;
+		for (unsigned int i = ranges[r].firstIndex; i < end; i++)
+		{
+			unsigned int v = (indexSize == 2) ? indices16[i] : indices32[i];
+			if ((int)v < numVerts)
+			{
+				(*out)[v] = shape;
+			}
+		}
+	}
+}
+
+//-------------------------------------------------------------------
+//	@param:		mesh		the mesh to query
+//	@return:	the number of unique vertices stored in the mesh
+//-------------------------------------------------------------------
+int vertexCount(const Mesh& mesh)
+{
+	return (int)(mesh.vertices.size() / FLOATS_PER_VERTEX);
+}
+
+//-------------------------------------------------------------------
+//	@param:		mesh		the mesh to query
+//	@return:	bytes per index; 2 when every vertex can be addressed
+//				with 16 bits, otherwise 4
+//-------------------------------------------------------------------
+int indexSize(const Mesh& mesh)
+{
+	return (vertexCount(mesh) <= 0xFFFF) ? 2 : 4;
+}
+
+//-------------------------------------------------------------------
+//	simulates a FIFO vertex cache over the index buffer
+//
+//	@param:		mesh		the mesh to measure
+//	@param:		cacheSize	number of entries in the simulated cache
+//	@return:	average cache misses (vertex shader runs) per
+//				triangle; 3.0 is unindexed, 0.5 is the ideal
+//-------------------------------------------------------------------
+float averageCacheMissRatio(const Mesh& mesh, int cacheSize)
+{
+	if (mesh.indices.empty())
+	{
+		return 0.0f;
+	}
+
+	int misses = cacheMisses(&mesh.indices[0], (int)mesh.indices.size(), vertexCount(mesh), cacheSize);
+	return (float)misses / (float)(mesh.indices.size() / 3);
+}
+
+//-------------------------------------------------------------------
+//	packs the indices for upload to an element buffer
+//
+//	@param:		mesh		the mesh whose indices are packed
+//	@param:		out			receives indexSize(mesh) bytes per index
+//-------------------------------------------------------------------
+void packIndices(const Mesh& mesh, std::vector<unsigned char>* out)
+{
+	int size = indexSize(mesh);
+	out->resize(mesh.indices.size() * size);
+
+	if (mesh.indices.empty())
+	{
+		return;
+	}
+	if (size == 4)
+	{
+		memcpy(&(*out)[0], &mesh.indices[0], out->size());
+		return;
+	}
+
+	unsigned short* dst = (unsigned short*)&(*out)[0];
+	for (size_t i = 0; i < mesh.indices.size(); i++)
+	{
+		dst[i] = (unsigned short)mesh.indices[i];
+	}
+}
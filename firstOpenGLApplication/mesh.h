@@ -0,0 +1,134 @@
+//************************************************************************************************************************
+//
+//	LearnOpenGL - mesh.h
+//
+//	Name:			Tucker Dane Walker
+//	Date:			August 2017
+//	Description:	Specifications for indexed triangle meshes: vertex deduplication, Sierpinski subdivision and
+//					post-transform vertex cache optimization (Tipsify). Contains no OpenGL calls.
+//
+//***********************************************************************************************************************/
+
+#ifndef MESH_H
+#define MESH_H
+
+#include <vector>
+
+// every vertex in the project is a position (x, y, z) followed by a color (r, g, b)
+//---------------------------------
+const int FLOATS_PER_VERTEX = 6;
+
+// size of the post-transform vertex cache that index orders are optimized for
+//---------------------------------
+const int VERTEX_CACHE_SIZE = 16;
+
+// a run of indices that is drawn as one shape (e.g. one triangle of the Triforce)
+//---------------------------------
+struct SubMesh
+{
+	unsigned int firstIndex;		// position of the shape's first index in Mesh::indices
+	unsigned int indexCount;		// number of indices (3 per triangle) in the shape
+};
+
+// an indexed triangle list made of one or more shapes
+//---------------------------------
+struct Mesh
+{
+	std::vector<float>			vertices;	// interleaved vertex data, FLOATS_PER_VERTEX floats per vertex
+	std::vector<unsigned int>	indices;	// triangle list indices into vertices
+	std::vector<SubMesh>		shapes;		// index ranges of each shape, in the order they were added
+};
+
+// an axis aligned rectangle in the xy plane
+//---------------------------------
+struct Bounds2D
+{
+	float			minX;
+	float			minY;
+	float			maxX;
+	float			maxY;
+};
+
+// every level of subdivision of each shape, as ranges of the shapes' index buffer
+//---------------------------------
+struct ShapeLevels
+{
+	int						count;		// levels each shape has, 0 when the shapes only have the one they are drawn at
+	std::vector<SubMesh>	ranges;		// shape s at level l is ranges[s * count + l]; level 0 is the coarsest
+};
+
+// a single draw call's worth of geometry
+//---------------------------------
+struct DrawRange
+{
+	unsigned int	VAO;			// vertex array object the shape lives in
+	int				first;			// first vertex (unindexed) or byte offset of the first index (indexed)
+	int				count;			// number of vertices (unindexed) or indices (indexed) to draw
+	unsigned int	indexType;		// GL_UNSIGNED_SHORT or GL_UNSIGNED_INT, 0 when drawn without indices
+};
+
+// attributes a vertex layout can describe
+//---------------------------------
+const int MAX_VERTEX_ATTRIBUTES = 4;
+
+// one vertex attribute, in the terms of glVertexAttribPointer
+//---------------------------------
+struct VertexAttribute
+{
+	unsigned int	location;		// shader attribute location
+	int				components;		// number of components (1 - 4)
+	unsigned int	type;			// component type, as a GL enum value
+	unsigned int	offset;			// byte offset inside the vertex
+};
+
+// how a shape's saturation pulses: 0.5 + 0.5 * amplitude * sin(phase + frequency * t), where t is the
+// time the animation has run. The vertex shader evaluates it, so every shape can pulse on its own
+//---------------------------------
+struct ShapeAnimation
+{
+	float			phase;			// radians at t = 0
+	float			frequency;		// radians per second
+	float			amplitude;		// 1 swings the saturation from 0 to 1, 0 holds it at one half
+};
+
+// each vertex carries the number of its shape as an unsigned int attribute from a buffer of its own;
+// the shaders look everything else about the shape up in the shape table by it
+//---------------------------------
+const unsigned int SHAPE_ATTRIBUTE = 2;
+
+// no VAO enables this attribute; its current value is the number of the first shape in the bound chunk of
+// the shape table, which the shaders subtract from a vertex's shape number to find its record
+//---------------------------------
+const unsigned int SHAPE_BASE_ATTRIBUTE = 3;
+
+// the buffers and vertex format of a VAO; buffers can be shared between contexts but VAOs
+// cannot, so another context builds its own VAO from this
+//---------------------------------
+struct VertexLayout
+{
+	unsigned int	VAO;				// the VAO built by the context that loaded the buffers
+	unsigned int	vertexBuffer;		// interleaved vertices
+	unsigned int	elementBuffer;		// indices, 0 when drawn without indices
+	unsigned int	shapeBuffer;		// number of each vertex's shape, 0 for every vertex to be shape 0
+	int				stride;				// bytes per vertex
+	int				attributeCount;
+	VertexAttribute	attributes[MAX_VERTEX_ATTRIBUTES];
+};
+
+// BUILDING
+//---------------------------------
+void subdivideTriangle(const float* tri, int depth, std::vector<float>* out);					// Sierpinski subdivision of one triangle
+void addShape(Mesh* mesh, const float* verts, int numVerts);									// appends a triangle soup as a new shape
+void optimizeVertexCache(Mesh* mesh, int cacheSize);											// Tipsify reorder of each shape's triangles
+void optimizeVertexFetch(Mesh* mesh);															// reorders vertices into first-use order
+void shapeBounds(const float* positions, int stride, const void* indices, int indexSize, const SubMesh* shapes, int shapeCount, std::vector<Bounds2D>* out);	// the xy bounds of every shape
+void shapeStream(const void* indices, int indexSize, const SubMesh* ranges, int rangeCount, int rangesPerShape, int numVerts, std::vector<unsigned int>* out);	// gives every vertex its shape's number
+
+// QUERIES
+//---------------------------------
+int vertexCount(const Mesh& mesh);																// number of unique vertices
+int indexSize(const Mesh& mesh);																// 2 if indices fit in 16 bits, else 4
+float averageCacheMissRatio(const Mesh& mesh, int cacheSize);									// transformed vertices per triangle (ACMR)
+void packIndices(const Mesh& mesh, std::vector<unsigned char>* out);							// writes indices at indexSize() bytes each
+
+#endif
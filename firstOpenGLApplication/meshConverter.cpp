@@ -0,0 +1,69 @@
+//************************************************************************************************************************
+//
+//	LearnOpenGL - meshConverter.cpp
+//
+//	Name:			Tucker Dane Walker
+//	Date:			August 2017
+//	Description:	Command line tool that generates a (subdivided) Triforce once and stores it as a binary mesh
+//					file, so the application can map it instead of regenerating it at startup.
+//
+//					usage:	meshConverter <depth> <output.tfm>
+//
+//***********************************************************************************************************************/
+
+#include "triforce.h"
+#include "meshFile.h"
+
+#include <stdlib.h>
+#include <chrono>
+#include <iostream>
+
+int main(int argc, char* argv[])
+{
+	if (argc != 3)
+	{
+		std::cout << "usage: meshConverter <depth> <output.tfm>" << std::endl;
+		return 1;
+	}
+
+	int depth = atoi(argv[1]);
+	const char* outPath = argv[2];
+	if (depth < 0 || depth > 12)
+	{
+		std::cout << "ERROR::CONVERTER::DEPTH_OUT_OF_RANGE (0 - 12)" << std::endl;
+		return 1;
+	}
+
+	// generate the mesh
+	//---------------------------------
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	int unindexedVerts = 0;
+	Mesh mesh = makeTriforceMesh(depth, &unindexedVerts);
+	std::chrono::steady_clock::time_point generated = std::chrono::steady_clock::now();
+
+	// write it out
+	//---------------------------------
+	if (!writeMeshFile(outPath, mesh))
+	{
+		return 1;
+	}
+
+	// map it back in to check it and to time the load the application will do
+	//---------------------------------
+	std::chrono::steady_clock::time_point written = std::chrono::steady_clock::now();
+	MappedMesh mapped;
+	if (!mapMeshFile(outPath, &mapped))
+	{
+		return 1;
+	}
+	std::chrono::steady_clock::time_point loaded = std::chrono::steady_clock::now();
+
+	std::cout << outPath << ": " << mapped.header->vertexCount << " vertices (" << unindexedVerts << " unindexed), "
+		<< mapped.header->indexCount << " indices @ " << mapped.header->indexSize << " bytes, "
+		<< mapped.header->shapeCount << " shapes, " << mapped.size << " bytes" << std::endl;
+	std::cout << "generate: " << std::chrono::duration<double, std::milli>(generated - start).count() << " ms, "
+		<< "map: " << std::chrono::duration<double, std::milli>(loaded - written).count() << " ms" << std::endl;
+
+	unmapMeshFile(&mapped);
+	return 0;
+}
@@ -0,0 +1,375 @@
+//************************************************************************************************************************
+//
+//	LearnOpenGL - meshFile.cpp
+//
+//	Name:			Tucker Dane Walker
+//	Date:			August 2017
+//	Description:	Implementation for writing and memory mapping binary mesh files (.tfm).
+//
+//***********************************************************************************************************************/
+
+#include "meshFile.h"
+
+#include <string.h>
+#include <fstream>
+#include <iostream>
+#include <vector>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+//-------------------------------------------------------------------
+//	@param:		offset		a byte offset into the file
+//	@return:	offset rounded up to the next payload boundary
+//-------------------------------------------------------------------
+static uint64_t alignOffset(uint64_t offset)
+{
+	return (offset + MESH_FILE_ALIGNMENT - 1) & ~(uint64_t)(MESH_FILE_ALIGNMENT - 1);
+}
+
+//-------------------------------------------------------------------
+//	pads the file with zeros up to the next payload boundary
+//
+//	@param:		file		the file being written
+//	@param:		written		bytes written so far, updated
+//-------------------------------------------------------------------
+static void writePadding(std::ofstream& file, uint64_t* written)
+{
+	static const char zeros[MESH_FILE_ALIGNMENT] = { 0 };
+	uint64_t aligned = alignOffset(*written);
+	file.write(zeros, (std::streamsize)(aligned - *written));
+	*written = aligned;
+}
+
+//-------------------------------------------------------------------
+//	writes a mesh to disk in the .tfm format
+//
+//	@param:		path		the file to create
+//	@param:		mesh		the mesh to write; vertices are written
+//							as FLOATS_PER_VERTEX floats (position, color)
+//	@return:	true if the whole file was written
+//-------------------------------------------------------------------
+bool writeMeshFile(const char* path, const Mesh& mesh)
+{
+	std::vector<unsigned char> indices;
+	packIndices(mesh, &indices);
+
+	// describe the payloads
+	//---------------------------------
+	MeshFileHeader header;
+	memset(&header, 0, sizeof(header));
+	header.magic = MESH_FILE_MAGIC;
+	header.version = MESH_FILE_VERSION;
+	header.alignment = MESH_FILE_ALIGNMENT;
+	header.vertexStride = FLOATS_PER_VERTEX * sizeof(float);
+
+	// position attribute
+	header.attributes[0].location = 0;
+	header.attributes[0].components = 3;
+	header.attributes[0].type = MESH_ATTRIB_FLOAT;
+	header.attributes[0].offset = 0;
+
+	// color attribute
+	header.attributes[1].location = 1;
+	header.attributes[1].components = 3;
+	header.attributes[1].type = MESH_ATTRIB_FLOAT;
+	header.attributes[1].offset = 3 * sizeof(float);
+	header.attributeCount = 2;
+
+	header.vertexCount = (uint32_t)vertexCount(mesh);
+	header.indexCount = (uint32_t)mesh.indices.size();
+	header.indexSize = (uint32_t)indexSize(mesh);
+	header.shapeCount = (uint32_t)mesh.shapes.size();
+
+	header.vertexOffset = alignOffset(sizeof(MeshFileHeader));
+	header.indexOffset = alignOffset(header.vertexOffset + (uint64_t)header.vertexCount * header.vertexStride);
+	header.shapeOffset = alignOffset(header.indexOffset + indices.size());
+	header.fileSize = header.shapeOffset + mesh.shapes.size() * sizeof(SubMesh);
+
+	// write the header and each payload
+	//---------------------------------
+	std::ofstream file(path, std::ios::out | std::ios::binary | std::ios::trunc);
+	if (!file)
+	{
+		std::cout << "ERROR::MESHFILE::COULD_NOT_CREATE " << path << std::endl;
+		return false;
+	}
+
+	uint64_t written = sizeof(header);
+	file.write((const char*)&header, sizeof(header));
+	writePadding(file, &written);
+
+	if (!mesh.vertices.empty())
+	{
+		file.write((const char*)&mesh.vertices[0], mesh.vertices.size() * sizeof(float));
+		written += mesh.vertices.size() * sizeof(float);
+	}
+	writePadding(file, &written);
+
+	if (!indices.empty())
+	{
+		file.write((const char*)&indices[0], indices.size());
+		written += indices.size();
+	}
+	writePadding(file, &written);
+
+	if (!mesh.shapes.empty())
+	{
+		file.write((const char*)&mesh.shapes[0], mesh.shapes.size() * sizeof(SubMesh));
+	}
+
+	if (!file)
+	{
+		std::cout << "ERROR::MESHFILE::WRITE_FAILED " << path << std::endl;
+		return false;
+	}
+	return true;
+}
+
+//-------------------------------------------------------------------
+//	checks that a mapped header describes payloads that fit the file
+//
+//	@param:		header		the header at the start of the mapping
+//	@param:		size		size of the mapping in bytes
+//	@return:	true if the header can be trusted
+//-------------------------------------------------------------------
+static bool validateHeader(const MeshFileHeader* header, size_t size)
+{
+	if (size < sizeof(MeshFileHeader) || header->magic != MESH_FILE_MAGIC)
+	{
+		std::cout << "ERROR::MESHFILE::NOT_A_MESH_FILE" << std::endl;
+		return false;
+	}
+	if (header->version != MESH_FILE_VERSION)
+	{
+		std::cout << "ERROR::MESHFILE::UNSUPPORTED_VERSION " << header->version << std::endl;
+		return false;
+	}
+	if (header->fileSize != size || header->attributeCount > MESH_FILE_MAX_ATTRIBUTES
+		|| (header->indexSize != 2 && header->indexSize != 4) || header->alignment == 0
+		|| header->vertexOffset % header->alignment != 0 || header->indexOffset % header->alignment != 0
+		|| header->shapeOffset % header->alignment != 0)
+	{
+		std::cout << "ERROR::MESHFILE::BAD_HEADER" << std::endl;
+		return false;
+	}
+	for (uint32_t i = 0; i < header->attributeCount; i++)
+	{
+		const MeshFileAttribute& attrib = header->attributes[i];
+		if (attrib.components < 1 || attrib.components > 4 || attrib.offset >= header->vertexStride)
+		{
+			std::cout << "ERROR::MESHFILE::BAD_ATTRIBUTE " << i << std::endl;
+			return false;
+		}
+	}
+	if (header->vertexOffset + (uint64_t)header->vertexCount * header->vertexStride > header->indexOffset
+		|| header->indexOffset + (uint64_t)header->indexCount * header->indexSize > header->shapeOffset
+		|| header->shapeOffset + (uint64_t)header->shapeCount * sizeof(SubMesh) > size)
+	{
+		std::cout << "ERROR::MESHFILE::TRUNCATED" << std::endl;
+		return false;
+	}
+	return true;
+}
+
+//-------------------------------------------------------------------
+//	checks that every shape's range lies inside the index payload and
+//	that every index names a vertex in the file, so a corrupt file
+//	cannot send the draws or the software rasterizer past the mapping
+//
+//	@param:		mesh		a mapping whose header passed validateHeader
+//	@return:	true if the payloads can be trusted
+//-------------------------------------------------------------------
+static bool validatePayloads(const MappedMesh& mesh)
+{
+	const MeshFileHeader* header = mesh.header;
+	for (uint32_t i = 0; i < header->shapeCount; i++)
+	{
+		const SubMesh& shape = mesh.shapes[i];
+		if (shape.firstIndex > header->indexCount || shape.indexCount > header->indexCount - shape.firstIndex
+			|| shape.indexCount % 3 != 0)
+		{
+			std::cout << "ERROR::MESHFILE::BAD_SHAPE " << i << std::endl;
+			return false;
+		}
+	}
+
+	// a linear pass over the indices; mapMeshFile runs on a loader worker, which reads every page anyway
+	uint32_t largest = 0;
+	if (header->indexSize == 2)
+	{
+		const uint16_t* indices = (const uint16_t*)mesh.indices;
+		for (uint32_t i = 0; i < header->indexCount; i++)
+		{
+			largest = indices[i] > largest ? indices[i] : largest;
+		}
+	}
+	else
+	{
+		const uint32_t* indices = (const uint32_t*)mesh.indices;
+		for (uint32_t i = 0; i < header->indexCount; i++)
+		{
+			largest = indices[i] > largest ? indices[i] : largest;
+		}
+	}
+	if (header->indexCount > 0 && largest >= header->vertexCount)
+	{
+		std::cout << "ERROR::MESHFILE::BAD_INDEX " << largest << std::endl;
+		return false;
+	}
+	return true;
+}
+
+//-------------------------------------------------------------------
+//	@param:		path		a path from the command line
+//	@return:	true if it ends in .tfm, the extension writeMeshFile's
+//				files are given
+//-------------------------------------------------------------------
+bool isMeshFilePath(const char* path)
+{
+	size_t length = strlen(path);
+	return length > 4 && strcmp(path + length - 4, ".tfm") == 0;
+}
+
+//-------------------------------------------------------------------
+//	maps a .tfm file read-only into memory; nothing is parsed or
+//	copied, the payload pointers point straight into the mapping
+//
+//	@param:		path		the file to map
+//	@param:		out			receives the mapping and payload pointers
+//	@return:	true if the file was mapped and its header is valid
+//-------------------------------------------------------------------
+bool mapMeshFile(const char* path, MappedMesh* out)
+{
+	memset(out, 0, sizeof(*out));
+	const void* view = NULL;
+
+#ifdef _WIN32
+	HANDLE file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+	if (file == INVALID_HANDLE_VALUE)
+	{
+		std::cout << "ERROR::MESHFILE::COULD_NOT_OPEN " << path << std::endl;
+		return false;
+	}
+	LARGE_INTEGER fileSize;
+	if (!GetFileSizeEx(file, &fileSize))
+	{
+		std::cout << "ERROR::MESHFILE::COULD_NOT_STAT " << path << std::endl;
+		CloseHandle(file);
+		return false;
+	}
+	HANDLE mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+	if (mapping != NULL)
+	{
+		view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+	}
+	out->file = file;
+	out->mapping = mapping;
+	out->size = (size_t)fileSize.QuadPart;
+#else
+	int file = open(path, O_RDONLY);
+	if (file < 0)
+	{
+		std::cout << "ERROR::MESHFILE::COULD_NOT_OPEN " << path << std::endl;
+		return false;
+	}
+	struct stat info;
+	if (fstat(file, &info) != 0)
+	{
+		std::cout << "ERROR::MESHFILE::COULD_NOT_STAT " << path << std::endl;
+		close(file);
+		return false;
+	}
+	out->size = (size_t)info.st_size;
+	if (out->size > 0)
+	{
+		view = mmap(NULL, out->size, PROT_READ, MAP_PRIVATE, file, 0);
+		if (view == MAP_FAILED)
+		{
+			view = NULL;
+		}
+	}
+	close(file);	// the mapping stays valid after the descriptor is closed
+#endif
+
+	out->header = (const MeshFileHeader*)view;
+	if (view == NULL)
+	{
+		std::cout << "ERROR::MESHFILE::COULD_NOT_MAP " << path << std::endl;
+		unmapMeshFile(out);
+		return false;
+	}
+	if (!validateHeader(out->header, out->size))
+	{
+		unmapMeshFile(out);
+		return false;
+	}
+
+	const unsigned char* base = (const unsigned char*)view;
+	out->vertices = base + out->header->vertexOffset;
+	out->indices = base + out->header->indexOffset;
+	out->shapes = (const SubMesh*)(base + out->header->shapeOffset);
+	if (!validatePayloads(*out))
+	{
+		unmapMeshFile(out);
+		return false;
+	}
+	return true;
+}
+
+//-------------------------------------------------------------------
+//	reads one byte of every page of the mapping so the disk reads
+//	happen on the calling thread (a loader worker) rather than inside
+//	glBufferData on the GL thread
+//
+//	@param:		mesh		the mapped mesh
+//	@return:	true, so it can be chained after mapMeshFile
+//-------------------------------------------------------------------
+bool touchMeshFile(const MappedMesh& mesh)
+{
+	const volatile unsigned char* bytes = (const volatile unsigned char*)mesh.header;
+	unsigned char sum = 0;
+	for (size_t i = 0; i < mesh.size; i += 4096)
+	{
+		sum += bytes[i];
+	}
+	(void)sum;
+	return true;
+}
+
+//-------------------------------------------------------------------
+//	releases a mapping made by mapMeshFile
+//
+//	@param:		mesh		the mapped mesh; its pointers are cleared
+//-------------------------------------------------------------------
+void unmapMeshFile(MappedMesh* mesh)
+{
+#ifdef _WIN32
+	if (mesh->header != NULL)
+	{
+		UnmapViewOfFile(mesh->header);
+	}
+	if (mesh->mapping != NULL)
+	{
+		CloseHandle((HANDLE)mesh->mapping);
+	}
+	if (mesh->file != NULL)
+	{
+		CloseHandle((HANDLE)mesh->file);
+	}
+#else
+	if (mesh->header != NULL)
+	{
+		munmap((void*)mesh->header, mesh->size);
+	}
+#endif
+	memset(mesh, 0, sizeof(*mesh));
+}
@@ -0,0 +1,82 @@
+//************************************************************************************************************************
+//
+//	LearnOpenGL - meshFile.h
+//
+//	Name:			Tucker Dane Walker
+//	Date:			August 2017
+//	Description:	Specifications for the binary mesh file (.tfm). The payloads are stored exactly as they are
+//					uploaded to the GPU, so a memory mapped file can be handed straight to glBufferData.
+//
+//					layout:		MeshFileHeader | pad | vertices | pad | indices | pad | shapes (SubMesh[])
+//					every payload starts on a multiple of header.alignment bytes
+//
+//***********************************************************************************************************************/
+
+#ifndef MESH_FILE_H
+#define MESH_FILE_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "mesh.h"
+
+// file identification
+//---------------------------------
+const uint32_t MESH_FILE_MAGIC = 0x4D534654;													// "TFSM" when read as bytes
+const uint32_t MESH_FILE_VERSION = 1;
+const uint32_t MESH_FILE_ALIGNMENT = 64;														// payload alignment in bytes
+const uint32_t MESH_FILE_MAX_ATTRIBUTES = 4;
+const uint32_t MESH_ATTRIB_FLOAT = 0x1406;														// same value as GL_FLOAT
+
+// one vertex attribute, in the terms of glVertexAttribPointer
+//---------------------------------
+struct MeshFileAttribute
+{
+	uint32_t location;		// shader attribute location
+	uint32_t components;	// number of components (1 - 4)
+	uint32_t type;			// component type, as a GL enum value
+	uint32_t offset;		// byte offset inside the vertex
+};
+
+// the header at the start of every mesh file
+//---------------------------------
+struct MeshFileHeader
+{
+	uint32_t			magic;								// MESH_FILE_MAGIC
+	uint32_t			version;							// MESH_FILE_VERSION
+	uint32_t			alignment;							// alignment of every payload
+	uint32_t			vertexStride;						// bytes per vertex
+	uint32_t			attributeCount;						// used entries of attributes
+	MeshFileAttribute	attributes[MESH_FILE_MAX_ATTRIBUTES];
+	uint32_t			vertexCount;						// number of vertices
+	uint32_t			indexCount;							// number of indices
+	uint32_t			indexSize;							// bytes per index (2 or 4)
+	uint32_t			shapeCount;							// number of SubMesh records
+	uint32_t			reserved;							// keeps the 64 bit offsets aligned, always 0
+	uint64_t			vertexOffset;						// byte offset of the vertex payload
+	uint64_t			indexOffset;						// byte offset of the index payload
+	uint64_t			shapeOffset;						// byte offset of the shape payload
+	uint64_t			fileSize;							// total size of the file in bytes
+};
+
+// a mesh file mapped into memory; the pointers point into the mapping
+//---------------------------------
+struct MappedMesh
+{
+	const MeshFileHeader*	header;		// start of the file
+	const void*				vertices;	// header->vertexCount * header->vertexStride bytes
+	const void*				indices;	// header->indexCount * header->indexSize bytes
+	const SubMesh*			shapes;		// header->shapeCount shapes
+	size_t					size;		// size of the mapping in bytes
+	void*					file;		// platform handles of the mapping
+	void*					mapping;
+};
+
+// MESH FILES
+//---------------------------------
+bool writeMeshFile(const char* path, const Mesh& mesh);											// writes a mesh as a .tfm file
+bool isMeshFilePath(const char* path);														// true if path names a .tfm file
+bool mapMeshFile(const char* path, MappedMesh* out);											// maps and validates a .tfm file
+void unmapMeshFile(MappedMesh* mesh);															// releases a mapped .tfm file
+bool touchMeshFile(const MappedMesh& mesh);														// faults the mapped pages in ahead of the upload
+
+#endif
@@ -0,0 +1,265 @@
+//************************************************************************************************************************
+//
+//	LearnOpenGL - regression.cpp
+//
+//	Name:			Tucker Dane Walker
+//	Date:			August 2017
+//	Description:	Implementation for the regression harness.
+//
+//***********************************************************************************************************************/
+
+#include "regression.h"
+#include "scene.h"
+#include "image.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// a scene: what the harness renders and how fast it must be
+//---------------------------------
+struct RegressionScene
+{
+	const char*	name;			// golden and diff images are named after it
+	int			depth;			// levels of subdivision of the Triforce
+	const char*	keys;			// keys tapped in turn, as GLFW key codes; a key followed by '+' is held to the end
+	double		cpuBudgetMs;	// average CPU time allowed per frame
+	double		gpuBudgetMs;	// average GPU time allowed per frame
+};
+
+static const RegressionScene SCENES[] =
+{
+	{ "default",				0,	"",			8.0,	8.0 },
+	{ "select_top",				0,	"W+",		8.0,	8.0 },
+	{ "select_left",			0,	"A+",		8.0,	8.0 },
+	{ "select_right",			0,	"D+",		8.0,	8.0 },
+	{ "top_yellow",				0,	"W2",		8.0,	8.0 },
+	{ "left_red_right_blue",	0,	"A3D1",		8.0,	8.0 },
+	{ "all_interpolated",		0,	"W4A4D4",	8.0,	8.0 },
+	{ "wireframe",				0,	"P",		8.0,	8.0 },
+	{ "wireframe_then_fill",	0,	"PF",		8.0,	8.0 },
+	{ "saturation",				0,	"B+",		8.0,	8.0 },
+	{ "depth6",					6,	"",			12.0,	12.0 },
+	{ "depth8_interpolated",	8,	"W4A4D4",	16.0,	24.0 }
+};
+
+// time between scripted key changes; more than a replayed frame, so each lands on its own frame
+//---------------------------------
+static const uint32_t KEY_STEP_MS = 20;
+
+//-------------------------------------------------------------------
+//	turns a scene's keys into an input session
+//
+//	@param:		keys		the scene's keys
+//	@param:		log			receives the session, ending
+//							REGRESSION_SETTLE_FRAMES frames after the
+//							last change
+//-------------------------------------------------------------------
+static void scriptKeys(const char* keys, std::vector<InputLogEvent>* log)
+{
+	uint32_t time = KEY_STEP_MS;
+	InputLogEvent event;
+	event.reserved = 0;
+
+	log->clear();
+	for (const char* c = keys; *c != '\0'; c++)
+	{
+		if (*c == '+')
+		{
+			continue;
+		}
+		event.key = (uint16_t)*c;		// GLFW codes of letters and digits are their ASCII codes
+		event.pressed = 1;
+		event.timeMs = time;
+		log->push_back(event);
+		time += KEY_STEP_MS;
+
+		if (c[1] != '+')
+		{
+			event.pressed = 0;
+			event.timeMs = time;
+			log->push_back(event);
+			time += KEY_STEP_MS;
+		}
+	}
+
+	event.key = INPUT_LOG_END;
+	event.pressed = 0;
+	event.timeMs = time + REGRESSION_SETTLE_FRAMES * 1000 / 60;
+	log->push_back(event);
+}
+
+// how a frame compares with its golden
+//---------------------------------
+struct ImageDiff
+{
+	int		differing;		// pixels with a channel further than REGRESSION_CHANNEL_TOLERANCE off
+	int		maxChannel;		// largest difference of any channel
+};
+
+//-------------------------------------------------------------------
+//	compares two frames of the same size and makes a diff image:
+//	differing pixels are red, the rest a dimmed copy of the golden
+//
+//	@param:		actual		the rendered frame, RGBA8
+//	@param:		golden		the golden frame, RGBA8
+//	@param:		diffImage	receives the diff image, RGBA8
+//	@return:	how far apart they are
+//-------------------------------------------------------------------
+static ImageDiff compareImages(const std::vector<unsigned char>& actual, const std::vector<unsigned char>& golden,
+	std::vector<unsigned char>* diffImage)
+{
+	ImageDiff diff;
+	diff.differing = 0;
+	diff.maxChannel = 0;
+	diffImage->resize(golden.size());
+
+	for (size_t i = 0; i < golden.size(); i += 4)
+	{
+		int worst = 0;
+		for (int c = 0; c < 3; c++)		// goldens carry no alpha
+		{
+			worst = std::max(worst, abs((int)actual[i + c] - (int)golden[i + c]));
+		}
+		diff.maxChannel = std::max(diff.maxChannel, worst);
+
+		unsigned char* out = &(*diffImage)[i];
+		if (worst > REGRESSION_CHANNEL_TOLERANCE)
+		{
+			diff.differing++;
+			out[0] = 255;
+			out[1] = 0;
+			out[2] = 0;
+		}
+		else
+		{
+			unsigned char grey = (unsigned char)((golden[i] + golden[i + 1] + golden[i + 2]) / 9);
+			out[0] = grey;
+			out[1] = grey;
+			out[2] = grey;
+		}
+		out[3] = 255;
+	}
+	return diff;
+}
+
+//-------------------------------------------------------------------
+//	renders every scene into the current offscreen context and checks
+//	it against its golden image and frame time budgets
+//
+//	@param:		goldenDir		directory holding <scene>.ppm goldens;
+//								the report and diff images go here too
+//	@param:		updateGoldens	store each frame as the new golden
+//								instead of comparing it
+//	@return:	true if no scene regressed
+//-------------------------------------------------------------------
+bool runRegression(const char* goldenDir, bool updateGoldens)
+{
+	std::string dir = goldenDir;
+	std::string reportPath = dir + "/report.json";
+	std::ofstream json(reportPath.c_str(), std::ios::out | std::ios::trunc);
+	if (!json)
+	{
+		std::cout << "ERROR::REGRESSION::COULD_NOT_CREATE " << reportPath << std::endl;
+		return false;
+	}
+	json << "{\n\t\"scenes\": [";
+
+	int sceneCount = (int)(sizeof(SCENES) / sizeof(SCENES[0]));
+	int failures = 0;
+	for (int s = 0; s < sceneCount; s++)
+	{
+		const RegressionScene& scene = SCENES[s];
+		std::string goldenPath = dir + "/" + scene.name + ".ppm";
+
+		// render the scene through the normal render loop, driven by its keys
+		//---------------------------------
+		std::vector<InputLogEvent> session;
+		scriptKeys(scene.keys, &session);
+
+		RenderReport report;
+		report.frames = 0;
+		report.width = 0;
+		report.height = 0;
+
+		RenderOptions options;
+		initRenderOptions(&options);
+		options.replayEvents = &session;
+		options.report = &report;
+		runScene(std::vector<GLFWwindow*>(), NULL, scene.depth, options);
+
+		// compare the last frame with the golden
+		//---------------------------------
+		const char* imageResult = "pass";
+		ImageDiff diff;
+		diff.differing = 0;
+		diff.maxChannel = 0;
+		int goldenWidth = 0;
+		int goldenHeight = 0;
+		std::vector<unsigned char> golden;
+
+		if (report.image.empty())
+		{
+			imageResult = "no_frame";
+		}
+		else if (updateGoldens)
+		{
+			imageResult = writeImage(goldenPath.c_str(), report.width, report.height, &report.image[0]) ? "updated" : "fail";
+		}
+		else if (!readImage(goldenPath.c_str(), &goldenWidth, &goldenHeight, &golden))
+		{
+			imageResult = "missing";
+		}
+		else if (goldenWidth != report.width || goldenHeight != report.height)
+		{
+			imageResult = "size_mismatch";
+		}
+		else
+		{
+			std::vector<unsigned char> diffImage;
+			diff = compareImages(report.image, golden, &diffImage);
+			if (diff.differing > REGRESSION_PIXEL_TOLERANCE * report.width * report.height)
+			{
+				imageResult = "fail";
+				writeImage((dir + "/" + scene.name + ".diff.ppm").c_str(), report.width, report.height, &diffImage[0]);
+			}
+		}
+
+		// keep what was rendered whenever it could not be matched, so it can be inspected or promoted
+		bool imagePassed = (strcmp(imageResult, "pass") == 0 || strcmp(imageResult, "updated") == 0);
+		if (!imagePassed && !report.image.empty())
+		{
+			writeImage((dir + "/" + scene.name + ".actual.ppm").c_str(), report.width, report.height, &report.image[0]);
+		}
+
+		// and the frame times with the budgets
+		//---------------------------------
+		bool cpuPassed = report.cpuAvgMs <= scene.cpuBudgetMs;
+		bool gpuPassed = report.gpuAvgMs <= scene.gpuBudgetMs;
+		bool passed = imagePassed && cpuPassed && gpuPassed;
+		if (!passed)
+		{
+			failures++;
+		}
+
+		std::cout << "REGRESSION::" << scene.name << ": " << (passed ? "PASS" : "FAIL") << ", image " << imageResult << " ("
+			<< diff.differing << " pixels differ), CPU " << report.cpuAvgMs << " / " << scene.cpuBudgetMs << " ms, GPU "
+			<< report.gpuAvgMs << " / " << scene.gpuBudgetMs << " ms" << std::endl;
+
+		json << (s > 0 ? "," : "") << "\n\t\t{ \"name\": \"" << scene.name << "\", \"passed\": " << (passed ? "true" : "false")
+			<< ", \"image\": \"" << imageResult << "\", \"differing_pixels\": " << diff.differing
+			<< ", \"max_channel_diff\": " << diff.maxChannel << ", \"frames\": " << report.frames
+			<< ", \"cpu_avg_ms\": " << report.cpuAvgMs << ", \"cpu_max_ms\": " << report.cpuMaxMs
+			<< ", \"cpu_budget_ms\": " << scene.cpuBudgetMs << ", \"gpu_avg_ms\": " << report.gpuAvgMs
+			<< ", \"gpu_p99_ms\": " << report.gpuP99Ms << ", \"gpu_budget_ms\": " << scene.gpuBudgetMs << " }";
+	}
+
+	json << "\n\t],\n\t\"failures\": " << failures << ",\n\t\"passed\": " << (failures == 0 ? "true" : "false") << "\n}\n";
+	std::cout << "REGRESSION::" << (failures == 0 ? "PASSED" : "FAILED") << " " << sceneCount - failures << " of "
+		<< sceneCount << " scenes passed, report in " << reportPath << std::endl;
+	return failures == 0;
+}
@@ -0,0 +1,36 @@
+//************************************************************************************************************************
+//
+//	LearnOpenGL - regression.h
+//
+//	Name:			Tucker Dane Walker
+//	Date:			August 2017
+//	Description:	Specifications for the regression harness. It renders a set of named scenes offscreen (the
+//					Triforce in each color, selection and polygon mode processInput can put it in, and large
+//					subdivided scenes), each driven by a scripted input session through the real render loop.
+//					The last frame of each is compared with a stored golden image and its frame times with the
+//					scene's budget; the results go to a JSON report, with a diff image for every mismatch.
+//
+//					goldens are <dir>/<scene>.ppm; the report is <dir>/report.json
+//
+//***********************************************************************************************************************/
+
+#ifndef REGRESSION_H
+#define REGRESSION_H
+
+// a pixel differs when any channel is further than this from the golden
+//---------------------------------
+const int REGRESSION_CHANNEL_TOLERANCE = 2;
+
+// a scene fails when more than this fraction of its pixels differ
+//---------------------------------
+const double REGRESSION_PIXEL_TOLERANCE = 0.001;
+
+// frames each scene runs after its last scripted key
+//---------------------------------
+const int REGRESSION_SETTLE_FRAMES = 30;
+
+// RUNNING
+//---------------------------------
+bool runRegression(const char* goldenDir, bool updateGoldens);									// runs every scene; false if any regressed
+
+#endif
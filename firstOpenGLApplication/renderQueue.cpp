@@ -0,0 +1,245 @@
+//************************************************************************************************************************
+//
+//	LearnOpenGL - renderQueue.cpp
+//
+//	Name:			Tucker Dane Walker
+//	Date:			August 2017
+//	Description:	Implementation for a sorted render queue.
+//
+//***********************************************************************************************************************/
+
+#include "renderQueue.h"
+
+#include <string.h>
+
+//-------------------------------------------------------------------
+//	constructor
+//-------------------------------------------------------------------
+RenderQueue::RenderQueue()
+{
+	memset(&frameStats, 0, sizeof(frameStats));
+}
+
+//-------------------------------------------------------------------
+//	empties the queue for a new frame
+//-------------------------------------------------------------------
+void RenderQueue::clear()
+{
+	items.clear();
+}
+
+//-------------------------------------------------------------------
+//	@param:		item		a draw for the next record
+//-------------------------------------------------------------------
+void RenderQueue::add(const DrawItem& item)
+{
+	items.push_back(item);
+}
+
+//-------------------------------------------------------------------
+//	packs the state a draw needs into a key; draws sharing a program
+//	sort next to each other, then by VAO, then by polygon mode
+//
+//	@param:		program		shader program (low 16 bits are used)
+//	@param:		VAO			vertex array object (low 16 bits are used)
+//	@param:		polygonMode	GL_FILL or GL_LINE
+//	@param:		depth		order among draws with the same state
+//							(low 24 bits are used)
+//	@return:	the 64 bit sort key
+//-------------------------------------------------------------------
+uint64_t RenderQueue::makeSortKey(unsigned int program, unsigned int VAO, GLenum polygonMode, unsigned int depth)
+{
+	uint64_t mode = (polygonMode == GL_LINE) ? 1 : 0;
+	return ((uint64_t)(program & 0xFFFF) << 48)
+		| ((uint64_t)(VAO & 0xFFFF) << 32)
+		| (mode << 30)
+		| ((uint64_t)(depth & 0xFFFFFF) << 6);
+}
+
+//-------------------------------------------------------------------
+//	LSD radix sort of the item indices by key, 8 bits per pass;
+//	passes where every key has the same byte are skipped
+//-------------------------------------------------------------------
+void RenderQueue::sort()
+{
+	size_t count = items.size();
+	order.resize(count);
+	scratch.resize(count);
+	for (size_t i = 0; i < count; i++)
+	{
+		order[i] = (uint32_t)i;
+	}
+
+	for (int shift = 0; shift < 64; shift += 8)
+	{
+		size_t histogram[256];
+		memset(histogram, 0, sizeof(histogram));
+		for (size_t i = 0; i < count; i++)
+		{
+			histogram[(items[i].key >> shift) & 0xFF]++;
+		}
+
+		// all keys share this byte; the pass would not move anything
+		if (histogram[(items[0].key >> shift) & 0xFF] == count)
+		{
+			continue;
+		}
+
+		size_t offset = 0;
+		for (int b = 0; b < 256; b++)
+		{
+			size_t n = histogram[b];
+			histogram[b] = offset;
+			offset += n;
+		}
+		for (size_t i = 0; i < count; i++)
+		{
+			uint32_t item = order[i];
+			scratch[histogram[(items[item].key >> shift) & 0xFF]++] = item;
+		}
+		order.swap(scratch);
+	}
+}
+
+//-------------------------------------------------------------------
+//	sorts the queued draws and records them, emitting each program,
+//	VAO, polygon mode and shape table bind only when it differs from
+//	the previous draw; makes no GL calls, so it can run on any thread.
+//	Indexed draws sharing all four are batched: ranges that follow on
+//	from the previous one in the index buffer extend it, and the rest
+//	of the run goes out as one multi-draw. A table chunk holds a run
+//	of shapes, so draws ordered by shape number bind each chunk once
+//
+//	@param:		commands	buffer the draws are appended to
+//-------------------------------------------------------------------
+void RenderQueue::record(CommandBuffer* commands)
+{
+	memset(&frameStats, 0, sizeof(frameStats));
+	if (items.empty())
+	{
+		return;
+	}
+
+	sort();
+
+	unsigned int boundProgram = 0;
+	unsigned int boundVAO = 0;
+	GLenum boundMode = 0;
+	unsigned int boundTable = 0;
+	unsigned int batchType = 0;
+
+	for (size_t i = 0; i < order.size(); i++)
+	{
+		const DrawItem& item = items[order[i]];
+		bool sameState = item.program == boundProgram && item.range.VAO == boundVAO && item.polygonMode == boundMode
+			&& item.table == boundTable;
+
+		// joins the batch being built; its binds are already in place
+		if (sameState && item.range.indexType != 0 && item.range.indexType == batchType)
+		{
+			int indexSize = (batchType == GL_UNSIGNED_SHORT) ? 2 : 4;
+			size_t last = batchCounts.size() - 1;
+			if ((int64_t)batchOffsets[last] + (int64_t)batchCounts[last] * indexSize == item.range.first)
+			{
+				batchCounts[last] += item.range.count;
+			}
+			else
+			{
+				batchCounts.push_back(item.range.count);
+				batchOffsets.push_back((uint32_t)item.range.first);
+			}
+			frameStats.bindsAvoided += 3;
+			frameStats.batched++;
+			continue;
+		}
+		flushBatch(commands, batchType);
+		batchType = 0;
+
+		if (item.program != boundProgram)
+		{
+			commands->bindProgram(item.program);
+			boundProgram = item.program;
+			frameStats.programBinds++;
+		}
+		else
+		{
+			frameStats.bindsAvoided++;
+		}
+
+		if (item.range.VAO != boundVAO)
+		{
+			commands->bindVertexArray(item.range.VAO);
+			boundVAO = item.range.VAO;
+			frameStats.vaoBinds++;
+		}
+		else
+		{
+			frameStats.bindsAvoided++;
+		}
+
+		if (item.polygonMode != boundMode)
+		{
+			commands->polygonMode(item.polygonMode);
+			boundMode = item.polygonMode;
+			frameStats.polygonModeChanges++;
+		}
+		else
+		{
+			frameStats.bindsAvoided++;
+		}
+
+		if (item.table != boundTable)
+		{
+			commands->bindShapeTable(item.table, item.tableBase);
+			boundTable = item.table;
+			frameStats.tableBinds++;
+		}
+
+		if (item.range.indexType != 0)
+		{
+			batchType = item.range.indexType;
+			batchCounts.push_back(item.range.count);
+			batchOffsets.push_back((uint32_t)item.range.first);
+		}
+		else
+		{
+			commands->drawArrays(item.range.first, item.range.count);
+			frameStats.draws++;
+		}
+	}
+	flushBatch(commands, batchType);
+}
+
+//-------------------------------------------------------------------
+//	emits the indexed ranges gathered since the last state change as
+//	a single draw, or as one multi-draw when they are not contiguous
+//
+//	@param:		commands	buffer the draw is appended to
+//	@param:		indexType	type of the batch's indices
+//-------------------------------------------------------------------
+void RenderQueue::flushBatch(CommandBuffer* commands, unsigned int indexType)
+{
+	if (batchCounts.empty())
+	{
+		return;
+	}
+	if (batchCounts.size() == 1)
+	{
+		commands->drawElements(batchCounts[0], indexType, batchOffsets[0]);
+	}
+	else
+	{
+		commands->multiDrawElements((int32_t)batchCounts.size(), indexType, &batchCounts[0], &batchOffsets[0]);
+	}
+	frameStats.draws++;
+	batchCounts.clear();
+	batchOffsets.clear();
+}
+
+//-------------------------------------------------------------------
+//	@return:	the counters from the last record
+//-------------------------------------------------------------------
+const RenderQueueStats& RenderQueue::stats() const
+{
+	return frameStats;
+}
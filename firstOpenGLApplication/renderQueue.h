@@ -0,0 +1,80 @@
+//************************************************************************************************************************
+//
+//	LearnOpenGL - renderQueue.h
+//
+//	Name:			Tucker Dane Walker
+//	Date:			August 2017
+//	Description:	Specifications for a sorted render queue. Each frame draws are collected with a packed 64 bit
+//					sort key, radix sorted, and submitted in key order so that consecutive draws sharing a program,
+//					VAO, polygon mode or shape table chunk do not rebind it. Indexed draws sharing all four go out
+//					together: as one draw where their ranges follow on in the index buffer, as one multi-draw where
+//					they do not.
+//
+//					key:	program (16) | VAO (16) | polygon mode (2) | depth (24) | unused (6)
+//
+//***********************************************************************************************************************/
+
+#ifndef RENDER_QUEUE_H
+#define RENDER_QUEUE_H
+
+#include <glad/glad.h>
+#include <stdint.h>
+#include <vector>
+#include "mesh.h"
+#include "commandBuffer.h"
+
+// one draw waiting in the queue
+//---------------------------------
+struct DrawItem
+{
+	uint64_t		key;				// sort key built by makeSortKey
+	unsigned int	program;			// shader program to draw with
+	GLenum			polygonMode;		// GL_FILL or GL_LINE
+	DrawRange		range;				// the VAO and vertex/index range to draw
+	unsigned int	table;				// buffer texture of the shape table chunk holding the shape's record
+	unsigned int	tableBase;			// number of the first shape in that chunk
+};
+
+// what record() emitted in the last frame
+//---------------------------------
+struct RenderQueueStats
+{
+	int draws;					// draw calls issued, a multi-draw counting once
+	int batched;				// queued draws folded into another's draw call
+	int programBinds;			// glUseProgram calls issued
+	int vaoBinds;				// glBindVertexArray calls issued
+	int polygonModeChanges;		// glPolygonMode calls issued
+	int tableBinds;				// shape table chunks bound
+	int bindsAvoided;			// binds skipped because the state was already set
+};
+
+class RenderQueue
+{
+public:
+	RenderQueue();
+
+	// building a frame
+	//---------------------------------
+	void clear();
+	void add(const DrawItem& item);
+	static uint64_t makeSortKey(unsigned int program, unsigned int VAO, GLenum polygonMode, unsigned int depth);
+
+	// sorts the items and records them into a command buffer (any thread)
+	//---------------------------------
+	void record(CommandBuffer* commands);
+
+	const RenderQueueStats& stats() const;
+
+private:
+	void sort();
+	void flushBatch(CommandBuffer* commands, unsigned int indexType);
+
+	std::vector<DrawItem>	items;			// draws in the order they were added
+	std::vector<uint32_t>	order;			// item indices in key order
+	std::vector<uint32_t>	scratch;		// radix sort ping-pong buffer
+	std::vector<int32_t>	batchCounts;	// index counts of the batch being recorded
+	std::vector<uint32_t>	batchOffsets;	// and the byte offsets of their first indices
+	RenderQueueStats		frameStats;		// counters for the last record
+};
+
+#endif
@@ -0,0 +1,67 @@
+//************************************************************************************************************************
+//
+//	LearnOpenGL - scene.h
+//
+//	Name:			Tucker Dane Walker
+//	Date:			August 2017
+//	Description:	Specifications for running a scene: the options that change how the render loop runs, what
+//					it reports back, and runScene, which loads the shaders and a mesh and renders them into any
+//					number of windows (or offscreen). Shared by main and the regression harness.
+//
+//***********************************************************************************************************************/
+
+#ifndef SCENE_H
+#define SCENE_H
+
+#include "input.h"
+
+#include <vector>
+
+struct GLFWwindow;
+struct WindowEvents;
+
+// what render measured, for callers that check it (the regression harness)
+//---------------------------------
+struct RenderReport
+{
+	int							frames;			// frames rendered with every asset loaded
+	double						cpuAvgMs;		// average CPU time of those frames
+	double						cpuMaxMs;		// longest CPU time of those frames
+	double						gpuAvgMs;		// average GPU time of the frames resolved, 0 if none were
+	double						gpuP99Ms;		// 99th percentile GPU time of the frames resolved
+	int							width;			// size of image
+	int							height;
+	std::vector<unsigned char>	image;			// the last frame as RGBA8, bottom row first (headless only)
+};
+
+// options from the command line that change how render runs
+//---------------------------------
+struct RenderOptions
+{
+	int									frameLimit;		// frames to render once every asset has loaded, 0 to run until the window closes
+	const char*							tracePath;		// Chrome trace of the GPU and CPU profiles written when render returns, NULL for none
+	int									swapInterval;	// glfwSwapInterval of the window: 1 for vsync, 0 for none
+	double								maxFps;			// frame rate cap, 0 for none
+	int									framesInFlight;	// frames the CPU may run ahead of the GPU, 1 to MAX_FRAMES_IN_FLIGHT
+	double								resolutionBudgetMs;	// GPU frame time dynamic resolution keeps to, 0 to always draw at full size
+	const char*							recordPath;		// input log to record key changes to, NULL for none
+	const char*							replayPath;		// input log to play back instead of the keyboard, NULL for none
+	const std::vector<InputLogEvent>*	replayEvents;	// a session played back instead of replayPath, NULL for none
+	const char*							statsPath;		// per frame statistics (CSV) written while rendering, NULL for none
+	double								lodPixels;		// smallest size in pixels a subdivided triangle is drawn at, 0 to always draw the finest level
+	int									fieldCount;		// Triforces laid out in a field instead of the single Triforce, 0 for just the one
+	bool								variedPulse;	// each shape pulses with its own phase, frequency and amplitude instead of all alike
+	bool								gpuCull;		// cull and submit the draws with a compute shader where the context is GL 4.3 or later
+	bool								onDemand;		// only draw when something changed, sleeping in between (windowed only)
+	const char*							imagePath;		// the last frame of a headless or software run saved as a PPM image, NULL for none
+	const char*							capturePath;	// every frame captured to a PNG sequence ("%05d.png") or raw RGBA stream, NULL for none
+	RenderReport*						report;			// receives what render measured, NULL for none
+	WindowEvents*						windowEvents;	// events of a window whose callbacks another thread runs, NULL if render polls them
+};
+
+// RUNNING
+//---------------------------------
+void initRenderOptions(RenderOptions* options);													// the options used when none are given
+void runScene(const std::vector<GLFWwindow*>& windows, const char* meshPath, int depth, const RenderOptions& options);	// loads a scene, renders it, frees it
+
+#endif
@@ -10,6 +10,8 @@
 //***********************************************************************************************************************/
 
 #include "shader.h"
+#include "cpuProfiler.h"
+#include "mesh.h"
 
 // the program ID
 //---------------------------------
@@ -19,7 +21,7 @@ unsigned int ID;
 //---------------------------------
 Shader::Shader()
 {
-	ID = -1;
+	ID = 0;		// 0 until a program has been compiled
 }
 Shader::~Shader()
 {
@@ -27,69 +29,85 @@ Shader::~Shader()
 }
 Shader::Shader(const char * vertexPath, const char * fragmentPath)
 {
+	ID = 0;
 
 	// 1. retrieve the vertex/fragment source code from filepath
 	//---------------------------------
-
 	std::string vertexCode;
 	std::string fragmentCode;
-	std::ifstream vShaderFile;
-	std::ifstream fShaderFile;
+
+	if (!readFile(vertexPath, &vertexCode) || !readFile(fragmentPath, &fragmentCode))
+	{
+		std::cout << "ERROR::SHADER::FILE_NOT_SUCCESSFULLY_READ" << std::endl;
+	}
+
+	// 2. compile shaders
+	//---------------------------------
+	compile(vertexCode.c_str(), fragmentCode.c_str());
+}
+
+// read a whole shader source file; safe to call from any thread
+//---------------------------------
+bool Shader::readFile(const char * path, std::string * code)
+{
+	PROFILE_ZONE("Shader::readFile");
+	std::ifstream shaderFile;
 
 	// ensure ifstream objects can throw exceptions:
-	vShaderFile.exceptions(std::ifstream::failbit | std::ifstream::badbit);
-	fShaderFile.exceptions(std::ifstream::failbit | std::ifstream::badbit);
+	shaderFile.exceptions(std::ifstream::failbit | std::ifstream::badbit);
 	try
 	{
-		// open files
-		vShaderFile.open(vertexPath);
-		fShaderFile.open(fragmentPath);
-		std::stringstream vShaderStream, fShaderStream;
-		// read file's buffer contents into streams
-		vShaderStream << vShaderFile.rdbuf();
-		fShaderStream << fShaderFile.rdbuf();
-		// close file handlers
-		vShaderFile.close();
-		fShaderFile.close();
+		// open file
+		shaderFile.open(path);
+		std::stringstream shaderStream;
+		// read file's buffer contents into stream
+		shaderStream << shaderFile.rdbuf();
+		// close file handler
+		shaderFile.close();
 		// convert stream into string
-		vertexCode = vShaderStream.str();
-		fragmentCode = fShaderStream.str();
+		*code = shaderStream.str();
 	}
-	catch (std::ifstream::failure e)
+	catch (std::ifstream::failure& e)
 	{
-		std::cout << "ERROR::SHADER::FILE_NOT_SUCCESSFULLY_READ" << std::endl;
+		return false;
 	}
-	const char* vShaderCode = vertexCode.c_str();
-	const char* fShaderCode = fragmentCode.c_str();
+	return true;
+}
 
-	// 2. compile shaders
-	//---------------------------------
+// compile and link the program; must run on the thread owning the GL context
+//---------------------------------
+bool Shader::compile(const char * vShaderCode, const char * fShaderCode)
+{
+	PROFILE_ZONE("Shader::compile");
 	unsigned int vertex, fragment;
 	int success;
 	char infoLog[512];
+	bool ok = true;
 
 	// vertex Shader
 	vertex = glCreateShader(GL_VERTEX_SHADER);
 	glShaderSource(vertex, 1, &vShaderCode, NULL);
 	glCompileShader(vertex);
-	glGetProgramiv(vertex, GL_LINK_STATUS, &success);
+	glGetShaderiv(vertex, GL_COMPILE_STATUS, &success);
 	// print compile errors if any
 	if (!success)
 	{
 		glGetShaderInfoLog(vertex, 512, NULL, infoLog);
 		std::cout << "ERROR::SHADER::VERTEX::COMPILATION_FAILED\n" << infoLog << std::endl;
+		ok = false;
 	};
 
 	// fragment Shader
 	fragment = glCreateShader(GL_FRAGMENT_SHADER);
 	glShaderSource(fragment, 1, &fShaderCode, NULL);
 	glCompileShader(fragment);
-	glGetProgramiv(fragment, GL_LINK_STATUS, &success);
+	glGetShaderiv(fragment, GL_COMPILE_STATUS, &success);
 	// print compile errors if any
 	if (!success)
 	{
 		glGetShaderInfoLog(fragment, 512, NULL, infoLog);
 		std::cout << "ERROR::SHADER::FRAGMENT::COMPILATION_FAILED\n" << infoLog << std::endl;
+		ok = false;
 	};
 
 	// shader Program
@@ -103,11 +121,28 @@ Shader::Shader(const char * vertexPath, const char * fragmentPath)
 	{
 		glGetProgramInfoLog(ID, 512, NULL, infoLog);
 		std::cout << "ERROR::SHADER::PROGRAM::LINKING_FAILED\n" << infoLog << std::endl;
+		ok = false;
 	}
 
 	// delete the shaders as they're linked into our program now and no longer necessary
 	glDeleteShader(vertex);
 	glDeleteShader(fragment);
+
+	// a program that failed to build is never used
+	if (!ok)
+	{
+		glDeleteProgram(ID);
+		ID = 0;
+		return ok;
+	}
+
+	// per frame values come from the buffer bound to FRAME_BLOCK_BINDING
+	GLuint frameBlock = glGetUniformBlockIndex(ID, "FrameBlock");
+	if (frameBlock != GL_INVALID_INDEX)
+	{
+		glUniformBlockBinding(ID, frameBlock, FRAME_BLOCK_BINDING);
+	}
+	return ok;
 }
 
 // use/activate the shader
@@ -134,4 +169,15 @@ void Shader::setInt(const std::string &name, int value) const
 void Shader::setFloat(const std::string &name, float value) const
 {
 	glUniform1f(glGetUniformLocation(ID, name.c_str()), value);
-}
\ No newline at end of file
+}
+
+//-------------------------------------------------------------------
+//	@param:		texture		buffer texture of a shape table chunk
+//	@param:		firstShape	number of the chunk's first shape
+//-------------------------------------------------------------------
+void bindShapeTable(GLuint texture, GLuint firstShape)
+{
+	glActiveTexture(GL_TEXTURE0 + SHAPE_TABLE_UNIT);
+	glBindTexture(GL_TEXTURE_BUFFER, texture);
+	glVertexAttribI4ui(SHAPE_BASE_ATTRIBUTE, firstShape, 0, 0, 0);
+}
@@ -20,6 +20,44 @@
 #include <sstream>
 #include <iostream>
 
+// binding point of the FrameBlock uniform block: values that change once per frame. The binding is
+// context state, so contexts sharing a program each feed it their own buffer
+//---------------------------------
+const GLuint FRAME_BLOCK_BINDING = 0;
+
+// what the FrameBlock holds, laid out the way std140 lays out the block in the shaders
+//---------------------------------
+struct FrameBlockData
+{
+	float	animationTime;		// seconds the saturation animation has run
+	float	pad[3];				// std140 starts a vec4 on a 16 byte boundary
+	float	view[4];			// centre of the view in x and y, then its zoom along x and y
+};
+
+// everything the shaders know about one shape, looked up by the shape's number in the shape table: a
+// buffer texture of SHAPE_RECORD_TEXELS RGBA32F texels per shape, bound to texture unit SHAPE_TABLE_UNIT
+// (the unit the shaders' samplerBuffer reads unless told otherwise). A table larger than one buffer texture
+// can address is split into chunks, each bound in turn
+//---------------------------------
+const int SHAPE_RECORD_TEXELS = 2;
+const GLuint SHAPE_TABLE_UNIT = 0;
+
+struct ShapeRecord
+{
+	float	phase;				// how its saturation pulses, as ShapeAnimation
+	float	frequency;
+	float	amplitude;
+	float	color;				// 0 blue, 1 yellow, 2 red, 3 its vertex colors
+	float	offset[2];			// moved by this in x and y
+	float	scale;				// after being scaled by this about the origin
+	float	selected;			// 1 to draw it white
+};
+
+// binds a chunk of the shape table for the draws that follow: its buffer texture to SHAPE_TABLE_UNIT and the
+// number of its first shape to SHAPE_BASE_ATTRIBUTE
+//---------------------------------
+void bindShapeTable(GLuint texture, GLuint firstShape);
+
 class Shader
 {
 public:
@@ -33,6 +71,11 @@ public:
 	~Shader();
 	Shader(const char* vertexPath, const char* fragmentPath);
 
+	// split loading: read the sources anywhere, compile on the GL thread
+	//---------------------------------
+	static bool readFile(const char* path, std::string* code);
+	bool compile(const char* vShaderCode, const char* fShaderCode);
+
 	// use/activate the shader
 	//---------------------------------
 	void use();
@@ -0,0 +1,421 @@
+//************************************************************************************************************************
+//
+//	LearnOpenGL - softwareRasterizer.cpp
+//
+//	Name:			Tucker Dane Walker
+//	Date:			August 2017
+//	Description:	Implementation for the tiled CPU rasterizer.
+//
+//***********************************************************************************************************************/
+
+#include "softwareRasterizer.h"
+#include "mesh.h"
+#include "cpuProfiler.h"
+
+#include <math.h>
+#include <string.h>
+#include <algorithm>
+#include <limits>
+
+// x64 always has SSE2; anything else rasterizes one pixel at a time
+//---------------------------------
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define RASTER_SSE2 1
+#include <emmintrin.h>
+#else
+#define RASTER_SSE2 0
+#endif
+
+// vertices are snapped to this fraction of a pixel, as GPUs do, so a
+// vertex lands on the same spot whatever triangle it is part of
+//---------------------------------
+static const float SUBPIXEL_STEPS = 256.0f;
+
+//-------------------------------------------------------------------
+//	@param:		value		a color channel
+//	@return:	the channel as an 8 bit unsigned normalized value
+//-------------------------------------------------------------------
+static inline uint32_t toUnorm8(float value)
+{
+	value = std::min(std::max(value, 0.0f), 1.0f);
+	return (uint32_t)lrintf(value * 255.0f);
+}
+
+//-------------------------------------------------------------------
+//	@return:	a color packed as RGBA8, red in the lowest byte
+//-------------------------------------------------------------------
+static inline uint32_t packColor(float red, float green, float blue, float alpha)
+{
+	return toUnorm8(red) | (toUnorm8(green) << 8) | (toUnorm8(blue) << 16) | (toUnorm8(alpha) << 24);
+}
+
+//-------------------------------------------------------------------
+//	constructors
+//
+//	@param:		width		image width in pixels
+//	@param:		height		image height in pixels
+//	@param:		pool		threads the tiles are rasterized on
+//-------------------------------------------------------------------
+SoftwareRasterizer::SoftwareRasterizer(int width, int height, ThreadPool* pool)
+{
+	imageWidth = width;
+	imageHeight = height;
+	stride = (width + 3) & ~3;
+	tilesX = (width + RASTER_TILE_SIZE - 1) / RASTER_TILE_SIZE;
+	tilesY = (height + RASTER_TILE_SIZE - 1) / RASTER_TILE_SIZE;
+	this->pool = pool;
+
+	pixels.resize((size_t)stride * height);
+	bins.resize(tilesX * tilesY);
+	clearColor = 0;
+	binned = 0;
+}
+
+//-------------------------------------------------------------------
+//	starts a frame; the image is filled with the color tile by tile
+//	in finish
+//
+//	@param:		red, green, blue, alpha		the clear color
+//-------------------------------------------------------------------
+void SoftwareRasterizer::clear(float red, float green, float blue, float alpha)
+{
+	clearColor = packColor(red, green, blue, alpha);
+	triangles.clear();
+	for (size_t i = 0; i < bins.size(); i++)
+	{
+		bins[i].clear();
+	}
+	binned = 0;
+}
+
+//-------------------------------------------------------------------
+//	sets up the triangles of a draw and bins them into tiles
+//
+//	@param:		draw		the draw call
+//-------------------------------------------------------------------
+void SoftwareRasterizer::draw(const RasterDraw& draw)
+{
+	PROFILE_ZONE("SoftwareRasterizer::draw");
+	for (int i = 0; i + 2 < draw.count; i += 3)
+	{
+		unsigned int index[3];
+		for (int corner = 0; corner < 3; corner++)
+		{
+			int at = draw.first + i + corner;
+			if (draw.indices == NULL)
+			{
+				index[corner] = (unsigned int)at;
+			}
+			else if (draw.indexSize == 2)
+			{
+				index[corner] = ((const uint16_t*)draw.indices)[at];
+			}
+			else
+			{
+				index[corner] = ((const uint32_t*)draw.indices)[at];
+			}
+		}
+		setupTriangle(draw.vertices + index[0] * FLOATS_PER_VERTEX, draw.vertices + index[1] * FLOATS_PER_VERTEX,
+			draw.vertices + index[2] * FLOATS_PER_VERTEX, draw);
+	}
+}
+
+//-------------------------------------------------------------------
+//	turns one triangle into edge functions and adds it to the bin of
+//	every tile it may cover
+//
+//	@param:		v0, v1, v2	the vertices (clip space position, color)
+//	@param:		draw		the draw call it belongs to
+//-------------------------------------------------------------------
+void SoftwareRasterizer::setupTriangle(const float* v0, const float* v1, const float* v2, const RasterDraw& draw)
+{
+	// the vertex shader moves positions into the view with w = 1, so
+	// the viewport transform is all there is after it; y points up as in GL
+	//---------------------------------
+	const float* verts[3] = { v0, v1, v2 };
+	float x[3], y[3];
+	for (int i = 0; i < 3; i++)
+	{
+		float clipX = (verts[i][0] - draw.view[0]) * draw.view[2];
+		float clipY = (verts[i][1] - draw.view[1]) * draw.view[3];
+		x[i] = floorf((clipX + 1.0f) * 0.5f * imageWidth * SUBPIXEL_STEPS + 0.5f) / SUBPIXEL_STEPS;
+		y[i] = floorf((clipY + 1.0f) * 0.5f * imageHeight * SUBPIXEL_STEPS + 0.5f) / SUBPIXEL_STEPS;
+	}
+
+	// nothing is culled; clockwise triangles are turned around
+	float area = (x[1] - x[0]) * (y[2] - y[0]) - (x[2] - x[0]) * (y[1] - y[0]);
+	if (area == 0.0f)
+	{
+		return;
+	}
+	if (area < 0.0f)
+	{
+		std::swap(x[1], x[2]);
+		std::swap(y[1], y[2]);
+		std::swap(verts[1], verts[2]);
+		area = -area;
+	}
+
+	// pixels whose centers may be inside, clipped to the image
+	//---------------------------------
+	Triangle tri;
+	tri.minX = std::max(0, (int)ceilf(std::min(x[0], std::min(x[1], x[2])) - 0.5f));
+	tri.minY = std::max(0, (int)ceilf(std::min(y[0], std::min(y[1], y[2])) - 0.5f));
+	tri.maxX = std::min(imageWidth - 1, (int)floorf(std::max(x[0], std::max(x[1], x[2])) - 0.5f));
+	tri.maxY = std::min(imageHeight - 1, (int)floorf(std::max(y[0], std::max(y[1], y[2])) - 0.5f));
+	if (tri.minX > tri.maxX || tri.minY > tri.maxY)
+	{
+		return;
+	}
+
+	// edge i runs from vertex i to the next and is positive inside.
+	// It is always computed from its lower endpoint and negated if
+	// need be, so the two triangles sharing an edge get exactly
+	// opposite values and no pixel is drawn twice or missed
+	//---------------------------------
+	for (int i = 0; i < 3; i++)
+	{
+		int a = i;
+		int b = (i + 1) % 3;
+		bool flip = (x[a] > x[b]) || (x[a] == x[b] && y[a] > y[b]);
+		if (flip)
+		{
+			std::swap(a, b);
+		}
+
+		float A = y[a] - y[b];
+		float B = x[b] - x[a];
+		float C = -(A * x[a] + B * y[a]);
+		if (flip)
+		{
+			A = -A;
+			B = -B;
+			C = -C;
+		}
+		tri.A[i] = A;
+		tri.B[i] = B;
+		tri.C[i] = C;
+
+		// pixels exactly on an edge belong to the triangle it is the left or bottom edge of;
+		// the top-left rule with y pointing up, as GL implementations apply it
+		bool owned = (A > 0.0f) || (A == 0.0f && B > 0.0f);
+		tri.minE[i] = owned ? 0.0f : std::numeric_limits<float>::denorm_min();
+	}
+	tri.invArea = 1.0f / area;
+
+	// shade the vertices as the fragment shaders do
+	//---------------------------------
+	for (int i = 0; i < 3; i++)
+	{
+		const float* color = draw.vertexColor ? verts[i] + 3 : draw.color;
+		for (int c = 0; c < 3; c++)
+		{
+			tri.color[i][c] = color[c] * draw.saturation;
+		}
+	}
+	tri.flat = !draw.vertexColor;
+	tri.packedColor = packColor(tri.color[0][0], tri.color[0][1], tri.color[0][2], 1.0f);
+
+	// bin it into every tile it touches; a tile is skipped when one
+	// edge is negative at all of the tile's pixels inside the bounds
+	//---------------------------------
+	int index = (int)triangles.size();
+	triangles.push_back(tri);
+
+	for (int ty = tri.minY / RASTER_TILE_SIZE; ty <= tri.maxY / RASTER_TILE_SIZE; ty++)
+	{
+		float y0 = std::max(ty * RASTER_TILE_SIZE, tri.minY) + 0.5f;
+		float y1 = std::min(ty * RASTER_TILE_SIZE + RASTER_TILE_SIZE - 1, tri.maxY) + 0.5f;
+		for (int tx = tri.minX / RASTER_TILE_SIZE; tx <= tri.maxX / RASTER_TILE_SIZE; tx++)
+		{
+			float x0 = std::max(tx * RASTER_TILE_SIZE, tri.minX) + 0.5f;
+			float x1 = std::min(tx * RASTER_TILE_SIZE + RASTER_TILE_SIZE - 1, tri.maxX) + 0.5f;
+
+			bool outside = false;
+			for (int i = 0; i < 3 && !outside; i++)
+			{
+				float best = tri.A[i] * (tri.A[i] > 0.0f ? x1 : x0) + tri.B[i] * (tri.B[i] > 0.0f ? y1 : y0) + tri.C[i];
+				outside = best < 0.0f;
+			}
+			if (!outside)
+			{
+				bins[ty * tilesX + tx].push_back(index);
+				binned++;
+			}
+		}
+	}
+}
+
+//-------------------------------------------------------------------
+//	clears one tile, then draws its triangles in order
+//
+//	@param:		tile		index of the tile, row by row from the bottom
+//-------------------------------------------------------------------
+void SoftwareRasterizer::rasterizeTile(int tile)
+{
+	PROFILE_ZONE("raster tile");
+	int tileX0 = (tile % tilesX) * RASTER_TILE_SIZE;
+	int tileY0 = (tile / tilesX) * RASTER_TILE_SIZE;
+	int tileX1 = std::min(tileX0 + RASTER_TILE_SIZE, stride);		// the row padding is cleared too
+	int tileY1 = std::min(tileY0 + RASTER_TILE_SIZE, imageHeight);
+
+	for (int y = tileY0; y < tileY1; y++)
+	{
+		std::fill(&pixels[(size_t)y * stride + tileX0], &pixels[(size_t)y * stride] + tileX1, clearColor);
+	}
+
+	const std::vector<int>& bin = bins[tile];
+	for (size_t t = 0; t < bin.size(); t++)
+	{
+		const Triangle& tri = triangles[bin[t]];
+		int x0 = std::max(tri.minX, tileX0);
+		int x1 = std::min(tri.maxX, tileX1 - 1);
+		int y0 = std::max(tri.minY, tileY0);
+		int y1 = std::min(tri.maxY, tileY1 - 1);
+		int groupX0 = x0 & ~3;		// groups of 4 pixels start on a multiple of 4
+
+#if RASTER_SSE2
+		const __m128 laneOffsets = _mm_set_ps(3.5f, 2.5f, 1.5f, 0.5f);
+		const __m128 firstCenter = _mm_set1_ps(x0 + 0.5f);
+		const __m128 lastCenter = _mm_set1_ps(x1 + 0.5f);
+		const __m128 zero = _mm_setzero_ps();
+		const __m128 one = _mm_set1_ps(1.0f);
+		const __m128 scale = _mm_set1_ps(255.0f);
+		const __m128i alpha = _mm_set1_epi32((int)0xFF000000);
+		const __m128i flatColor = _mm_set1_epi32((int)tri.packedColor);
+		__m128 A[3], minE[3], vertexColor[3][3];
+		for (int i = 0; i < 3; i++)
+		{
+			A[i] = _mm_set1_ps(tri.A[i]);
+			minE[i] = _mm_set1_ps(tri.minE[i]);
+			for (int c = 0; c < 3; c++)
+			{
+				vertexColor[i][c] = _mm_set1_ps(tri.color[i][c] * tri.invArea);
+			}
+		}
+
+		for (int y = y0; y <= y1; y++)
+		{
+			float centerY = y + 0.5f;
+			__m128 rowE[3];
+			for (int i = 0; i < 3; i++)
+			{
+				rowE[i] = _mm_set1_ps(tri.B[i] * centerY + tri.C[i]);
+			}
+
+			uint32_t* row = &pixels[(size_t)y * stride];
+			for (int x = groupX0; x <= x1; x += 4)
+			{
+				__m128 centerX = _mm_add_ps(_mm_set1_ps((float)x), laneOffsets);
+				__m128 E0 = _mm_add_ps(_mm_mul_ps(A[0], centerX), rowE[0]);
+				__m128 E1 = _mm_add_ps(_mm_mul_ps(A[1], centerX), rowE[1]);
+				__m128 E2 = _mm_add_ps(_mm_mul_ps(A[2], centerX), rowE[2]);
+
+				__m128 inside = _mm_and_ps(_mm_cmpge_ps(centerX, firstCenter), _mm_cmple_ps(centerX, lastCenter));
+				inside = _mm_and_ps(inside, _mm_cmpge_ps(E0, minE[0]));
+				inside = _mm_and_ps(inside, _mm_cmpge_ps(E1, minE[1]));
+				inside = _mm_and_ps(inside, _mm_cmpge_ps(E2, minE[2]));
+				if (_mm_movemask_ps(inside) == 0)
+				{
+					continue;
+				}
+
+				__m128i color = flatColor;
+				if (!tri.flat)
+				{
+					// barycentric weights: edge i is zero on the vertices it joins, so it weighs the third
+					__m128i packed = alpha;
+					for (int c = 0; c < 3; c++)
+					{
+						__m128 value = _mm_add_ps(_mm_add_ps(_mm_mul_ps(E1, vertexColor[0][c]), _mm_mul_ps(E2, vertexColor[1][c])),
+							_mm_mul_ps(E0, vertexColor[2][c]));
+						value = _mm_mul_ps(_mm_min_ps(_mm_max_ps(value, zero), one), scale);
+						packed = _mm_or_si128(packed, _mm_slli_epi32(_mm_cvtps_epi32(value), 8 * c));
+					}
+					color = packed;
+				}
+
+				__m128i mask = _mm_castps_si128(inside);
+				__m128i old = _mm_loadu_si128((const __m128i*)(row + x));
+				_mm_storeu_si128((__m128i*)(row + x), _mm_or_si128(_mm_and_si128(mask, color), _mm_andnot_si128(mask, old)));
+			}
+		}
+#else
+		for (int y = y0; y <= y1; y++)
+		{
+			float centerY = y + 0.5f;
+			uint32_t* row = &pixels[(size_t)y * stride];
+			for (int x = x0; x <= x1; x++)
+			{
+				float centerX = x + 0.5f;
+				float E[3];
+				bool inside = true;
+				for (int i = 0; i < 3; i++)
+				{
+					E[i] = tri.A[i] * centerX + (tri.B[i] * centerY + tri.C[i]);
+					inside = inside && E[i] >= tri.minE[i];
+				}
+				if (!inside)
+				{
+					continue;
+				}
+
+				if (tri.flat)
+				{
+					row[x] = tri.packedColor;
+				}
+				else
+				{
+					float color[3];
+					for (int c = 0; c < 3; c++)
+					{
+						color[c] = (E[1] * tri.color[0][c] + E[2] * tri.color[1][c] + E[0] * tri.color[2][c]) * tri.invArea;
+					}
+					row[x] = packColor(color[0], color[1], color[2], 1.0f);
+				}
+			}
+		}
+#endif
+	}
+}
+
+//-------------------------------------------------------------------
+//	rasterizes every tile across the pool; tiles are handed out one
+//	at a time, so a thread that finishes early takes the next one
+//
+//	@return:	what the frame drew
+//-------------------------------------------------------------------
+RasterStats SoftwareRasterizer::finish()
+{
+	PROFILE_ZONE("SoftwareRasterizer::finish");
+	pool->parallelFor(tilesX * tilesY, [this](int tile) { rasterizeTile(tile); });
+
+	RasterStats stats;
+	stats.triangles = (int)triangles.size();
+	stats.binned = binned;
+	stats.tiles = tilesX * tilesY;
+	return stats;
+}
+
+//-------------------------------------------------------------------
+//	@param:		out			receives width * height * 4 bytes of RGBA8,
+//							bottom row first
+//-------------------------------------------------------------------
+void SoftwareRasterizer::readPixels(std::vector<unsigned char>* out) const
+{
+	out->resize((size_t)imageWidth * imageHeight * 4);
+	for (int y = 0; y < imageHeight; y++)
+	{
+		memcpy(&(*out)[(size_t)y * imageWidth * 4], &pixels[(size_t)y * stride], (size_t)imageWidth * 4);
+	}
+}
+
+int SoftwareRasterizer::width() const
+{
+	return imageWidth;
+}
+
+int SoftwareRasterizer::height() const
+{
+	return imageHeight;
+}
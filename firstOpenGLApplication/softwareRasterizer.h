@@ -0,0 +1,103 @@
+//************************************************************************************************************************
+//
+//	LearnOpenGL - softwareRasterizer.h
+//
+//	Name:			Tucker Dane Walker
+//	Date:			August 2017
+//	Description:	Specifications for a CPU rasterizer, used where there is no GPU and as a reference renderer.
+//					It draws the same vertex layout as the GL path (position, color) with the semantics of the
+//					shaders/ programs: positions are moved into the view as the vertex shader moves them, and
+//					each fragment is a flat or interpolated color scaled by a saturation. Triangles are set up
+//					and binned into screen tiles as they are drawn; finish() rasterizes the tiles in parallel on
+//					a thread pool, four pixels at a time with SSE2 edge functions. The result is an RGBA8 image,
+//					bottom row first, as glReadPixels returns it.
+//
+//***********************************************************************************************************************/
+
+#ifndef SOFTWARE_RASTERIZER_H
+#define SOFTWARE_RASTERIZER_H
+
+#include "threadPool.h"
+
+#include <stdint.h>
+#include <vector>
+
+// side of a square screen tile in pixels; a multiple of 4 so no SIMD group straddles two tiles
+//---------------------------------
+const int RASTER_TILE_SIZE = 64;
+
+// one draw call: a run of triangles from a vertex array and optional index array
+//---------------------------------
+struct RasterDraw
+{
+	const float*	vertices;		// FLOATS_PER_VERTEX floats per vertex: position, color
+	const void*		indices;		// index array, NULL to draw the vertices in order
+	int				indexSize;		// bytes per index (2 or 4) when indices is not NULL
+	int				first;			// first index (or vertex) to draw
+	int				count;			// number of indices (or vertices), 3 per triangle
+	float			color[3];		// fragment color when vertexColor is false
+	bool			vertexColor;	// interpolate the vertex colors instead of using color
+	float			saturation;		// scales the fragment color
+	float			view[4];		// centre of the view in x and y, then its zoom along x and y, as the vertex shader
+};
+
+// what the last frame drew
+//---------------------------------
+struct RasterStats
+{
+	int		triangles;		// triangles set up (after dropping empty and offscreen ones)
+	int		binned;			// triangle / tile pairs rasterized
+	int		tiles;			// tiles in the image
+};
+
+class SoftwareRasterizer
+{
+public:
+	// constructors; tiles are rasterized on pool
+	//---------------------------------
+	SoftwareRasterizer(int width, int height, ThreadPool* pool);
+
+	// a frame: clear starts it, draws are binned, finish rasterizes every tile
+	//---------------------------------
+	void clear(float red, float green, float blue, float alpha);
+	void draw(const RasterDraw& draw);
+	RasterStats finish();
+
+	// the finished image as tightly packed RGBA8 rows, bottom row first
+	//---------------------------------
+	void readPixels(std::vector<unsigned char>* out) const;
+
+	int width() const;
+	int height() const;
+
+private:
+	// a triangle ready to rasterize: three edge functions that are positive inside
+	struct Triangle
+	{
+		float		A[3], B[3], C[3];		// edge i is A * x + B * y + C at a pixel center
+		float		minE[3];				// a pixel is inside edge i when its value is at least minE[i]
+		int			minX, minY, maxX, maxY;	// pixel bounds, clipped to the image
+		float		invArea;				// 1 / (sum of the edge functions)
+		float		color[3][3];			// shaded color of each vertex
+		bool		flat;					// all vertices share packedColor
+		uint32_t	packedColor;
+	};
+
+	void setupTriangle(const float* v0, const float* v1, const float* v2, const RasterDraw& draw);
+	void rasterizeTile(int tile);
+
+	int							imageWidth;
+	int							imageHeight;
+	int							stride;			// pixels per row, padded to a multiple of 4
+	int							tilesX;			// tiles across
+	int							tilesY;			// tiles down
+	ThreadPool*					pool;
+
+	std::vector<uint32_t>		pixels;			// RGBA8 color buffer, stride pixels per row
+	uint32_t					clearColor;		// filled into each tile before its triangles
+	std::vector<Triangle>		triangles;		// this frame's triangles in draw order
+	std::vector<std::vector<int> >	bins;		// per tile, the triangles touching it in draw order
+	int							binned;
+};
+
+#endif
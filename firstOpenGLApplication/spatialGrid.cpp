@@ -0,0 +1,411 @@
+//************************************************************************************************************************
+//
+//	LearnOpenGL - spatialGrid.cpp
+//
+//	Name:			Tucker Dane Walker
+//	Date:			August 2017
+//	Description:	Implementation for a 2D spatial index over the bounds of the shapes.
+//
+//***********************************************************************************************************************/
+
+#include "spatialGrid.h"
+
+#include <string.h>
+#include <math.h>
+#include <algorithm>
+
+// most cells the grid has along either side; shapes beyond it are listed in the cells at its edge,
+// which costs those cells' queries more tests but never misses a shape
+//---------------------------------
+static const int MAX_GRID_SIDE = 1024;
+
+//-------------------------------------------------------------------
+//	@param:		bounds		a rectangle
+//	@return:	true if it has no area to find; such shapes are kept
+//				but never listed in a cell
+//-------------------------------------------------------------------
+static bool isEmpty(const Bounds2D& bounds)
+{
+	return !(bounds.minX <= bounds.maxX && bounds.minY <= bounds.maxY);		// NaN bounds are empty too
+}
+
+//-------------------------------------------------------------------
+//	@return:	true if the rectangles overlap, edges included
+//-------------------------------------------------------------------
+static bool overlaps(const Bounds2D& a, const Bounds2D& b)
+{
+	return a.minX <= b.maxX && b.minX <= a.maxX && a.minY <= b.maxY && b.minY <= a.maxY;
+}
+
+//-------------------------------------------------------------------
+//	constructors
+//-------------------------------------------------------------------
+SpatialGrid::SpatialGrid()
+{
+	cellWidth = 0.0f;
+	originX = 0.0f;
+	originY = 0.0f;
+	columns = 0;
+	rows = 0;
+	queryStamp = 0;
+	liveCount = 0;
+	memset(&lastStats, 0, sizeof(lastStats));
+}
+
+//-------------------------------------------------------------------
+//	changes the size of the cells and files every shape again; cells
+//	about the size of a shape keep both the cells visited and the
+//	shapes listed per cell small
+//
+//	@param:		size		width and height of a cell, > 0
+//-------------------------------------------------------------------
+void SpatialGrid::setCellSize(float size)
+{
+	if (!(size > 0.0f) || size == cellWidth)
+	{
+		return;
+	}
+	cellWidth = size;
+	columns = 0;
+	rows = 0;
+	cells.clear();
+
+	// the new grid covers every shape already in it
+	Bounds2D all;
+	bool any = false;
+	for (size_t i = 0; i < entries.size(); i++)
+	{
+		if (!entries[i].live || !entries[i].listed)
+		{
+			continue;
+		}
+		const Bounds2D& b = entries[i].bounds;
+		if (!any)
+		{
+			all = b;
+			any = true;
+		}
+		all.minX = std::min(all.minX, b.minX);
+		all.minY = std::min(all.minY, b.minY);
+		all.maxX = std::max(all.maxX, b.maxX);
+		all.maxY = std::max(all.maxY, b.maxY);
+	}
+	if (any)
+	{
+		grow(all);
+	}
+}
+
+//-------------------------------------------------------------------
+//	@return:	width and height of a cell, 0 until a size is set or the
+//				first shape is inserted
+//-------------------------------------------------------------------
+float SpatialGrid::cellSize() const
+{
+	return cellWidth;
+}
+
+//-------------------------------------------------------------------
+//	grows the grid to cover a rectangle now, so that the shapes
+//	inserted there next do not each grow it and file every shape
+//	again
+//
+//	@param:		bounds		the rectangle shapes are about to cover
+//-------------------------------------------------------------------
+void SpatialGrid::reserve(const Bounds2D& bounds)
+{
+	if (isEmpty(bounds))
+	{
+		return;
+	}
+	if (cellWidth == 0.0f)
+	{
+		cellWidth = std::max(std::max(bounds.maxX - bounds.minX, bounds.maxY - bounds.minY), 1e-6f);
+	}
+	bool inside = columns > 0
+		&& bounds.minX >= originX && bounds.maxX < originX + columns * cellWidth
+		&& bounds.minY >= originY && bounds.maxY < originY + rows * cellWidth;
+	if (!inside && (columns < MAX_GRID_SIDE || rows < MAX_GRID_SIDE))
+	{
+		grow(bounds);
+	}
+}
+
+//-------------------------------------------------------------------
+//	adds a shape; inserting an id already in the grid moves it
+//
+//	@param:		id			the shape's number, >= 0
+//	@param:		bounds		the rectangle it covers
+//-------------------------------------------------------------------
+void SpatialGrid::insert(int id, const Bounds2D& bounds)
+{
+	if (id < 0)
+	{
+		return;
+	}
+	if (id >= (int)entries.size())
+	{
+		Entry unused;
+		memset(&unused, 0, sizeof(unused));
+		entries.resize(id + 1, unused);
+		stamps.resize(id + 1, 0);
+	}
+	if (entries[id].live)
+	{
+		update(id, bounds);
+		return;
+	}
+
+	// the first shape sets the cell size if nothing else has
+	if (cellWidth == 0.0f && !isEmpty(bounds))
+	{
+		cellWidth = std::max(std::max(bounds.maxX - bounds.minX, bounds.maxY - bounds.minY), 1e-6f);
+	}
+
+	entries[id].bounds = bounds;
+	entries[id].live = true;
+	liveCount++;
+	place(id);
+}
+
+//-------------------------------------------------------------------
+//	moves a shape; only the cells it leaves and enters change
+//
+//	@param:		id			a shape in the grid
+//	@param:		bounds		the rectangle it covers now
+//-------------------------------------------------------------------
+void SpatialGrid::update(int id, const Bounds2D& bounds)
+{
+	if (id < 0 || id >= (int)entries.size() || !entries[id].live)
+	{
+		insert(id, bounds);
+		return;
+	}
+	if (entries[id].listed)
+	{
+		unlink(id);
+	}
+	entries[id].bounds = bounds;
+	place(id);
+}
+
+//-------------------------------------------------------------------
+//	@param:		id			a shape to take out of the grid; ids not in
+//							it are ignored
+//-------------------------------------------------------------------
+void SpatialGrid::remove(int id)
+{
+	if (id < 0 || id >= (int)entries.size() || !entries[id].live)
+	{
+		return;
+	}
+	if (entries[id].listed)
+	{
+		unlink(id);
+	}
+	entries[id].live = false;
+	entries[id].listed = false;
+	liveCount--;
+}
+
+//-------------------------------------------------------------------
+//	@return:	number of shapes in the grid
+//-------------------------------------------------------------------
+int SpatialGrid::size() const
+{
+	return liveCount;
+}
+
+//-------------------------------------------------------------------
+//	finds the shapes that overlap a rectangle; only the cells under
+//	it are visited, and a shape listed in several of them is tested
+//	once
+//
+//	@param:		rect		the rectangle, such as the view
+//	@param:		out			receives the ids found, in increasing order
+//-------------------------------------------------------------------
+void SpatialGrid::query(const Bounds2D& rect, std::vector<int>* out)
+{
+	out->clear();
+	lastStats.entries = liveCount;
+	lastStats.cellsVisited = 0;
+	lastStats.tested = 0;
+	lastStats.found = 0;
+	if (columns == 0 || isEmpty(rect))
+	{
+		return;
+	}
+
+	if (++queryStamp == 0)
+	{
+		// the stamps wrapped; clear them so none matches by accident
+		std::fill(stamps.begin(), stamps.end(), 0u);
+		queryStamp = 1;
+	}
+
+	int range[4];
+	cellRange(rect, range);
+	for (int y = range[1]; y <= range[3]; y++)
+	{
+		for (int x = range[0]; x <= range[2]; x++)
+		{
+			const std::vector<int>& cell = cells[y * columns + x];
+			lastStats.cellsVisited++;
+			for (size_t i = 0; i < cell.size(); i++)
+			{
+				int id = cell[i];
+				if (stamps[id] == queryStamp)
+				{
+					continue;
+				}
+				stamps[id] = queryStamp;
+				lastStats.tested++;
+				if (overlaps(entries[id].bounds, rect))
+				{
+					out->push_back(id);
+				}
+			}
+		}
+	}
+
+	// cells list shapes in the order they arrived; callers draw in shape order
+	std::sort(out->begin(), out->end());
+	lastStats.found = (int)out->size();
+}
+
+//-------------------------------------------------------------------
+//	@return:	what the last query looked at
+//-------------------------------------------------------------------
+const SpatialGridStats& SpatialGrid::stats() const
+{
+	return lastStats;
+}
+
+//-------------------------------------------------------------------
+//	@param:		bounds		a rectangle that is not empty
+//	@param:		range		receives the first column, first row, last
+//							column and last row it touches, clamped to
+//							the grid
+//-------------------------------------------------------------------
+void SpatialGrid::cellRange(const Bounds2D& bounds, int* range) const
+{
+	// in floating point first, so bounds far outside the grid cannot overflow an int
+	double x0 = floor((bounds.minX - originX) / cellWidth);
+	double y0 = floor((bounds.minY - originY) / cellWidth);
+	double x1 = floor((bounds.maxX - originX) / cellWidth);
+	double y1 = floor((bounds.maxY - originY) / cellWidth);
+	range[0] = (int)std::max(0.0, std::min(x0, (double)(columns - 1)));
+	range[1] = (int)std::max(0.0, std::min(y0, (double)(rows - 1)));
+	range[2] = (int)std::max(0.0, std::min(x1, (double)(columns - 1)));
+	range[3] = (int)std::max(0.0, std::min(y1, (double)(rows - 1)));
+}
+
+//-------------------------------------------------------------------
+//	lists a shape in every cell its bounds touch
+//
+//	@param:		id			a live shape with bounds that are not empty
+//-------------------------------------------------------------------
+void SpatialGrid::link(int id)
+{
+	Entry& entry = entries[id];
+	cellRange(entry.bounds, entry.cells);
+	for (int y = entry.cells[1]; y <= entry.cells[3]; y++)
+	{
+		for (int x = entry.cells[0]; x <= entry.cells[2]; x++)
+		{
+			cells[y * columns + x].push_back(id);
+		}
+	}
+}
+
+//-------------------------------------------------------------------
+//	takes a shape out of the cells link listed it in
+//
+//	@param:		id			a listed shape
+//-------------------------------------------------------------------
+void SpatialGrid::unlink(int id)
+{
+	const Entry& entry = entries[id];
+	for (int y = entry.cells[1]; y <= entry.cells[3]; y++)
+	{
+		for (int x = entry.cells[0]; x <= entry.cells[2]; x++)
+		{
+			std::vector<int>& cell = cells[y * columns + x];
+			std::vector<int>::iterator found = std::find(cell.begin(), cell.end(), id);
+			if (found != cell.end())
+			{
+				*found = cell.back();		// order within a cell does not matter
+				cell.pop_back();
+			}
+		}
+	}
+}
+
+//-------------------------------------------------------------------
+//	lists a live shape under its current bounds, growing the grid
+//	first if they reach outside it and it can still grow
+//
+//	@param:		id			a live shape that is not listed
+//-------------------------------------------------------------------
+void SpatialGrid::place(int id)
+{
+	Entry& entry = entries[id];
+	entry.listed = !isEmpty(entry.bounds);
+	if (!entry.listed)
+	{
+		return;
+	}
+
+	bool inside = columns > 0
+		&& entry.bounds.minX >= originX && entry.bounds.maxX < originX + columns * cellWidth
+		&& entry.bounds.minY >= originY && entry.bounds.maxY < originY + rows * cellWidth;
+	if (!inside && (columns < MAX_GRID_SIDE || rows < MAX_GRID_SIDE))
+	{
+		grow(entry.bounds);		// files every listed shape, this one included
+	}
+	else
+	{
+		link(id);
+	}
+}
+
+//-------------------------------------------------------------------
+//	makes the grid cover both what it covers now and a rectangle,
+//	with room to spare so that shapes arriving further out do not
+//	each grow it again, then files every listed shape again
+//
+//	@param:		bounds		the rectangle to cover
+//-------------------------------------------------------------------
+void SpatialGrid::grow(const Bounds2D& bounds)
+{
+	Bounds2D cover = bounds;
+	if (columns > 0)
+	{
+		cover.minX = std::min(cover.minX, originX);
+		cover.minY = std::min(cover.minY, originY);
+		cover.maxX = std::max(cover.maxX, originX + columns * cellWidth);
+		cover.maxY = std::max(cover.maxY, originY + rows * cellWidth);
+	}
+
+	// half as much again on every side, so the area covered at least doubles with each growth
+	double spare = 0.5 * std::max(cover.maxX - cover.minX, cover.maxY - cover.minY) + cellWidth;
+	double width = (cover.maxX - cover.minX) + 2.0 * spare;
+	double height = (cover.maxY - cover.minY) + 2.0 * spare;
+	columns = (int)std::min(ceil(width / cellWidth) + 1.0, (double)MAX_GRID_SIDE);
+	rows = (int)std::min(ceil(height / cellWidth) + 1.0, (double)MAX_GRID_SIDE);
+
+	// a grid at its largest stays centred on what it must cover
+	originX = (float)(0.5 * (cover.minX + cover.maxX) - 0.5 * columns * cellWidth);
+	originY = (float)(0.5 * (cover.minY + cover.maxY) - 0.5 * rows * cellWidth);
+
+	cells.clear();
+	cells.resize((size_t)columns * rows);
+	for (size_t i = 0; i < entries.size(); i++)
+	{
+		if (entries[i].live && entries[i].listed)
+		{
+			link((int)i);
+		}
+	}
+	lastStats.regrows++;
+}
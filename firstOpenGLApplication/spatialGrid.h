@@ -0,0 +1,87 @@
+//************************************************************************************************************************
+//
+//	LearnOpenGL - spatialGrid.h
+//
+//	Name:			Tucker Dane Walker
+//	Date:			August 2017
+//	Description:	Specifications for a 2D spatial index over the bounds of the shapes. The plane is cut into
+//					square cells and every shape is listed in each cell its bounds touch, so a query only visits
+//					the cells under the rectangle asked for and tests the shapes listed there: the cost goes with
+//					what is in view, not with how many shapes there are. Shapes can be added, moved and removed
+//					one at a time; only the cells they leave and enter are touched. The grid grows to fit
+//					whatever is added outside it.
+//
+//***********************************************************************************************************************/
+
+#ifndef SPATIAL_GRID_H
+#define SPATIAL_GRID_H
+
+#include "mesh.h"
+
+#include <vector>
+
+// what the last query looked at
+//---------------------------------
+struct SpatialGridStats
+{
+	int		entries;		// shapes in the grid
+	int		cellsVisited;	// cells under the rectangle queried
+	int		tested;			// shapes whose bounds were tested against it
+	int		found;			// shapes that overlap it
+	int		regrows;		// times the grid grew to fit a shape
+};
+
+class SpatialGrid
+{
+public:
+	SpatialGrid();
+
+	// width and height of a cell; setting it files every shape again
+	//---------------------------------
+	void setCellSize(float size);
+	float cellSize() const;
+
+	// keeping the index up to date; ids are small integers, such as the shape's number. Reserving the
+	// rectangle a batch of shapes covers first grows the grid once rather than as they arrive
+	//---------------------------------
+	void reserve(const Bounds2D& bounds);
+	void insert(int id, const Bounds2D& bounds);
+	void update(int id, const Bounds2D& bounds);
+	void remove(int id);
+	int size() const;
+
+	// the ids of every shape whose bounds overlap a rectangle, in increasing order
+	//---------------------------------
+	void query(const Bounds2D& rect, std::vector<int>* out);
+
+	const SpatialGridStats& stats() const;
+
+private:
+	struct Entry
+	{
+		Bounds2D	bounds;
+		int			cells[4];		// first column, first row, last column, last row listing it
+		bool		live;			// inserted and not removed
+		bool		listed;			// in the cells; empty bounds are not
+	};
+
+	void cellRange(const Bounds2D& bounds, int* range) const;
+	void link(int id);
+	void unlink(int id);
+	void place(int id);
+	void grow(const Bounds2D& bounds);
+
+	float							cellWidth;		// width and height of a cell, 0 until set
+	float							originX;		// corner of cell (0, 0)
+	float							originY;
+	int								columns;
+	int								rows;
+	std::vector<std::vector<int> >	cells;			// ids listed in each cell, row by row
+	std::vector<Entry>				entries;		// indexed by id
+	std::vector<unsigned int>		stamps;			// query that last found each id, so shapes in several cells are found once
+	unsigned int					queryStamp;
+	int								liveCount;
+	SpatialGridStats				lastStats;
+};
+
+#endif
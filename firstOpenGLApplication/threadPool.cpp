@@ -0,0 +1,155 @@
+//************************************************************************************************************************
+//
+//	LearnOpenGL - threadPool.cpp
+//
+//	Name:			Tucker Dane Walker
+//	Date:			August 2017
+//	Description:	Implementation for a fork/join thread pool.
+//
+//***********************************************************************************************************************/
+
+#include "threadPool.h"
+#include "cpuProfiler.h"
+
+//-------------------------------------------------------------------
+//	starts the worker threads
+//
+//	@param:		numWorkers	threads besides the caller; 0 uses one
+//							per core, counting the calling thread
+//-------------------------------------------------------------------
+ThreadPool::ThreadPool(int numWorkers)
+{
+	task = NULL;
+	generation = 0;
+	busy = 0;
+	stopping = false;
+	next = 0;
+	count = 0;
+
+	if (numWorkers <= 0)
+	{
+		numWorkers = (int)std::thread::hardware_concurrency() - 1;
+	}
+	for (int i = 0; i < numWorkers; i++)
+	{
+		workers.push_back(std::thread(&ThreadPool::workerLoop, this));
+	}
+}
+
+//-------------------------------------------------------------------
+//	stops and joins the worker threads
+//-------------------------------------------------------------------
+ThreadPool::~ThreadPool()
+{
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		stopping = true;
+	}
+	wake.notify_all();
+
+	for (size_t i = 0; i < workers.size(); i++)
+	{
+		workers[i].join();
+	}
+}
+
+//-------------------------------------------------------------------
+//	runs a loop across the pool; indices are handed out one at a time
+//	so uneven work balances itself
+//
+//	@param:		count		number of indices
+//	@param:		task		called with each index in [0, count)
+//-------------------------------------------------------------------
+void ThreadPool::parallelFor(int count, const Task& task)
+{
+	if (count <= 0)
+	{
+		return;
+	}
+
+	// a single index, or no workers, runs inline
+	if (count == 1 || workers.empty())
+	{
+		for (int i = 0; i < count; i++)
+		{
+			task(i);
+		}
+		return;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		this->task = &task;
+		this->count = count;
+		next = 0;
+		busy = (int)workers.size();
+		generation++;
+	}
+	wake.notify_all();
+
+	// the caller works too
+	runIndices();
+
+	std::unique_lock<std::mutex> lock(mutex);
+	while (busy > 0)
+	{
+		done.wait(lock);
+	}
+	this->task = NULL;
+}
+
+//-------------------------------------------------------------------
+//	runs indices of the current loop until none are left
+//-------------------------------------------------------------------
+void ThreadPool::runIndices()
+{
+	for (;;)
+	{
+		int i = next++;
+		if (i >= count)
+		{
+			return;
+		}
+		(*task)(i);
+	}
+}
+
+//-------------------------------------------------------------------
+//	joins every loop started by parallelFor until the pool is destroyed
+//-------------------------------------------------------------------
+void ThreadPool::workerLoop()
+{
+	PROFILE_THREAD("pool worker");
+	int seen = 0;
+	for (;;)
+	{
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+			while (!stopping && generation == seen)
+			{
+				wake.wait(lock);
+			}
+			if (stopping)
+			{
+				return;
+			}
+			seen = generation;
+		}
+
+		runIndices();
+
+		std::lock_guard<std::mutex> lock(mutex);
+		if (--busy == 0)
+		{
+			done.notify_one();
+		}
+	}
+}
+
+//-------------------------------------------------------------------
+//	@return:	the number of threads a loop runs on, caller included
+//-------------------------------------------------------------------
+int ThreadPool::threadCount() const
+{
+	return (int)workers.size() + 1;
+}
@@ -0,0 +1,58 @@
+//************************************************************************************************************************
+//
+//	LearnOpenGL - threadPool.h
+//
+//	Name:			Tucker Dane Walker
+//	Date:			August 2017
+//	Description:	Specifications for a fork/join thread pool. parallelFor hands out the indices of a loop to the
+//					workers and the calling thread, and returns once every index has run.
+//
+//***********************************************************************************************************************/
+
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class ThreadPool
+{
+public:
+	// the body of a parallel loop, called once per index
+	//---------------------------------
+	typedef std::function<void(int)> Task;
+
+	// constructors start and stop the worker threads
+	//---------------------------------
+	ThreadPool(int numWorkers);
+	~ThreadPool();
+
+	// runs task(0) ... task(count - 1) across the pool and waits for them
+	//---------------------------------
+	void parallelFor(int count, const Task& task);
+
+	int threadCount() const;
+
+private:
+	void workerLoop();
+	void runIndices();
+
+	std::vector<std::thread>	workers;		// threads besides the caller
+
+	std::mutex					mutex;			// guards the fields below
+	std::condition_variable		wake;			// signalled when a loop starts or on shutdown
+	std::condition_variable		done;			// signalled when the last worker leaves a loop
+	const Task*					task;			// body of the running loop
+	int							generation;		// bumped for every loop so workers join each once
+	int							busy;			// workers still inside the running loop
+	bool						stopping;
+
+	std::atomic<int>			next;			// next index to hand out
+	int							count;			// number of indices in the running loop
+};
+
+#endif
@@ -0,0 +1,204 @@
+//************************************************************************************************************************
+//
+//	LearnOpenGL - triforce.cpp
+//
+//	Name:			Tucker Dane Walker
+//	Date:			August 2017
+//	Description:	Implementation for the Triforce vertex data and the meshes generated from it.
+//
+//***********************************************************************************************************************/
+
+#include "triforce.h"
+
+#include <stddef.h>
+#include <stdlib.h>
+
+//-------------------------------------------------------------------
+//	vertex data
+//-------------------------------------------------------------------
+
+// first triangle (Top)
+const float TRIANGLE_TOP[3 * FLOATS_PER_VERTEX] = {
+	// positions			// colors
+	 0.0f,	0.5f, 0.0f,		1.0f, 0.0f, 0.0f,
+	-0.25f,	0.0f, 0.0f,		0.0f, 1.0f, 0.0f,
+	 0.25f,	0.0f, 0.0f,		0.0f, 0.0f, 1.0f
+};
+
+//	second triangle (Left)
+const float TRIANGLE_LEFT[3 * FLOATS_PER_VERTEX] = {
+	// positions			// colors
+	-0.25f,	 0.00f,	0.00f,	1.0f,	0.0f, 0.0f,
+	-0.50f,	-0.50f,	0.00f,	0.0f,	1.0f, 0.0f,
+	 0.00f, -0.50f,	0.00f,	0.0f,	0.0f, 1.0f
+};
+
+//	third triangle (Right)
+const float TRIANGLE_RIGHT[3 * FLOATS_PER_VERTEX] = {
+	// positions			// colors
+	0.25f,	 0.00f,	0.00f,	1.0f,	0.0f, 0.0f,
+	0.00f,	-0.50f,	0.00f,	0.0f,	1.0f, 0.0f,
+	0.50f,  -0.50f,	0.00f,	0.0f,	0.0f, 1.0f
+};
+
+//-------------------------------------------------------------------
+//	builds the Triforce as an indexed mesh; each triangle becomes one
+//	shape, subdivided depth times, with duplicate vertices merged and
+//	its triangles ordered for the post-transform vertex cache
+//
+//	@param:		depth			levels of Sierpinski subdivision
+//	@param:		unindexedVerts	if not NULL, receives the number of
+//								vertices the mesh would need unindexed
+//	@return:	mesh			the Triforce with 3 shapes (top, left, right)
+//-------------------------------------------------------------------
+Mesh makeTriforceMesh(int depth, int* unindexedVerts)
+{
+	const float * triangles[] = {
+		TRIANGLE_TOP,
+		TRIANGLE_LEFT,
+		TRIANGLE_RIGHT
+	};
+
+	Mesh mesh;
+	std::vector<float> soup;
+	int soupVerts = 0;
+
+	for (int i = 0; i < 3; i++)
+	{
+		soup.clear();
+		subdivideTriangle(triangles[i], depth, &soup);
+		addShape(&mesh, &soup[0], (int)soup.size() / FLOATS_PER_VERTEX);
+		soupVerts += (int)soup.size() / FLOATS_PER_VERTEX;
+	}
+
+	optimizeVertexCache(&mesh, VERTEX_CACHE_SIZE);
+	optimizeVertexFetch(&mesh);
+
+	if (unindexedVerts != NULL)
+	{
+		*unindexedVerts = soupVerts;
+	}
+	return mesh;
+}
+
+//-------------------------------------------------------------------
+//	builds a field of Triforces as one indexed mesh: the first sits at
+//	the origin where the single Triforce is drawn, the rest fill a
+//	square around it TRIFORCE_FIELD_SPACING apart, in rings. Each
+//	triangle of each Triforce is added once per level of subdivision
+//	asked for, as consecutive shapes
+//
+//	@param:		count			number of Triforces
+//	@param:		firstLevel		coarsest level of subdivision added
+//	@param:		lastLevel		finest level of subdivision added
+//	@param:		unindexedVerts	if not NULL, receives the number of
+//								vertices the mesh would need unindexed
+//	@return:	mesh			the field; triangle t (3 per Triforce) at
+//								level l is shape t * levels + l - firstLevel
+//-------------------------------------------------------------------
+static Mesh buildField(int count, int firstLevel, int lastLevel, int* unindexedVerts)
+{
+	const float * triangles[] = {
+		TRIANGLE_TOP,
+		TRIANGLE_LEFT,
+		TRIANGLE_RIGHT
+	};
+	int levels = lastLevel - firstLevel + 1;
+
+	// one subdivided copy of each triangle at each level, moved into place for every Triforce
+	std::vector<std::vector<float> > soups(3 * levels);
+	for (int i = 0; i < 3; i++)
+	{
+		for (int l = 0; l < levels; l++)
+		{
+			subdivideTriangle(triangles[i], firstLevel + l, &soups[i * levels + l]);
+		}
+	}
+
+	Mesh mesh;
+	std::vector<float> moved;
+	int soupVerts = 0;
+	int placed = 0;
+
+	for (int ring = 0; placed < count; ring++)
+	{
+		// walk the cells of the square ring at this distance from the origin
+		for (int y = -ring; y <= ring && placed < count; y++)
+		{
+			for (int x = -ring; x <= ring && placed < count; x++)
+			{
+				if (std::abs(x) != ring && std::abs(y) != ring)
+				{
+					continue;
+				}
+				for (size_t i = 0; i < soups.size(); i++)
+				{
+					moved = soups[i];
+					for (size_t v = 0; v < moved.size(); v += FLOATS_PER_VERTEX)
+					{
+						moved[v] += x * TRIFORCE_FIELD_SPACING;
+						moved[v + 1] += y * TRIFORCE_FIELD_SPACING;
+					}
+					addShape(&mesh, &moved[0], (int)moved.size() / FLOATS_PER_VERTEX);
+					soupVerts += (int)moved.size() / FLOATS_PER_VERTEX;
+				}
+				placed++;
+			}
+		}
+	}
+
+	optimizeVertexCache(&mesh, VERTEX_CACHE_SIZE);
+	optimizeVertexFetch(&mesh);
+
+	if (unindexedVerts != NULL)
+	{
+		*unindexedVerts = soupVerts;
+	}
+	return mesh;
+}
+
+//-------------------------------------------------------------------
+//	builds a field of Triforces as one indexed mesh, the first at the
+//	origin and the rest in rings around it. Each triangle of each
+//	Triforce is a shape, so shape i is still top, left or right by
+//	i % 3
+//
+//	@param:		count			number of Triforces
+//	@param:		depth			levels of Sierpinski subdivision
+//	@param:		unindexedVerts	if not NULL, receives the number of
+//								vertices the mesh would need unindexed
+//	@return:	mesh			the field with 3 * count shapes
+//-------------------------------------------------------------------
+Mesh makeTriforceField(int count, int depth, int* unindexedVerts)
+{
+	return buildField(count, depth, depth, unindexedVerts);
+}
+
+//-------------------------------------------------------------------
+//	builds a field of Triforces (1 for just the Triforce) with every
+//	level of subdivision up to depth in the one mesh, so each shape
+//	can be drawn at whichever level suits its size on screen
+//
+//	@param:		count			number of Triforces
+//	@param:		depth			finest level of Sierpinski subdivision
+//	@param:		levels			receives the range of every level of
+//								every shape, coarsest first
+//	@param:		unindexedVerts	if not NULL, receives the number of
+//								vertices the mesh would need unindexed
+//	@return:	mesh			the field with 3 * count shapes, each the
+//								finest level of its triangle
+//-------------------------------------------------------------------
+Mesh makeTriforceLevels(int count, int depth, ShapeLevels* levels, int* unindexedVerts)
+{
+	Mesh mesh = buildField(count, 0, depth, unindexedVerts);
+
+	// the shapes drawn without a level chosen are the finest ones
+	levels->count = depth + 1;
+	levels->ranges.swap(mesh.shapes);
+	mesh.shapes.resize(levels->ranges.size() / levels->count);
+	for (size_t s = 0; s < mesh.shapes.size(); s++)
+	{
+		mesh.shapes[s] = levels->ranges[s * levels->count + depth];
+	}
+	return mesh;
+}
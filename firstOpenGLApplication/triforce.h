@@ -0,0 +1,33 @@
+//************************************************************************************************************************
+//
+//	LearnOpenGL - triforce.h
+//
+//	Name:			Tucker Dane Walker
+//	Date:			August 2017
+//	Description:	Specifications for the Triforce vertex data and the meshes generated from it.
+//					Contains no OpenGL calls so tools can share it with the application.
+//
+//***********************************************************************************************************************/
+
+#ifndef TRIFORCE_H
+#define TRIFORCE_H
+
+#include "mesh.h"
+
+// VERTEX DATA
+//---------------------------------
+extern const float TRIANGLE_TOP[3 * FLOATS_PER_VERTEX];							// first triangle (Top)
+extern const float TRIANGLE_LEFT[3 * FLOATS_PER_VERTEX];						// second triangle (Left)
+extern const float TRIANGLE_RIGHT[3 * FLOATS_PER_VERTEX];						// third triangle (Right)
+
+// distance between neighbouring Triforces of a field; a Triforce is 1 wide and 1 high
+//---------------------------------
+const float TRIFORCE_FIELD_SPACING = 1.25f;
+
+// MESHES
+//---------------------------------
+Mesh makeTriforceMesh(int depth, int* unindexedVerts);							// builds the indexed (optionally subdivided) Triforce
+Mesh makeTriforceField(int count, int depth, int* unindexedVerts);				// builds a square field of count Triforces around the first
+Mesh makeTriforceLevels(int count, int depth, ShapeLevels* levels, int* unindexedVerts);	// a field with every level of subdivision up to depth
+
+#endif